@@ -31,6 +31,7 @@
 #include "yb/gutil/strings/substitute.h"
 
 #include "yb/rpc/rpc_controller.h"
+#include "yb/rpc/sidecars.h"
 
 #include "yb/tserver/tserver_service.proxy.h"
 
@@ -40,6 +41,7 @@
 #include "yb/util/logging.h"
 #include "yb/util/metrics.h"
 #include "yb/util/result.h"
+#include "yb/util/status_format.h"
 #include "yb/util/status_log.h"
 #include "yb/util/sync_point.h"
 #include "yb/util/trace.h"
@@ -94,6 +96,7 @@ DEFINE_UNKNOWN_bool(ysql_forward_rpcs_to_local_tserver, false,
             "DEPRECATED. Feature has been removed");
 
 DEFINE_CAPABILITY(PickReadTimeAtTabletServer, 0x8284d67b);
+DEFINE_CAPABILITY(MultiTabletWrite, 0x3cfb1a2e);
 
 DECLARE_bool(collect_end_to_end_traces);
 
@@ -556,7 +559,7 @@ void ReleaseOps(Repeated* repeated) {
 }
 
 WriteRpc::WriteRpc(const AsyncRpcData& data)
-    : AsyncRpcBase(data, YBConsistencyLevel::STRONG) {
+    : AsyncRpcBase(data, YBConsistencyLevel::STRONG), combiner_(data.write_combiner) {
   TRACE_TO(trace_, "WriteRpc initiated");
   VTRACE_TO(1, trace_, "Tablet $0 table $1", data.tablet->tablet_id(), table()->name().ToString());
 
@@ -615,6 +618,19 @@ WriteRpc::~WriteRpc() {
 }
 
 void WriteRpc::CallRemoteMethod() {
+  combined_call_ = nullptr;
+  // Only the first attempt could be combined, retries are sent separately.
+  auto combiner = std::move(combiner_);
+  if (combiner && !IsLocalCall()) {
+    const auto& ts = tablet_invoker_.current_ts();
+    if (ts.HasCapability(CAPABILITY_MultiTabletWrite) && combiner->Add(&ts, this)) {
+      return;
+    }
+  }
+  SendWrite();
+}
+
+void WriteRpc::SendWrite() {
   auto trace = trace_; // It is possible that we receive reply before returning from WriteAsync.
                        // Since send happens before we return from WriteAsync.
                        // So under heavy load it is possible that our request is handled and
@@ -661,7 +677,7 @@ Status WriteRpc::SwapResponses() {
         if (ql_response.has_rows_data_sidecar()) {
           // TODO avoid copying sidecar here.
           ql_op->set_rows_data(VERIFY_RESULT(
-              retrier().controller().ExtractSidecar(ql_response.rows_data_sidecar())));
+              ExtractSidecar(ql_response.rows_data_sidecar())));
         }
         ql_idx++;
         break;
@@ -680,8 +696,7 @@ Status WriteRpc::SwapResponses() {
             // Transfer all sidecars from downcall to upcall. Remembering index of the first
             // sidecar in upcall. So we could convert downcall sidecar index to upcall index
             // using simple addition.
-            pgsql_upcall_sidecar_offset = mutable_retrier()->mutable_controller()->TransferSidecars(
-                &pgsql_op->sidecars());
+            pgsql_upcall_sidecar_offset = VERIFY_RESULT(TransferSidecars(&pgsql_op->sidecars()));
           }
           pgsql_op->SetSidecarIndex(
               pgsql_upcall_sidecar_offset + pgsql_response.rows_data_sidecar());
@@ -706,6 +721,167 @@ void WriteRpc::NotifyBatcher(const Status& status) {
   batcher_->ProcessWriteResponse(*this, status);
 }
 
+void WriteRpc::CombinedWriteDone(
+    std::shared_ptr<MultiTabletWriteCall> call, WriteResponsePB* resp, size_t sidecars_begin,
+    size_t sidecars_end) {
+  resp_.Swap(resp);
+  combined_call_ = std::move(call);
+  combined_sidecars_begin_ = sidecars_begin;
+  combined_sidecars_end_ = sidecars_end;
+  Finished(Status::OK());
+}
+
+// Single MultiTabletWrite call, that carries requests of several write RPCs.
+class MultiTabletWriteCall : public std::enable_shared_from_this<MultiTabletWriteCall> {
+ public:
+  explicit MultiTabletWriteCall(std::vector<WriteRpc*> rpcs) : rpcs_(std::move(rpcs)) {}
+
+  void Send() {
+    auto* requests = req_.mutable_requests();
+    requests->Reserve(narrow_cast<int>(rpcs_.size()));
+    for (auto* rpc : rpcs_) {
+      // Requests stay owned by RPCs, they are released in Done.
+      requests->AddAllocated(&rpc->req_);
+    }
+    auto& first_rpc = *rpcs_.front();
+    controller_.set_deadline(first_rpc.deadline());
+    first_rpc.tablet_invoker_.proxy()->MultiTabletWriteAsync(
+        req_, &resp_, &controller_, std::bind(&MultiTabletWriteCall::Done, shared_from_this()));
+  }
+
+  Result<RefCntSlice> ExtractSidecar(size_t idx) const {
+    return controller_.ExtractSidecar(narrow_cast<int>(idx));
+  }
+
+  // Copies sidecars [begin, end) of the combined response to dest, returning index of the first
+  // copied sidecar in dest. Sidecars of the whole response can't be shared with dest, since the
+  // rest of them belongs to other RPCs.
+  Result<size_t> TransferSidecars(size_t begin, size_t end, rpc::Sidecars* dest) const {
+    size_t result = 0;
+    for (auto idx = begin; idx != end; ++idx) {
+      auto sidecar = VERIFY_RESULT(ExtractSidecar(idx));
+      dest->Start().Append(sidecar.AsSlice());
+      auto dest_idx = dest->Complete();
+      if (idx == begin) {
+        result = dest_idx;
+      }
+    }
+    return result;
+  }
+
+ private:
+  void Done() {
+    ReleaseOps(req_.mutable_requests());
+
+    auto status = controller_.status();
+    const auto expected_size = rpcs_.size();
+    if (status.ok() && (static_cast<size_t>(resp_.responses().size()) != expected_size ||
+                        static_cast<size_t>(resp_.first_sidecar().size()) != expected_size + 1)) {
+      status = STATUS_FORMAT(
+          IllegalState, "Wrong number of responses in multi tablet write: $0, expected $1",
+          resp_.responses().size(), expected_size);
+    }
+    std::vector<bool> failed(expected_size);
+    if (status.ok()) {
+      for (const auto& failure : resp_.failed_requests()) {
+        if (failure.index() >= expected_size) {
+          status = STATUS_FORMAT(
+              IllegalState, "Wrong failed request index in multi tablet write: $0, size $1",
+              failure.index(), expected_size);
+          break;
+        }
+        // The request was not delivered to its tablet, e.g. because the server is too busy.
+        // It is sent separately, so the error is handled as for a regular write, e.g. the write
+        // is retried to the same server instead of failing over to a follower.
+        VLOG(1) << "Multi tablet write of " << rpcs_[failure.index()]->ToString() << " failed: "
+                << StatusFromPB(failure.status());
+        failed[failure.index()] = true;
+      }
+    }
+    if (!status.ok()) {
+      // The server could be unable to handle multi tablet write, e.g. if it is too busy.
+      // Fall back to separate calls, so each write is retried according to its own state.
+      VLOG(1) << "Multi tablet write of " << rpcs_.size() << " requests failed: " << status;
+      for (auto* rpc : rpcs_) {
+        rpc->SendWrite();
+      }
+      return;
+    }
+
+    auto self = shared_from_this();
+    for (size_t i = 0; i != rpcs_.size(); ++i) {
+      if (failed[i]) {
+        rpcs_[i]->SendWrite();
+        continue;
+      }
+      auto idx = narrow_cast<int>(i);
+      rpcs_[i]->CombinedWriteDone(
+          self, resp_.mutable_responses(idx), resp_.first_sidecar(idx),
+          resp_.first_sidecar(idx + 1));
+    }
+  }
+
+  const std::vector<WriteRpc*> rpcs_;
+  tserver::MultiTabletWriteRequestPB req_;
+  tserver::MultiTabletWriteResponsePB resp_;
+  RpcController controller_;
+};
+
+Result<RefCntSlice> WriteRpc::ExtractSidecar(size_t idx) const {
+  if (combined_call_) {
+    SCHECK_LT(combined_sidecars_begin_ + idx, combined_sidecars_end_, InvalidArgument,
+              "Sidecar out of bounds");
+    return combined_call_->ExtractSidecar(combined_sidecars_begin_ + idx);
+  }
+  return retrier().controller().ExtractSidecar(narrow_cast<int>(idx));
+}
+
+Result<size_t> WriteRpc::TransferSidecars(rpc::Sidecars* dest) {
+  if (combined_call_) {
+    return combined_call_->TransferSidecars(combined_sidecars_begin_, combined_sidecars_end_, dest);
+  }
+  return mutable_retrier()->mutable_controller()->TransferSidecars(dest);
+}
+
+bool WriteRpcCombiner::Add(const RemoteTabletServer* ts, WriteRpc* rpc) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (flushed_) {
+    return false;
+  }
+  rpcs_.emplace_back(ts, rpc);
+  return true;
+}
+
+void WriteRpcCombiner::Flush() {
+  decltype(rpcs_) rpcs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushed_ = true;
+    rpcs.swap(rpcs_);
+  }
+
+  std::stable_sort(rpcs.begin(), rpcs.end(), [](const auto& lhs, const auto& rhs) {
+    return std::less<>()(lhs.first, rhs.first);
+  });
+  for (auto it = rpcs.begin(); it != rpcs.end();) {
+    auto ts = it->first;
+    auto group_end = std::find_if(
+        it, rpcs.end(), [ts](const auto& entry) { return entry.first != ts; });
+    if (group_end - it == 1) {
+      it->second->SendWrite();
+    } else {
+      std::vector<WriteRpc*> group;
+      group.reserve(group_end - it);
+      for (; it != group_end; ++it) {
+        group.push_back(it->second);
+      }
+      VLOG(4) << "Combining " << group.size() << " writes to " << ts->ToString();
+      std::make_shared<MultiTabletWriteCall>(std::move(group))->Send();
+    }
+    it = group_end;
+  }
+}
+
 ReadRpc::ReadRpc(const AsyncRpcData& data, YBConsistencyLevel yb_consistency_level)
     : AsyncRpcBase(data, yb_consistency_level) {
   TRACE_TO(trace_, "ReadRpc initiated");
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <boost/range/iterator_range_core.hpp>
 #include <boost/version.hpp>
 
@@ -23,6 +25,8 @@
 #include "yb/common/read_hybrid_time.h"
 #include "yb/common/retryable_request.h"
 
+#include "yb/gutil/thread_annotations.h"
+
 #include "yb/rpc/rpc_fwd.h"
 
 #include "yb/tserver/tserver.pb.h"
@@ -39,6 +43,7 @@ namespace internal {
 
 class Batcher;
 struct InFlightOp;
+class MultiTabletWriteCall;
 class RemoteTablet;
 class RemoteTabletServer;
 
@@ -64,6 +69,9 @@ struct AsyncRpcData {
   bool need_consistent_read = false;
   InFlightOps ops;
   bool need_metadata = false;
+  // Used to combine the first attempt of a write RPC with writes of the same batch to other
+  // tablets led by the same tablet server.
+  WriteRpcCombinerPtr write_combiner;
 };
 
 struct FlushExtraResult {
@@ -175,9 +183,50 @@ class WriteRpc : public AsyncRpcBase<tserver::WriteRequestPB, tserver::WriteResp
   virtual ~WriteRpc();
 
  private:
+  friend class MultiTabletWriteCall;
+  friend class WriteRpcCombiner;
+
   Status SwapResponses() override;
   void CallRemoteMethod() override;
   void NotifyBatcher(const Status& status) override;
+
+  // Sends this RPC on its own, used when it was not combined with others.
+  void SendWrite();
+
+  // Invoked when response for this RPC was received as part of combined call.
+  // Sidecars of this response are [sidecars_begin, sidecars_end) of the combined call.
+  void CombinedWriteDone(
+      std::shared_ptr<MultiTabletWriteCall> call, tserver::WriteResponsePB* resp,
+      size_t sidecars_begin, size_t sidecars_end);
+
+  Result<RefCntSlice> ExtractSidecar(size_t idx) const;
+  Result<size_t> TransferSidecars(rpc::Sidecars* dest);
+
+  WriteRpcCombinerPtr combiner_;
+
+  // Combined call that delivered the current response, if any.
+  std::shared_ptr<MultiTabletWriteCall> combined_call_;
+  size_t combined_sidecars_begin_ = 0;
+  size_t combined_sidecars_end_ = 0;
+};
+
+// Combines first attempts of write RPCs of one batch, that go to the same tablet server, into a
+// single MultiTabletWrite call. Batches touching many tablets then need one round trip per tablet
+// server instead of one per tablet.
+//
+// RPCs are collected until Flush is invoked, RPCs that are ready to be sent after it are sent
+// separately.
+class WriteRpcCombiner {
+ public:
+  // Returns false when rpc could not be combined and should be sent separately.
+  bool Add(const RemoteTabletServer* ts, WriteRpc* rpc);
+
+  void Flush();
+
+ private:
+  std::mutex mutex_;
+  bool flushed_ GUARDED_BY(mutex_) = false;
+  std::vector<std::pair<const RemoteTabletServer*, WriteRpc*>> rpcs_ GUARDED_BY(mutex_);
 };
 
 class ReadRpc : public AsyncRpcBase<tserver::ReadRequestPB, tserver::ReadResponsePB> {
@@ -82,6 +82,11 @@ DEFINE_test_flag(double, simulate_tablet_lookup_does_not_match_partition_key_pro
                  "Probability for simulating the error that happens when a key is not in the key "
                  "range of the resolved tablet's partition.");
 
+DEFINE_RUNTIME_bool(combine_tablet_writes_per_tserver, false,
+                    "Whether writes of a batch to different tablets led by the same tablet server "
+                    "should be sent in a single MultiTabletWrite RPC.");
+TAG_FLAG(combine_tablet_writes_per_tserver, advanced);
+
 using std::pair;
 using std::set;
 using std::unique_ptr;
@@ -513,7 +518,22 @@ void Batcher::AllLookupsDone() {
 void Batcher::ExecuteOperations(Initial initial) {
   VLOG_WITH_PREFIX_AND_FUNC(3) << "initial: " << initial;
   auto transaction = this->transaction();
+  bool single_tablet_commit = false;
   if (transaction) {
+    // When all ops are writes to one tablet and nothing else was written by the transaction, they
+    // could be applied as a single-shard operation, committing the transaction with this write.
+    // In this case ops_info_.metadata is left empty, so no transaction metadata is sent.
+    // Ops that failed tablet lookup are already removed from ops_queue_, the remaining ones should
+    // not be committed on their own in this case.
+    single_tablet_commit =
+        initial && single_tablet_commit_ && ops_queue_.size() == ops_.size() &&
+        ops_info_.groups.size() == 1 &&
+        ops_info_.groups.front().begin->yb_op->group() == OpGroup::kWrite &&
+        transaction->batcher_if().PrepareSingleTabletCommit(ops_queue_.size());
+  }
+  if (single_tablet_commit) {
+    VLOG_WITH_PREFIX_AND_FUNC(3) << "Using single tablet commit";
+  } else if (transaction) {
     // If this Batcher is executed in context of transaction,
     // then this transaction should initialize metadata used by RPC calls.
     //
@@ -544,7 +564,8 @@ void Batcher::ExecuteOperations(Initial initial) {
   }
   state_ = BatcherState::kTransactionReady;
 
-  const bool force_consistent_read = force_consistent_read_ || this->transaction();
+  const bool force_consistent_read =
+      !single_tablet_commit && (force_consistent_read_ || this->transaction());
 
   // Use big enough value for preallocated storage, to avoid unnecessary allocations.
   boost::container::small_vector<std::shared_ptr<AsyncRpc>,
@@ -555,13 +576,21 @@ void Batcher::ExecuteOperations(Initial initial) {
   // Consistent read is not required when whole batch fits into one command.
   const auto need_consistent_read = force_consistent_read || ops_info_.groups.size() > 1;
 
+  // Writes to tablets, whose leaders are already known, are collected by the combiner while RPCs
+  // are being sent, and flushed after that.
+  WriteRpcCombinerPtr write_combiner;
+  if (ops_info_.groups.size() > 1 && FLAGS_combine_tablet_writes_per_tserver) {
+    write_combiner = std::make_shared<WriteRpcCombiner>();
+  }
+
   auto self = shared_from_this();
   for (const auto& group : ops_info_.groups) {
     // Allow local calls for last group only.
     const auto allow_local_calls =
         allow_local_calls_in_curr_thread_ && (&group == &ops_info_.groups.back());
     rpcs.push_back(CreateRpc(
-        self, group.begin->tablet.get(), group, allow_local_calls, need_consistent_read));
+        self, group.begin->tablet.get(), group, allow_local_calls, need_consistent_read,
+        write_combiner));
   }
 
   outstanding_rpcs_.store(rpcs.size());
@@ -571,6 +600,9 @@ void Batcher::ExecuteOperations(Initial initial) {
     }
     rpc->SendRpc();
   }
+  if (write_combiner) {
+    write_combiner->Flush();
+  }
 }
 
 rpc::Messenger* Batcher::messenger() const {
@@ -605,7 +637,8 @@ void Batcher::RequestsFinished() {
 
 std::shared_ptr<AsyncRpc> Batcher::CreateRpc(
     const BatcherPtr& self, RemoteTablet* tablet, const InFlightOpsGroup& group,
-    const bool allow_local_calls_in_curr_thread, const bool need_consistent_read) {
+    const bool allow_local_calls_in_curr_thread, const bool need_consistent_read,
+    const WriteRpcCombinerPtr& write_combiner) {
   VLOG_WITH_PREFIX_AND_FUNC(3) << "tablet: " << tablet->tablet_id();
 
   CHECK(group.begin != group.end);
@@ -625,7 +658,8 @@ std::shared_ptr<AsyncRpc> Batcher::CreateRpc(
     .allow_local_calls_in_curr_thread = allow_local_calls_in_curr_thread,
     .need_consistent_read = need_consistent_read,
     .ops = InFlightOps(group.begin, group.end),
-    .need_metadata = group.need_metadata
+    .need_metadata = group.need_metadata,
+    .write_combiner = op_group == OpGroup::kWrite ? write_combiner : nullptr,
   };
 
   switch (op_group) {
@@ -100,6 +100,11 @@ class TxnBatcherIf {
       Initial initial,
       Waiter waiter) = 0;
 
+  // Asks transaction whether `num_ops` ops of a batch, that all go to a single tablet and are the
+  // last ops of the transaction, could be written as a single-shard operation without transaction
+  // metadata. Returns true if so, in that case the transaction commits together with this write.
+  virtual bool PrepareSingleTabletCommit(size_t num_ops) = 0;
+
   virtual ~TxnBatcherIf() = default;
 };
 
@@ -219,6 +224,8 @@ class Batcher : public Runnable, public std::enable_shared_from_this<Batcher> {
 
   bool allow_local_calls_in_curr_thread() const { return allow_local_calls_in_curr_thread_; }
 
+  void SetSingleTabletCommit(bool value) { single_tablet_commit_ = value; }
+
   const std::string& proxy_uuid() const;
 
   const ClientId& client_id() const;
@@ -266,7 +273,8 @@ class Batcher : public Runnable, public std::enable_shared_from_this<Batcher> {
   void AllLookupsDone();
   std::shared_ptr<AsyncRpc> CreateRpc(
       const BatcherPtr& self, RemoteTablet* tablet, const InFlightOpsGroup& group,
-      bool allow_local_calls_in_curr_thread, bool need_consistent_read);
+      bool allow_local_calls_in_curr_thread, bool need_consistent_read,
+      const WriteRpcCombinerPtr& write_combiner);
 
   // Calls/Schedules flush_callback_ and resets it to free resources.
   void RunCallback();
@@ -339,6 +347,10 @@ class Batcher : public Runnable, public std::enable_shared_from_this<Batcher> {
   // Force consistent read on transactional table, even we have only single shard commands.
   ForceConsistentRead force_consistent_read_;
 
+  // Ops of this batcher are the last ops of the transaction, so when they all go to the same
+  // tablet they could be written without transaction metadata.
+  bool single_tablet_commit_ = false;
+
   RejectionScoreSourcePtr rejection_score_source_;
 
   // Set of retryable request ids used in current batcher.
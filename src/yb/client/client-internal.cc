@@ -97,6 +97,13 @@
 
 using namespace std::literals;
 
+DEFINE_RUNTIME_bool(client_latency_aware_replica_selection, false,
+    "When choosing the closest replica, e.g. for follower reads, prefer the remote replica with "
+    "the lowest expected latency, based on the observed RPC latency and the number of RPCs in "
+    "flight, over the one with the best placement locality. The local tablet server is still "
+    "preferred when it has a replica.");
+TAG_FLAG(client_latency_aware_replica_selection, advanced);
+
 DEFINE_test_flag(bool, assert_local_tablet_server_selected, false, "Verify that SelectTServer "
                  "selected the local tablet server. Also verify that ReplicaSelection is equal "
                  "to CLOSEST_REPLICA");
@@ -304,6 +311,25 @@ YBClient::Data::~Data() {
   rpcs_.Shutdown();
 }
 
+namespace {
+
+// Returns the replica with the lowest expected latency. Replicas without recent measurements are
+// tried first, so their latency gets measured.
+RemoteTabletServer* SelectFastestTServer(const vector<RemoteTabletServer*>& candidates) {
+  RemoteTabletServer* result = nullptr;
+  auto best_latency = MonoDelta::kMax;
+  for (auto* rts : candidates) {
+    auto latency = rts->ExpectedLatency();
+    if (latency < best_latency) {
+      result = rts;
+      best_latency = latency;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
 RemoteTabletServer* YBClient::Data::SelectTServer(RemoteTablet* rt,
                                                   const ReplicaSelection selection,
                                                   const set<string>& blacklist,
@@ -365,6 +391,11 @@ RemoteTabletServer* YBClient::Data::SelectTServer(RemoteTablet* rt,
           }
         }
 
+        if ((ret == nullptr || !IsTabletServerLocal(*ret)) &&
+            GetAtomicFlag(&FLAGS_client_latency_aware_replica_selection)) {
+          ret = SelectFastestTServer(filtered);
+        }
+
         // If ret is not null here, it should point to the closest replica from the client.
 
         // Fallback to a random replica if none are local.
@@ -127,9 +127,12 @@ DEFINE_UNKNOWN_int32(test_scan_num_rows, 1000, "Number of rows to insert and sca
 DECLARE_int32(min_backoff_ms_exponent);
 DECLARE_int32(max_backoff_ms_exponent);
 DECLARE_bool(TEST_force_master_lookup_all_tablets);
+DECLARE_bool(combine_tablet_writes_per_tserver);
+DECLARE_double(TEST_multi_tablet_write_reject_probability);
 DECLARE_double(TEST_simulate_lookup_timeout_probability);
 
 METRIC_DECLARE_counter(rpcs_queue_overflow);
+METRIC_DECLARE_histogram(handler_latency_yb_tserver_TabletServerService_MultiTabletWrite);
 
 DEFINE_CAPABILITY(ClientTest, 0x1523c5ae);
 DECLARE_CAPABILITY(TabletReportLimit);
@@ -486,6 +489,16 @@ class ClientTest: public YBMiniClusterTestBase<MiniCluster> {
   };
   void DoTestWriteWithDeadServer(WhichServerToKill which);
 
+  uint64_t NumMultiTabletWriteCalls() {
+    uint64_t result = 0;
+    for (size_t i = 0; i < cluster_->num_tablet_servers(); i++) {
+      result +=
+          METRIC_handler_latency_yb_tserver_TabletServerService_MultiTabletWrite.Instantiate(
+              cluster_->mini_tablet_server(i)->server()->metric_entity())->TotalCount();
+    }
+    return result;
+  }
+
   YBSchema schema_;
 
   std::unique_ptr<MiniCluster> cluster_;
@@ -1735,6 +1748,47 @@ TEST_F(ClientTest, TestReplicatedMultiTabletTable) {
   // and ensure that the client handles refreshing the leader.
 }
 
+TEST_F(ClientTest, CombineTabletWrites) {
+  const YBTableName kCombinedTable(YQL_DATABASE_CQL, "combined_writes");
+  const int kNumRowsToWrite = 100;
+
+  FLAGS_combine_tablet_writes_per_tserver = true;
+
+  TableHandle table;
+  ASSERT_NO_FATALS(CreateTable(kCombinedTable, kNumTabletsPerTable, &table));
+
+  ASSERT_NO_FATALS(InsertTestRows(table, kNumRowsToWrite));
+  ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table));
+
+  // Every tablet server leads several tablets, so some writes should be combined.
+  ASSERT_GT(NumMultiTabletWriteCalls(), 0);
+
+  ASSERT_NO_FATALS(UpdateTestRows(table, 0, kNumRowsToWrite));
+  ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table));
+}
+
+// Parts of a multi tablet write that were not delivered to their tablets should be sent as
+// separate writes, while other parts of the same call succeed.
+TEST_F(ClientTest, CombineTabletWritesPartialFailure) {
+  const YBTableName kCombinedTable(YQL_DATABASE_CQL, "combined_writes_partial_failure");
+  const int kNumRowsToWrite = 100;
+
+  FLAGS_combine_tablet_writes_per_tserver = true;
+  FLAGS_TEST_multi_tablet_write_reject_probability = 0.5;
+
+  TableHandle table;
+  ASSERT_NO_FATALS(CreateTable(kCombinedTable, kNumTabletsPerTable, &table));
+
+  ASSERT_NO_FATALS(InsertTestRows(table, kNumRowsToWrite));
+  ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table));
+  ASSERT_GT(NumMultiTabletWriteCalls(), 0);
+
+  // All parts are rejected, so every write falls back to a separate call.
+  FLAGS_TEST_multi_tablet_write_reject_probability = 1.0;
+  ASSERT_NO_FATALS(UpdateTestRows(table, 0, kNumRowsToWrite));
+  ASSERT_EQ(kNumRowsToWrite, CountRowsFromClient(table));
+}
+
 TEST_F(ClientTest, TestReplicatedMultiTabletTableFailover) {
   const YBTableName kReplicatedTable(YQL_DATABASE_CQL, "replicated_failover_on_reads");
   const int kNumRowsToWrite = 100;
@@ -38,6 +38,7 @@
 #include <gtest/gtest.h>
 
 #include "yb/client/client-internal.h"
+#include "yb/client/meta_cache.h"
 #include "yb/client/schema.h"
 
 namespace yb {
@@ -150,5 +151,29 @@ TEST(ClientUnitTest, TestSchemaBuilder_CompoundKey_BadColumnName) {
             b.Build(&s).ToString(/* no file/line */ false));
 }
 
+TEST(ClientUnitTest, TestRemoteTabletServerExpectedLatency) {
+  internal::RemoteTabletServer ts("ts", nullptr /* proxy */);
+  ASSERT_EQ(MonoDelta::kZero, ts.ExpectedLatency());
+
+  ts.RpcStarted();
+  ts.RpcFinished();
+  ts.AddLatencySample(10ms);
+  ASSERT_EQ(MonoDelta(10ms), ts.ExpectedLatency());
+
+  // RPCs in flight increase expected latency.
+  ts.RpcStarted();
+  ASSERT_EQ(MonoDelta(20ms), ts.ExpectedLatency());
+
+  // Moving average: (10ms * 7 + 90ms) / 8.
+  ts.RpcFinished();
+  ts.AddLatencySample(90ms);
+  ASSERT_EQ(MonoDelta(20ms), ts.ExpectedLatency());
+
+  // RPC that did not complete only stops being counted as in flight.
+  ts.RpcStarted();
+  ts.RpcFinished();
+  ASSERT_EQ(MonoDelta(20ms), ts.ExpectedLatency());
+}
+
 } // namespace client
 } // namespace yb
@@ -143,6 +143,9 @@ class RemoteTabletServer;
 class Batcher;
 using BatcherPtr = std::shared_ptr<Batcher>;
 
+class WriteRpcCombiner;
+using WriteRpcCombinerPtr = std::shared_ptr<WriteRpcCombiner>;
+
 struct AsyncRpcMetrics;
 typedef std::shared_ptr<AsyncRpcMetrics> AsyncRpcMetricsPtr;
 
@@ -94,6 +94,11 @@ using namespace std::placeholders;
 DEFINE_UNKNOWN_int32(max_concurrent_master_lookups, 500,
              "Maximum number of concurrent tablet location lookups from YB client to master");
 
+DEFINE_RUNTIME_int32(client_replica_latency_expiration_ms, 10000,
+    "RPC latency measured for a tablet server is ignored by latency aware replica selection "
+    "after this time, so that the server is probed again.");
+TAG_FLAG(client_replica_latency_expiration_ms, advanced);
+
 DEFINE_test_flag(bool, verify_all_replicas_alive, false,
                  "If set, when a RemoteTablet object is destroyed, we will verify that all its "
                  "replicas are not marked as failed");
@@ -286,6 +291,39 @@ bool RemoteTabletServer::IsLocalRegion() const {
          cloud_info_pb_.placement_region() == FLAGS_placement_region;
 }
 
+void RemoteTabletServer::RpcStarted() {
+  in_flight_rpcs_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void RemoteTabletServer::RpcFinished() {
+  in_flight_rpcs_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void RemoteTabletServer::AddLatencySample(MonoDelta latency) {
+  auto now = CoarseMonoClock::Now();
+  auto sample_us = latency.ToMicroseconds();
+  auto old_ewma_us = latency_ewma_us_.load(std::memory_order_acquire);
+  auto expiration = FLAGS_client_replica_latency_expiration_ms * 1ms;
+  if (old_ewma_us != 0 &&
+      now - latency_sample_time_.load(std::memory_order_acquire) < expiration) {
+    sample_us = (old_ewma_us * 7 + sample_us) / 8;
+  }
+  // Zero is reserved for servers without measurements.
+  latency_ewma_us_.store(std::max<int64_t>(sample_us, 1), std::memory_order_release);
+  latency_sample_time_.store(now, std::memory_order_release);
+}
+
+MonoDelta RemoteTabletServer::ExpectedLatency() const {
+  auto ewma_us = latency_ewma_us_.load(std::memory_order_acquire);
+  if (ewma_us == 0 ||
+      CoarseMonoClock::Now() - latency_sample_time_.load(std::memory_order_acquire) >=
+          FLAGS_client_replica_latency_expiration_ms * 1ms) {
+    return MonoDelta::kZero;
+  }
+  auto in_flight = std::max<int64_t>(in_flight_rpcs_.load(std::memory_order_acquire), 0);
+  return MonoDelta::FromMicroseconds(ewma_us * (in_flight + 1));
+}
+
 LocalityLevel RemoteTabletServer::LocalityLevelWith(const CloudInfoPB& cloud_info) const {
   SharedLock<rw_spinlock> lock(mutex_);
   return PlacementInfoConverter::GetLocalityLevel(cloud_info_pb_, cloud_info);
@@ -32,6 +32,7 @@
 // This module is internal to the client and not a public API.
 #pragma once
 
+#include <atomic>
 #include <shared_mutex>
 #include <map>
 #include <string>
@@ -144,6 +145,16 @@ class RemoteTabletServer {
 
   HostPortPB DesiredHostPort(const CloudInfoPB& cloud_info) const;
 
+  // Statistics of RPCs sent to this server, used by latency aware replica selection.
+  void RpcStarted();
+  void RpcFinished();
+  void AddLatencySample(MonoDelta latency);
+
+  // Returns the expected latency of the next RPC to this server, i.e. the moving average of
+  // recent RPC latencies scaled by the number of RPCs in flight. Returns zero when there are no
+  // recent measurements, so the server is probed again.
+  MonoDelta ExpectedLatency() const;
+
   std::string TEST_PlacementZone() const;
 
  private:
@@ -159,6 +170,11 @@ class RemoteTabletServer {
   scoped_refptr<Histogram> dns_resolve_histogram_;
   std::vector<CapabilityId> capabilities_ GUARDED_BY(mutex_);
 
+  // Concurrent updates of the moving average could lose a sample, that is fine for its purpose.
+  std::atomic<int64_t> latency_ewma_us_{0};
+  std::atomic<CoarseTimePoint> latency_sample_time_{CoarseTimePoint()};
+  std::atomic<int64_t> in_flight_rpcs_{0};
+
   DISALLOW_COPY_AND_ASSIGN(RemoteTabletServer);
 };
 
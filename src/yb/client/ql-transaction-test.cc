@@ -24,18 +24,23 @@
 #include "yb/client/yb_op.h"
 
 #include "yb/common/ql_value.h"
+#include "yb/common/transaction_error.h"
+#include "yb/common/transaction_priority.h"
 
 #include "yb/consensus/consensus.h"
 #include "yb/consensus/log.h"
 
 #include "yb/rocksdb/db.h"
 
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/rpc.h"
 
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/transaction_coordinator.h"
+#include "yb/tablet/transaction_participant_context.h"
+#include "yb/tablet/transaction_status_resolver.h"
 
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
@@ -58,16 +63,20 @@ using namespace std::literals;
 using yb::tablet::GetTransactionTimeout;
 using yb::tablet::TabletPeer;
 
+DECLARE_bool(TEST_asyncrpc_finished_set_timedout);
 DECLARE_bool(TEST_disable_proactive_txn_cleanup_on_abort);
 DECLARE_bool(TEST_fail_in_apply_if_no_metadata);
 DECLARE_bool(TEST_master_fail_transactional_tablet_lookups);
 DECLARE_bool(TEST_transaction_allow_rerequest_status);
 DECLARE_bool(delete_intents_sst_files);
 DECLARE_bool(enable_load_balancing);
+DECLARE_bool(enable_single_tablet_transaction_fast_path);
 DECLARE_bool(fail_on_out_of_range_clock_skew);
 DECLARE_bool(flush_rocksdb_on_shutdown);
 DECLARE_bool(rocksdb_disable_compactions);
 DECLARE_int32(TEST_delay_init_tablet_peer_ms);
+DECLARE_int32(TEST_inject_status_resolver_delay_ms);
+DECLARE_int32(TEST_status_resolver_fail_responses);
 DECLARE_int32(log_min_seconds_to_retain);
 DECLARE_int32(remote_bootstrap_max_chunk_size);
 DECLARE_int64(transaction_rpc_timeout_ms);
@@ -75,6 +84,10 @@ DECLARE_uint64(TEST_transaction_delay_status_reply_usec_in_tests);
 DECLARE_uint64(aborted_intent_cleanup_ms);
 DECLARE_uint64(max_clock_skew_usec);
 DECLARE_uint64(transaction_heartbeat_usec);
+DECLARE_uint64(transaction_status_group_commit_max_delay_us);
+DECLARE_uint32(transaction_status_resolver_max_concurrent_requests);
+
+METRIC_DECLARE_histogram(transaction_status_update_batch_size);
 
 namespace yb {
 namespace client {
@@ -585,6 +598,126 @@ TEST_F(QLTransactionTest, SimpleWriteConflict) {
   ASSERT_NOK(transaction->CommitFuture().get());
 }
 
+class QLTransactionSingleTabletCommitTest : public QLTransactionTest {
+ public:
+  int NumTablets() override {
+    return 3;
+  }
+
+ protected:
+  void SetUp() override {
+    FLAGS_enable_single_tablet_transaction_fast_path = true;
+    QLTransactionTest::SetUp();
+  }
+
+  // Writes rows with keys in [0, num_rows) in the transaction and commits it using
+  // FlushAndCommitAsync.
+  Status WriteRowsAndCommit(const YBTransactionPtr& transaction, int32_t num_rows) {
+    auto session = CreateSession(transaction);
+    for (int32_t key = 0; key != num_rows; ++key) {
+      RETURN_NOT_OK(WriteRow(session, key, key * 10, WriteOpType::INSERT, Flush::kFalse));
+    }
+    std::promise<FlushStatus> promise;
+    session->FlushAndCommitAsync([&promise](FlushStatus* flush_status) {
+      promise.set_value(std::move(*flush_status));
+    });
+    return promise.get_future().get().status;
+  }
+
+  void CheckRows(int32_t num_rows) {
+    auto session = CreateSession();
+    for (int32_t key = 0; key != num_rows; ++key) {
+      ASSERT_EQ(ASSERT_RESULT(SelectRow(session, key)), key * 10);
+    }
+  }
+};
+
+class QLTransactionSingleTabletCommitOneTabletTest : public QLTransactionSingleTabletCommitTest {
+ public:
+  int NumTablets() override {
+    return 1;
+  }
+};
+
+TEST_F_EX(QLTransactionTest, SingleTabletCommit, QLTransactionSingleTabletCommitTest) {
+  ASSERT_OK(WriteRowsAndCommit(CreateTransaction(), 1));
+
+  // Row was written as a single-shard operation, so neither intents nor transaction status record
+  // should be created.
+  ASSERT_EQ(CountIntents(cluster_.get()), 0);
+  ASSERT_EQ(CountRunningTransactions(), 0);
+  ASSERT_NO_FATALS(CheckRows(1));
+}
+
+TEST_F_EX(QLTransactionTest, SingleTabletCommitMultipleRows,
+          QLTransactionSingleTabletCommitOneTabletTest) {
+  constexpr int32_t kNumRows = 10;
+
+  ASSERT_OK(WriteRowsAndCommit(CreateTransaction(), kNumRows));
+
+  ASSERT_EQ(CountIntents(cluster_.get()), 0);
+  ASSERT_EQ(CountRunningTransactions(), 0);
+  ASSERT_NO_FATALS(CheckRows(kNumRows));
+}
+
+TEST_F_EX(QLTransactionTest, SingleTabletCommitMultipleTablets,
+          QLTransactionSingleTabletCommitTest) {
+  constexpr int32_t kNumRows = 10;
+
+  // Rows go to different tablets, so the transaction is committed through the status tablet.
+  ASSERT_OK(WriteRowsAndCommit(CreateTransaction(), kNumRows));
+
+  ASSERT_NO_FATALS(CheckRows(kNumRows));
+  ASSERT_OK(WaitFor([this] {
+    return CountIntents(cluster_.get()) == 0;
+  }, 10s * kTimeMultiplier, "Intents applied"));
+}
+
+TEST_F_EX(QLTransactionTest, SingleTabletCommitFailure,
+          QLTransactionSingleTabletCommitOneTabletTest) {
+  // The write is applied, but the client gets a failure instead of its response.
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_TEST_asyncrpc_finished_set_timedout) = true;
+  auto transaction = CreateTransaction();
+  auto status = WriteRowsAndCommit(transaction, 2);
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_TEST_asyncrpc_finished_set_timedout) = false;
+
+  ASSERT_NOK(status);
+  ASSERT_EQ(TransactionError(status).value(), TransactionErrorCode::kCommitOutcomeUnknown)
+      << status;
+  ASSERT_TRUE(transaction->IsCommitOutcomeUnknown());
+  status = transaction->CommitFuture().get();
+  ASSERT_EQ(TransactionError(status).value(), TransactionErrorCode::kCommitOutcomeUnknown)
+      << status;
+
+  // Nothing is left running, and the rows are there, even though the commit was reported as
+  // failed.
+  ASSERT_EQ(CountIntents(cluster_.get()), 0);
+  ASSERT_EQ(CountRunningTransactions(), 0);
+  ASSERT_NO_FATALS(CheckRows(2));
+}
+
+TEST_F_EX(QLTransactionTest, SingleTabletCommitConflict,
+          QLTransactionSingleTabletCommitOneTabletTest) {
+  // Single-shard writes have lower priority than high priority transactions, so the write of
+  // the single tablet commit is rejected before replication.
+  auto blocker = CreateTransaction();
+  blocker->SetPriority(kHighPriTxnLowerBound);
+  ASSERT_OK(WriteRow(CreateSession(blocker), 0, 1));
+
+  auto transaction = CreateTransaction();
+  auto status = WriteRowsAndCommit(transaction, 2);
+  ASSERT_NOK(status);
+  ASSERT_EQ(TransactionError(status).value(), TransactionErrorCode::kConflict) << status;
+  ASSERT_FALSE(transaction->IsCommitOutcomeUnknown());
+  status = transaction->CommitFuture().get();
+  ASSERT_EQ(TransactionError(status).value(), TransactionErrorCode::kConflict) << status;
+
+  ASSERT_OK(blocker->CommitFuture().get());
+  auto session = CreateSession();
+  ASSERT_EQ(ASSERT_RESULT(SelectRow(session, 0)), 1);
+  ASSERT_NOK(SelectRow(session, 1));
+}
+
 void QLTransactionTest::TestReadOnlyTablets(IsolationLevel isolation_level,
                                             bool perform_write,
                                             bool written_intents_expected) {
@@ -1779,5 +1912,306 @@ TEST_F(QLTransactionTest, DeleteTableDuringWrite) {
   }, 10s * kTimeMultiplier, "Cleanup transactions from coordinator"));
 }
 
+class QLTransactionGroupCommitTest : public QLTransactionTest {
+ protected:
+  void SetUp() override {
+    // Use a single status tablet, so all concurrent transactions could be grouped together.
+    mini_cluster_opt_.transaction_table_num_tablets = 1;
+    QLTransactionTest::SetUp();
+  }
+
+  // Commits short transactions from the specified number of threads, each writing its own key.
+  // When duration is specified, threads are stopped after it passes, otherwise each thread performs
+  // max_commits transactions. Returns the total number of commits.
+  size_t CommitConcurrently(
+      int threads, int32_t max_commits, std::optional<CoarseDuration> duration = std::nullopt) {
+    std::atomic<size_t> commits{0};
+    TestThreadHolder thread_holder;
+    for (int i = 0; i != threads; ++i) {
+      thread_holder.AddThreadFunctor(
+          [this, i, max_commits, &commits, &stop = thread_holder.stop_flag()] {
+        for (int32_t value = 1; value <= max_commits && !stop.load(); ++value) {
+          auto txn = CreateTransaction();
+          auto session = CreateSession(txn);
+          ASSERT_OK(WriteRow(session, i, value));
+          ASSERT_OK(txn->CommitFuture().get());
+          commits.fetch_add(1, std::memory_order_relaxed);
+        }
+      });
+    }
+    if (duration) {
+      thread_holder.WaitAndStop(*duration);
+    } else {
+      thread_holder.JoinAll();
+    }
+    return commits.load();
+  }
+
+  // Returns the number of batches replicated by transaction status tablets, that consist only of
+  // transaction status updates, and the total number of updates in them.
+  std::pair<uint64_t, uint64_t> StatusUpdateBatches() {
+    uint64_t batches = 0;
+    uint64_t updates = 0;
+    for (const auto& peer : ListTabletPeers(cluster_.get(), ListPeersFilter::kAll)) {
+      auto tablet = peer->shared_tablet();
+      if (!tablet || tablet->table_type() != TableType::TRANSACTION_STATUS_TABLE_TYPE) {
+        continue;
+      }
+      auto histogram = METRIC_transaction_status_update_batch_size.Instantiate(
+          tablet->GetTabletMetricsEntity());
+      batches += histogram->histogram()->TotalCount();
+      updates += histogram->histogram()->TotalSum();
+    }
+    return {batches, updates};
+  }
+};
+
+TEST_F_EX(QLTransactionTest, StatusGroupCommit, QLTransactionGroupCommitTest) {
+  constexpr int kThreads = 8;
+  constexpr int32_t kCommitsPerThread = 20;
+  SetAtomicFlag(1000ULL, &FLAGS_transaction_status_group_commit_max_delay_us);
+
+  auto [initial_batches, initial_updates] = StatusUpdateBatches();
+  ASSERT_EQ(CommitConcurrently(kThreads, kCommitsPerThread),
+            static_cast<size_t>(kThreads * kCommitsPerThread));
+
+  auto session = CreateSession();
+  for (int i = 0; i != kThreads; ++i) {
+    ASSERT_EQ(ASSERT_RESULT(SelectRow(session, i)), kCommitsPerThread);
+  }
+
+  auto [batches, updates] = StatusUpdateBatches();
+  batches -= initial_batches;
+  updates -= initial_updates;
+  LOG(INFO) << "Status update batches: " << batches << ", updates: " << updates;
+  // Each transaction performs at least one status update for commit.
+  ASSERT_GE(updates, static_cast<uint64_t>(kThreads * kCommitsPerThread));
+  // Concurrent commits should be grouped into batches.
+  ASSERT_LT(batches * 2, updates);
+}
+
+// Measures throughput of short transactions with and without group commit of transaction status
+// updates on the status tablet. Disabled by default, since it does not verify anything that
+// StatusGroupCommit does not.
+TEST_F_EX(QLTransactionTest, YB_DISABLE_TEST(StatusGroupCommitThroughput),
+          QLTransactionGroupCommitTest) {
+  constexpr int kThreads = 16;
+  const auto kTestTime = 10s * kTimeMultiplier;
+
+  for (uint64_t delay_us : {0ULL, 200ULL}) {
+    SetAtomicFlag(delay_us, &FLAGS_transaction_status_group_commit_max_delay_us);
+    auto commits = CommitConcurrently(kThreads, std::numeric_limits<int32_t>::max(), kTestTime);
+    LOG(INFO) << "Group commit delay " << delay_us << "us, commits per second: "
+              << commits * 1.0 / ToSeconds(kTestTime);
+  }
+}
+
+// Participant context that only provides what is used by transaction status resolver.
+class StatusResolverParticipantContext : public tablet::TransactionParticipantContext {
+ public:
+  StatusResolverParticipantContext(
+      YBClient* client, server::ClockPtr clock, rpc::Scheduler* scheduler)
+      : clock_(std::move(clock)), scheduler_(*scheduler) {
+    std::promise<YBClient*> client_promise;
+    client_promise.set_value(client);
+    client_future_ = client_promise.get_future().share();
+  }
+
+  const std::string& permanent_uuid() const override {
+    return permanent_uuid_;
+  }
+
+  const std::string& tablet_id() const override {
+    return tablet_id_;
+  }
+
+  const std::shared_future<YBClient*>& client_future() const override {
+    return client_future_;
+  }
+
+  const server::ClockPtr& clock_ptr() const override {
+    return clock_;
+  }
+
+  rpc::Scheduler& scheduler() const override {
+    return scheduler_;
+  }
+
+  Status GetLastReplicatedData(tablet::RemoveIntentsData* data) override {
+    return STATUS(NotSupported, "GetLastReplicatedData");
+  }
+
+  void StrandEnqueue(rpc::StrandTask* task) override {
+    LOG(DFATAL) << "StrandEnqueue is not supported";
+  }
+
+  void UpdateClock(HybridTime hybrid_time) override {
+    clock_->Update(hybrid_time);
+  }
+
+  bool IsLeader() override {
+    return true;
+  }
+
+  Status SubmitUpdateTransaction(
+      std::unique_ptr<tablet::UpdateTxnOperation> state, int64_t term) override {
+    return STATUS(NotSupported, "SubmitUpdateTransaction");
+  }
+
+  HybridTime SafeTimeForTransactionParticipant() override {
+    return clock_->Now();
+  }
+
+  Result<HybridTime> WaitForSafeTime(HybridTime safe_time, CoarseTimePoint deadline) override {
+    return safe_time;
+  }
+
+ private:
+  const std::string permanent_uuid_ = "test-ts";
+  const std::string tablet_id_ = "test-tablet";
+  std::shared_future<YBClient*> client_future_;
+  server::ClockPtr clock_;
+  rpc::Scheduler& scheduler_;
+};
+
+struct StatusResolution {
+  Status status;
+  std::vector<tablet::TransactionStatusInfo> infos;
+  bool concurrent_callbacks = false;
+  bool running_after_shutdown = false;
+};
+
+class TransactionStatusResolverTest : public QLTransactionTest {
+ protected:
+  static constexpr int kNumStatusTablets = 6;
+
+  void SetUp() override {
+    mini_cluster_opt_.transaction_table_num_tablets = kNumStatusTablets;
+    QLTransactionTest::SetUp();
+  }
+
+  // Starts transactions until each status tablet is used by at least one of them.
+  void StartTransactions() {
+    std::unordered_set<TabletId> status_tablets;
+    for (int i = 0; status_tablets.size() != static_cast<size_t>(kNumStatusTablets); ++i) {
+      ASSERT_LT(i, 100) << "Status tablets used: " << AsString(status_tablets);
+      auto txn = CreateTransaction();
+      ASSERT_OK(WriteRow(CreateSession(txn), i, i));
+      auto metadata = ASSERT_RESULT(txn->GetMetadata(TransactionRpcDeadline()).get());
+      status_tablets.insert(metadata.status_tablet);
+      transactions_.push_back(txn);
+      metadatas_.push_back(metadata);
+    }
+  }
+
+  StatusResolution Resolve(YBClient* client) {
+    StatusResolverParticipantContext context(client, clock_, &client_->messenger()->scheduler());
+    rpc::Rpcs rpcs;
+    std::atomic<int> running_callbacks{0};
+    std::atomic<bool> concurrent_callbacks{false};
+    std::mutex infos_mutex;
+    StatusResolution result;
+    tablet::TransactionStatusResolver resolver(
+        &context, &rpcs, std::numeric_limits<int>::max(),
+        [&](const std::vector<tablet::TransactionStatusInfo>& infos) {
+      if (running_callbacks.fetch_add(1) != 0) {
+        concurrent_callbacks = true;
+      }
+      // Keep callback running for a while, so it would overlap with the concurrent ones,
+      // if resolver does not serialize them.
+      std::this_thread::sleep_for(50ms);
+      {
+        std::lock_guard<std::mutex> lock(infos_mutex);
+        result.infos.insert(result.infos.end(), infos.begin(), infos.end());
+      }
+      running_callbacks.fetch_sub(1);
+    });
+    for (const auto& metadata : metadatas_) {
+      resolver.Add(metadata.status_tablet, metadata.transaction_id);
+    }
+    resolver.Start(CoarseMonoClock::now() + 30s * kTimeMultiplier);
+    result.status = resolver.ResultFuture().get();
+    resolver.Shutdown();
+    result.running_after_shutdown = resolver.Running();
+    result.concurrent_callbacks = concurrent_callbacks.load();
+    return result;
+  }
+
+  std::vector<YBTransactionPtr> transactions_;
+  std::vector<TransactionMetadata> metadatas_;
+};
+
+// Each status tablet is resolved by its own lane, so resolution should take about the same
+// time as a single request, while sequential resolution could not be faster than the sum
+// of injected delays.
+TEST_F(TransactionStatusResolverTest, ConcurrentLanes) {
+  constexpr int kDelayMs = 500;
+  ASSERT_NO_FATALS(StartTransactions());
+
+  FLAGS_transaction_status_resolver_max_concurrent_requests = kNumStatusTablets;
+  FLAGS_TEST_inject_status_resolver_delay_ms = kDelayMs;
+
+  auto start = CoarseMonoClock::now();
+  auto resolution = Resolve(client_.get());
+  auto passed = CoarseMonoClock::now() - start;
+  LOG(INFO) << "Resolved " << metadatas_.size() << " transactions in " << AsString(passed);
+
+  ASSERT_OK(resolution.status);
+  ASSERT_FALSE(resolution.concurrent_callbacks);
+  ASSERT_FALSE(resolution.running_after_shutdown);
+  ASSERT_LT(passed, kNumStatusTablets * kDelayMs * 1ms);
+
+  std::unordered_set<TransactionId, TransactionIdHash> resolved;
+  for (const auto& info : resolution.infos) {
+    ASSERT_EQ(info.status, TransactionStatus::PENDING) << info.ToString();
+    ASSERT_TRUE(resolved.insert(info.transaction_id).second) << info.ToString();
+  }
+  ASSERT_EQ(resolved.size(), metadatas_.size());
+}
+
+// Failure of a single lane should prevent other lanes from picking new status tablets,
+// and be reported as the result of the whole resolution.
+TEST_F(TransactionStatusResolverTest, LaneFailure) {
+  ASSERT_NO_FATALS(StartTransactions());
+
+  FLAGS_transaction_status_resolver_max_concurrent_requests = 2;
+  FLAGS_TEST_inject_status_resolver_delay_ms = 100;
+  FLAGS_TEST_status_resolver_fail_responses = 1;
+
+  auto resolution = Resolve(client_.get());
+  ASSERT_NOK(resolution.status);
+  ASSERT_TRUE(resolution.status.IsIllegalState()) << resolution.status;
+  ASSERT_STR_CONTAINS(resolution.status.ToString(), "Injected status resolver failure");
+  ASSERT_FALSE(resolution.concurrent_callbacks);
+  ASSERT_FALSE(resolution.running_after_shutdown);
+
+  std::unordered_map<TransactionId, TabletId, TransactionIdHash> status_tablet;
+  for (const auto& metadata : metadatas_) {
+    status_tablet.emplace(metadata.transaction_id, metadata.status_tablet);
+  }
+  std::unordered_set<TabletId> resolved_tablets;
+  for (const auto& info : resolution.infos) {
+    resolved_tablets.insert(status_tablet[info.transaction_id]);
+  }
+  // Only the request that was already in flight in the second lane, and the one it could pick
+  // before the failure was recorded, could succeed.
+  ASSERT_LE(resolved_tablets.size(), 2U) << AsString(resolved_tablets);
+}
+
+TEST_F(TransactionStatusResolverTest, NoClient) {
+  for (int i = 0; i != kNumStatusTablets; ++i) {
+    TransactionMetadata metadata;
+    metadata.transaction_id = TransactionId::GenerateRandom();
+    metadata.status_tablet = Format("status-tablet-$0", i);
+    metadatas_.push_back(metadata);
+  }
+
+  auto resolution = Resolve(nullptr);
+  ASSERT_TRUE(resolution.status.IsAborted()) << resolution.status;
+  ASSERT_STR_CONTAINS(resolution.status.ToString(), "cannot start RPC");
+  ASSERT_TRUE(resolution.infos.empty()) << AsString(resolution.infos);
+  ASSERT_FALSE(resolution.running_after_shutdown);
+}
+
 } // namespace client
 } // namespace yb
@@ -206,6 +206,7 @@ void FlushBatcherAsync(
     const internal::IsWithinTransactionRetry is_within_transaction_retry) {
   batcher->set_allow_local_calls_in_curr_thread(
       batcher_config.allow_local_calls_in_curr_thread);
+  batcher->SetSingleTabletCommit(batcher_config.single_tablet_commit);
   batcher->FlushAsync(
       std::bind(
           &BatcherFlushDone, batcher, _1, std::move(callback), batcher_config),
@@ -234,6 +235,45 @@ void YBSession::FlushAsync(FlushCallback callback) {
   }
 }
 
+void YBSession::FlushAndCommitAsync(FlushCallback callback) {
+  auto transaction = batcher_config_.transaction;
+  if (!transaction) {
+    FlushAsync(std::move(callback));
+    return;
+  }
+
+  internal::BatcherPtr old_batcher;
+  old_batcher.swap(batcher_);
+
+  auto deadline = old_batcher ? old_batcher->deadline() : deadline_;
+  if (deadline == CoarseTimePoint()) {
+    deadline = CoarseMonoClock::Now() +
+               (timeout_.Initialized() ? timeout_.ToSteadyDuration() : 60s);
+  }
+  auto commit = [transaction, deadline, callback = std::move(callback)](FlushStatus* flush_status) {
+    // After a failed single tablet commit write, the commit reports that its outcome is unknown.
+    if ((!flush_status->status.ok() || !flush_status->errors.empty()) &&
+        !transaction->IsCommitOutcomeUnknown()) {
+      callback(flush_status);
+      return;
+    }
+    transaction->Commit(deadline, [callback](const Status& status) {
+      FlushStatus commit_status{status, {}};
+      callback(&commit_status);
+    });
+  };
+
+  if (old_batcher) {
+    auto config = batcher_config_;
+    config.single_tablet_commit = true;
+    FlushBatcherAsync(
+        old_batcher, std::move(commit), config, internal::IsWithinTransactionRetry::kFalse);
+  } else {
+    FlushStatus ok;
+    commit(&ok);
+  }
+}
+
 std::future<FlushStatus> YBSession::FlushFuture() {
   auto promise = std::make_shared<std::promise<FlushStatus>>();
   auto future = promise->get_future();
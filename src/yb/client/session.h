@@ -170,6 +170,15 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
   void FlushAsync(FlushCallback callback);
   std::future<FlushStatus> FlushFuture();
 
+  // Flushes pending operations and commits the session transaction, invoking 'callback' with the
+  // combined result. If all operations are writes to a single tablet and the transaction has not
+  // flushed anything before, they are applied as one single-shard write, so the transaction never
+  // registers with a status tablet and the commit does not need its own round trip.
+  // When such a write fails, it could still be applied, so the callback gets an error with
+  // TransactionErrorCode::kCommitOutcomeUnknown, and the caller has to find out the outcome itself.
+  // Without a transaction this is the same as FlushAsync.
+  void FlushAndCommitAsync(FlushCallback callback);
+
   // For production code use async variants of the following functions instead.
   FlushStatus TEST_FlushAndGetOpsErrors();
   Status TEST_Flush();
@@ -241,6 +250,9 @@ class YBSession : public std::enable_shared_from_this<YBSession> {
     std::shared_ptr<ConsistentReadPoint> non_transactional_read_point;
     bool allow_local_calls_in_curr_thread = true;
     bool force_consistent_read = false;
+    // Operations of the flushed batch are the last ones of the transaction, so the batch could
+    // use the single tablet commit path.
+    bool single_tablet_commit = false;
     RejectionScoreSourcePtr rejection_score_source;
 
     ConsistentReadPoint* read_point() const;
@@ -36,6 +36,8 @@
 
 using std::vector;
 
+DECLARE_bool(client_latency_aware_replica_selection);
+
 DEFINE_test_flag(bool, assert_local_op, false,
                  "When set, we crash if we received an operation that cannot be served locally.");
 DEFINE_RUNTIME_bool(update_all_tablets_upon_network_failure, true,
@@ -85,7 +87,12 @@ TabletInvoker::TabletInvoker(const bool local_tserver_only,
         local_tserver_only_(local_tserver_only),
         consistent_prefix_(consistent_prefix) {}
 
-TabletInvoker::~TabletInvoker() {}
+TabletInvoker::~TabletInvoker() {
+  // The RPC did not complete, so its duration is not a latency sample.
+  if (rpc_ts_) {
+    rpc_ts_->RpcFinished();
+  }
+}
 
 void TabletInvoker::SelectTabletServerWithConsistentPrefix() {
   TRACE_TO(trace_, "SelectTabletServerWithConsistentPrefix()");
@@ -97,8 +104,15 @@ void TabletInvoker::SelectTabletServerWithConsistentPrefix() {
 
   std::vector<RemoteTabletServer*> candidates;
   current_ts_ = client_->data_->SelectTServer(tablet_.get(),
-                                              YBClient::ReplicaSelection::CLOSEST_REPLICA, {},
-                                              &candidates);
+                                              YBClient::ReplicaSelection::CLOSEST_REPLICA,
+                                              stale_followers_, &candidates);
+  if (!current_ts_ && !stale_followers_.empty()) {
+    // All replicas were stale, so try them again.
+    stale_followers_.clear();
+    current_ts_ = client_->data_->SelectTServer(tablet_.get(),
+                                                YBClient::ReplicaSelection::CLOSEST_REPLICA, {},
+                                                &candidates);
+  }
   VLOG(1) << "Using tserver: " << yb::ToString(current_ts_);
 }
 
@@ -264,6 +278,11 @@ void TabletInvoker::Execute(const std::string& tablet_id, bool leader_only) {
   VLOG(2) << "Tablet " << tablet_id_ << ": Sending " << command_->ToString() << " to replica "
           << current_ts_->ToString();
 
+  if (GetAtomicFlag(&FLAGS_client_latency_aware_replica_selection)) {
+    rpc_ts_ = current_ts_;
+    rpc_start_time_ = CoarseMonoClock::Now();
+    rpc_ts_->RpcStarted();
+  }
   rpc_->SendRpcToTserver(retrier_->attempt_num());
 }
 
@@ -272,6 +291,9 @@ Status TabletInvoker::FailToNewReplica(const Status& reason,
   TRACE_TO(trace_, "FailToNewReplica($0)", reason.ToString());
   if (ErrorCode(error_code) == tserver::TabletServerErrorPB::STALE_FOLLOWER) {
     VLOG(1) << "Stale follower for " << command_->ToString() << " just retry";
+    if (GetAtomicFlag(&FLAGS_client_latency_aware_replica_selection)) {
+      stale_followers_.insert(current_ts_->permanent_uuid());
+    }
   } else if (ErrorCode(error_code) == tserver::TabletServerErrorPB::NOT_THE_LEADER) {
     VLOG(1) << "Not the leader for " << command_->ToString()
             << " retrying with a different replica";
@@ -320,6 +342,12 @@ bool TabletInvoker::Done(Status* status) {
   TRACE_TO(trace_, "Done($0)", status->ToString(false));
   ADOPT_TRACE(trace_);
 
+  if (rpc_ts_) {
+    rpc_ts_->RpcFinished();
+    rpc_ts_->AddLatencySample(CoarseMonoClock::Now() - rpc_start_time_);
+    rpc_ts_ = nullptr;
+  }
+
   bool assign_new_leader = assign_new_leader_;
   assign_new_leader_ = false;
 
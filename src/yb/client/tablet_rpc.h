@@ -16,6 +16,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_set>
 
@@ -167,6 +168,14 @@ class TabletInvoker {
 
   std::unordered_map<RemoteTabletServer*, FollowerData> followers_;
 
+  // Uuids of replicas that rejected a consistent prefix read because they were too stale.
+  // Latency aware replica selection avoids them while other replicas are available.
+  std::set<std::string> stale_followers_;
+
+  // Server and start time of the RPC in flight, used to measure its latency.
+  RemoteTabletServer* rpc_ts_ = nullptr;
+  CoarseTimePoint rpc_start_time_;
+
   const bool local_tserver_only_;
 
   const bool consistent_prefix_;
@@ -79,6 +79,13 @@ DECLARE_uint64(max_clock_skew_usec);
 DEFINE_UNKNOWN_bool(auto_promote_nonlocal_transactions_to_global, true,
             "Automatically promote transactions touching data outside of region to global.");
 
+DEFINE_RUNTIME_bool(enable_single_tablet_transaction_fast_path, false,
+    "When a transaction flushes all of its writes together with commit and they go to a single "
+    "tablet, apply them as a single-shard operation instead of writing provisional records and "
+    "a transaction status record. If such a write times out or its response is lost, the "
+    "transaction fails with kCommitOutcomeUnknown error, since the write could still be applied.");
+TAG_FLAG(enable_single_tablet_transaction_fast_path, advanced);
+
 DEFINE_test_flag(int32, transaction_inject_flushed_delay_ms, 0,
                  "Inject delay before processing flushed operations by transaction.");
 
@@ -135,6 +142,17 @@ std::ostream& operator<<(std::ostream& str, const TaggedLogPrefix& value) {
   return str << ": ";
 }
 
+// Returns true if a single tablet commit write that failed with the specified status could still
+// have been applied, e.g. when it timed out or its response was lost.
+bool IsCommitOutcomeAmbiguous(const Status& status) {
+  // Transaction errors, like kConflict and kReadRestart, are reported by the tablet before the
+  // write is replicated.
+  if (TransactionError(status) != TransactionErrorCode::kNone) {
+    return false;
+  }
+  return status.IsTimedOut() || status.IsNetworkError() || status.IsAborted();
+}
+
 } // namespace
 
 Result<ChildTransactionData> ChildTransactionData::FromPB(const ChildTransactionDataPB& data) {
@@ -349,6 +367,18 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
 
     {
       UNIQUE_LOCK(lock, mutex_);
+      if (single_tablet_commit_) {
+        auto status = status_.ok()
+            ? STATUS(IllegalState, "Transaction was already committed with a single tablet write")
+            : status_;
+        lock.unlock();
+        VLOG_WITH_PREFIX(2) << "Prepare: " << status;
+        if (waiter) {
+          waiter(status);
+        }
+        return false;
+      }
+      has_prepared_ops_ = true;
       auto promotion_started = StartPromotionToGlobalIfNecessary(ops_info);
       if (!promotion_started.ok()) {
         QueueWaiter(std::move(waiter));
@@ -404,6 +434,27 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
     return true;
   }
 
+  bool PrepareSingleTabletCommit(size_t num_ops) EXCLUDES(mutex_) override {
+    std::lock_guard<std::shared_mutex> lock(mutex_);
+    if (single_tablet_commit_) {
+      // Ops are retried by YBSession after a failure of the previous single tablet write. Such
+      // failure already made the outcome of the transaction unknown, so the retry is not sent.
+      return status_.ok();
+    }
+    // When read time is already picked, the transaction has read something and its writes should
+    // be checked for conflicts against this read time, that is not done for a single-shard write.
+    if (!GetAtomicFlag(&FLAGS_enable_single_tablet_transaction_fast_path) ||
+        state_.load(std::memory_order_acquire) != TransactionState::kRunning ||
+        !status_.ok() || child_ || has_prepared_ops_ || running_requests_ != num_ops ||
+        !tablets_.empty() || read_point_.GetReadTime() || subtransaction_.active()) {
+      return false;
+    }
+    VLOG_WITH_PREFIX(2) << "Using single tablet commit";
+    TRACE_TO(trace_, "Single tablet commit");
+    single_tablet_commit_ = true;
+    return true;
+  }
+
   void ExpectOperations(size_t count) EXCLUDES(mutex_) override {
     std::lock_guard<std::shared_mutex> lock(mutex_);
     running_requests_ += count;
@@ -448,7 +499,9 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
         }
         const std::string* prev_tablet_id = nullptr;
         for (const auto& op : ops) {
-          if (op.yb_op->applied() && op.yb_op->should_add_intents(metadata_.isolation)) {
+          // Ops written by single tablet commit do not have provisional records.
+          if (!single_tablet_commit_ &&
+              op.yb_op->applied() && op.yb_op->should_add_intents(metadata_.isolation)) {
             const std::string& tablet_id = op.tablet->tablet_id();
             if (prev_tablet_id == nullptr || tablet_id != *prev_tablet_id) {
               prev_tablet_id = &tablet_id;
@@ -456,6 +509,16 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
             }
           }
         }
+      } else if (single_tablet_commit_) {
+        // The transaction is not registered at a status tablet, so there is nothing to abort.
+        // When the write could be applied even though it failed, for instance when the response
+        // was lost after replication, whether the transaction was committed is unknown.
+        SetErrorUnlocked(
+            IsCommitOutcomeAmbiguous(status)
+                ? status.CloneAndAddErrorCode(
+                      TransactionError(TransactionErrorCode::kCommitOutcomeUnknown))
+                : status,
+            "Single tablet commit");
       } else {
         const TransactionError txn_err(status);
         // We don't abort the txn in case of a kSkipLocking error to make further progress.
@@ -690,6 +753,11 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
     return read_point_.IsRestartRequired();
   }
 
+  bool IsCommitOutcomeUnknown() const EXCLUDES(mutex_) {
+    SharedLock<std::shared_mutex> lock(mutex_);
+    return TransactionError(status_) == TransactionErrorCode::kCommitOutcomeUnknown;
+  }
+
   std::shared_future<Result<TransactionMetadata>> GetMetadata(
       CoarseTimePoint deadline) EXCLUDES(mutex_) {
     UNIQUE_LOCK(lock, mutex_);
@@ -1978,6 +2046,11 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
   const bool child_;
   const bool child_had_read_time_ = false;
   bool ready_ GUARDED_BY(mutex_) = false;
+  // Whether Prepare was invoked for some ops, i.e. they were sent with transaction metadata.
+  bool has_prepared_ops_ GUARDED_BY(mutex_) = false;
+  // All ops of this transaction are written to a single tablet without transaction metadata, see
+  // PrepareSingleTabletCommit.
+  bool single_tablet_commit_ GUARDED_BY(mutex_) = false;
   CommitCallback commit_callback_ GUARDED_BY(mutex_);
   Status status_ GUARDED_BY(mutex_);
 
@@ -2130,6 +2203,10 @@ bool YBTransaction::IsRestartRequired() const {
   return impl_->IsRestartRequired();
 }
 
+bool YBTransaction::IsCommitOutcomeUnknown() const {
+  return impl_->IsCommitOutcomeUnknown();
+}
+
 Result<YBTransactionPtr> YBTransaction::CreateRestartedTransaction() {
   auto result = impl_->CreateSimilarTransaction();
   RETURN_NOT_OK(impl_->FillRestartedTransaction(result->impl_.get()));
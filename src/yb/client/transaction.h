@@ -137,6 +137,11 @@ class YBTransaction : public std::enable_shared_from_this<YBTransaction> {
 
   bool IsRestartRequired() const;
 
+  // Whether the write of YBSession::FlushAndCommitAsync, that should have committed this
+  // transaction as a single-shard operation, failed in a way that leaves it unknown whether it
+  // was applied, e.g. timed out.
+  bool IsCommitOutcomeUnknown() const;
+
   // Creates restarted transaction, this transaction should be in the "restart required" state.
   Result<YBTransactionPtr> CreateRestartedTransaction();
 
@@ -21,6 +21,7 @@
 #include "yb/tserver/tserver_service.proxy.h"
 
 #include "yb/util/logging.h"
+#include "yb/util/memory/arena.h"
 #include "yb/util/result.h"
 
 DEFINE_CAPABILITY(GracefulCleanup, 0x5512d2a9);
@@ -96,10 +97,10 @@ class TransactionCleanup : public std::enable_shared_from_this<TransactionCleanu
       auto& call = calls_.back();
 
       auto& request = call.request;
-      request.set_tablet_id(tablet_id);
+      request.dup_tablet_id(tablet_id);
       request.set_propagated_hybrid_time(now);
       auto& state = *request.mutable_state();
-      state.set_transaction_id(transaction_id_.data(), transaction_id_.size());
+      state.dup_transaction_id(transaction_id_.AsSlice());
       state.set_status(type_ == CleanupType::kImmediate ? TransactionStatus::IMMEDIATE_CLEANUP
                                                         : TransactionStatus::GRACEFUL_CLEANUP);
       state.set_sealed(sealed_);
@@ -120,8 +121,9 @@ class TransactionCleanup : public std::enable_shared_from_this<TransactionCleanu
   }
 
   struct Call {
-    tserver::UpdateTransactionRequestPB request;
-    tserver::UpdateTransactionResponsePB response;
+    ThreadSafeArena arena;
+    tserver::LWUpdateTransactionRequestPB request{&arena};
+    tserver::LWUpdateTransactionResponsePB response{&arena};
     rpc::RpcController controller;
   };
 
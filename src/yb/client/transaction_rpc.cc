@@ -22,6 +22,7 @@
 
 #include "yb/common/transaction.h"
 
+#include "yb/rpc/lightweight_message.h"
 #include "yb/rpc/rpc.h"
 #include "yb/rpc/rpc_controller.h"
 
@@ -151,6 +152,37 @@ void PrepareRequest(tserver::UpdateTransactionRequestPB* req) {
   }
 }
 
+template <class Request, class Response>
+void InvokeProxyAsync(
+    tserver::TabletServerServiceProxy* proxy,
+    void (tserver::TabletServerServiceProxy::*method)(
+        const Request&, Response*, rpc::RpcController*, rpc::ResponseCallback) const,
+    const Request& request, Response* response, rpc::RpcController* controller,
+    rpc::ResponseCallback callback) {
+  (proxy->*method)(request, response, controller, std::move(callback));
+}
+
+// Invokes method that uses lightweight messages on the proxy side, while TransactionRpc keeps
+// regular protobufs. The response is converted before the callback, since the tablet invoker
+// checks it for errors.
+template <class LWRequest, class LWResponse, class Request, class Response>
+std::enable_if_t<std::is_base_of_v<rpc::LightweightMessage, LWRequest>> InvokeProxyAsync(
+    tserver::TabletServerServiceProxy* proxy,
+    void (tserver::TabletServerServiceProxy::*method)(
+        const LWRequest&, LWResponse*, rpc::RpcController*, rpc::ResponseCallback) const,
+    const Request& request, Response* response, rpc::RpcController* controller,
+    rpc::ResponseCallback callback) {
+  auto lw_request = rpc::CopySharedMessage(request);
+  auto lw_response = rpc::MakeSharedMessage<LWResponse>();
+  (proxy->*method)(
+      *lw_request, lw_response.get(), controller,
+      [lw_request, lw_response, response, callback = std::move(callback)] {
+    response->Clear();
+    lw_response->ToGoogleProtobuf(response);
+    callback();
+  });
+}
+
 #define TRANSACTION_RPC_TRAITS_NAME(entry) BOOST_PP_CAT(TRANSACTION_RPC_NAME(entry), Traits)
 
 #define TRANSACTION_RPC_TRAITS_CALL_CALLBACK_HELPER_WITHOUT_REQUEST() \
@@ -180,7 +212,8 @@ struct TRANSACTION_RPC_TRAITS_NAME(entry) { \
                           rpc::RpcController* controller, \
                           rpc::ResponseCallback callback) { \
     PrepareRequest(request); \
-    proxy->BOOST_PP_CAT(TRANSACTION_RPC_NAME(entry), Async)( \
+    InvokeProxyAsync( \
+        proxy, &tserver::TabletServerServiceProxy::BOOST_PP_CAT(TRANSACTION_RPC_NAME(entry), Async), \
         *request, response, controller, std::move(callback)); \
   } \
 }; \
@@ -25,6 +25,9 @@
 #include "yb/util/strongly_typed_bool.h"
 
 namespace yb {
+
+class RefCntBuffer;
+
 namespace consensus {
 
 class Consensus;
@@ -81,6 +84,7 @@ typedef int64_t ConsensusTerm;
 
 using ReplicateMsgPtr = std::shared_ptr<LWReplicateMsg>;
 using ReplicateMsgs = std::vector<ReplicateMsgPtr>;
+using SerializedReplicateMsgs = std::vector<RefCntBuffer>;
 
 YB_STRONGLY_TYPED_BOOL(TEST_SuppressVoteRequest);
 YB_STRONGLY_TYPED_BOOL(PreElection);
@@ -59,6 +59,8 @@ using namespace std::chrono_literals;
 
 METRIC_DECLARE_entity(tablet);
 
+DECLARE_int32(consensus_max_in_flight_requests_per_peer);
+
 namespace yb {
 namespace consensus {
 
@@ -76,6 +78,58 @@ const char* kTabletId = "test-peers-tablet";
 const char* kLeaderUuid = "peer-0";
 const char* kFollowerUuid = "peer-1";
 
+// Emulates a follower that processes requests in the order they were sent, but holds the responses
+// until Respond() is called.
+class HeldResponsesPeerProxy : public PeerProxy {
+ public:
+  HeldResponsesPeerProxy(ThreadPool* pool, const RaftPeerPB& peer_pb)
+      : pool_(pool), follower_(pool, peer_pb) {}
+
+  void UpdateAsync(const LWConsensusRequestPB* request,
+                   RequestTriggerMode trigger_mode,
+                   LWConsensusResponsePB* response,
+                   rpc::RpcController* controller,
+                   const rpc::ResponseCallback& callback) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    follower_.UpdateAsync(request, trigger_mode, response, controller, [] {});
+    held_callbacks_.push_back(callback);
+  }
+
+  void RequestConsensusVoteAsync(const VoteRequestPB* request,
+                                 VoteResponsePB* response,
+                                 rpc::RpcController* controller,
+                                 const rpc::ResponseCallback& callback) override {
+    LOG(DFATAL) << "Not implemented";
+  }
+
+  // Responds to all held requests, in the order they were sent.
+  void Respond() {
+    std::vector<rpc::ResponseCallback> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      callbacks.swap(held_callbacks_);
+    }
+    for (auto& callback : callbacks) {
+      WARN_NOT_OK(pool_->SubmitFunc(callback), "Submit failed");
+    }
+  }
+
+  size_t num_held_responses() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return held_callbacks_.size();
+  }
+
+  OpId follower_last_received() const {
+    return follower_.last_received();
+  }
+
+ private:
+  ThreadPool* const pool_;
+  NoOpTestPeerProxy follower_;
+  std::mutex mutex_;
+  std::vector<rpc::ResponseCallback> held_callbacks_;
+};
+
 class ConsensusPeersTest : public YBTest {
  public:
   ConsensusPeersTest()
@@ -414,5 +468,45 @@ TEST_F(ConsensusPeersTest, TestDontSendOneRpcPerWriteWhenPeerIsDown) {
   ASSERT_LT(mock_proxy->update_count() - initial_update_count, 5);
 }
 
+TEST_F(ConsensusPeersTest, TestPipelinedRequests) {
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_consensus_max_in_flight_requests_per_peer) = 3;
+
+  auto proxy = new HeldResponsesPeerProxy(raft_pool_.get(), FakeRaftPeerPB(kFollowerUuid));
+  auto peer = ASSERT_RESULT(Peer::NewRemotePeer(
+      FakeRaftPeerPB(kFollowerUuid), kTabletId, kLeaderUuid, PeerProxyPtr(proxy),
+      message_queue_.get(), nullptr /* multi raft batcher */, raft_pool_token_.get(),
+      nullptr /* consensus */, messenger_.get()));
+
+  auto se = ScopeExit([&peer, proxy] {
+    peer->Close();
+    // Release the callbacks that keep the peer alive.
+    proxy->Respond();
+  });
+
+  // Let the peer catch up, so that it is known to be in sync with the leader.
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_, 1, 1);
+  ASSERT_OK(peer->SignalRequest(RequestTriggerMode::kAlwaysSend));
+  ASSERT_OK(WaitFor([this, proxy] {
+    proxy->Respond();
+    return consensus_->IsMajorityReplicated(1);
+  }, 10s, "Replicate first operation"));
+
+  // Operations appended while a request is in flight should be sent without waiting for its
+  // response.
+  for (int i = 2; i <= 4; ++i) {
+    AppendReplicateMessagesToQueue(message_queue_.get(), clock_, i, 1);
+    ASSERT_OK(peer->SignalRequest(RequestTriggerMode::kNonEmptyOnly));
+  }
+  ASSERT_OK(WaitFor([proxy] {
+    return proxy->num_held_responses() >= 2;
+  }, 10s, "Pipelined requests"));
+
+  ASSERT_OK(WaitFor([this, proxy] {
+    proxy->Respond();
+    return consensus_->IsMajorityReplicated(4);
+  }, 10s, "Replicate pipelined operations"));
+  ASSERT_EQ(proxy->follower_last_received().index, 4);
+}
+
 }  // namespace consensus
 }  // namespace yb
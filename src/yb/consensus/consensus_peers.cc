@@ -67,6 +67,7 @@
 #include "yb/util/scope_exit.h"
 #include "yb/util/status_callback.h"
 #include "yb/util/status_format.h"
+#include "yb/util/status_log.h"
 #include "yb/util/threadpool.h"
 #include "yb/util/tsan_util.h"
 
@@ -83,9 +84,16 @@ DEFINE_UNKNOWN_int32(max_wait_for_processresponse_before_closing_ms,
              "finish before returning proceding to close the Peer and return");
 TAG_FLAG(max_wait_for_processresponse_before_closing_ms, advanced);
 
+DEFINE_RUNTIME_int32(consensus_max_in_flight_requests_per_peer, 1,
+    "Maximum number of UpdateConsensus requests a leader could have in flight to a single peer. "
+    "Requests beyond the first one are only sent to peers that are in sync with the leader, and "
+    "carry the operations appended after those already in flight.");
+TAG_FLAG(consensus_max_in_flight_requests_per_peer, advanced);
+
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DECLARE_bool(enable_multi_raft_heartbeat_batcher);
+DECLARE_bool(multi_raft_batch_commit_updates);
 
 DEFINE_test_flag(double, fault_crash_on_leader_request_fraction, 0.0,
                  "Fraction of the time when the leader will crash just before sending an "
@@ -116,6 +124,20 @@ using rpc::PeriodicTimer;
 using rpc::RpcController;
 using strings::Substitute;
 
+struct Peer::PipelinedCall {
+  ThreadSafeArena arena;
+  LWConsensusRequestPB* request = nullptr;
+  LWConsensusResponsePB* response = nullptr;
+  rpc::RpcController controller;
+
+  // Whether the request was sent. It is not sent when there is nothing new for the peer.
+  bool sent = false;
+  // Whether the call could be processed, i.e. the response was received or the request was not
+  // sent.
+  bool done = false;
+  Status status;
+};
+
 Peer::Peer(
     const RaftPeerPB& peer_pb, string tablet_id, string leader_uuid, PeerProxyPtr proxy,
     PeerMessageQueue* queue, MultiRaftHeartbeatBatcherPtr multi_raft_batcher,
@@ -159,6 +181,9 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
   // If there are new requests in the queue we'll get them on ProcessResponse().
   auto performing_update_lock = LockPerformingUpdate(std::try_to_lock);
   if (!performing_update_lock.owns_lock()) {
+    if (trigger_mode == RequestTriggerMode::kNonEmptyOnly) {
+      return MaybeSendPipelinedRequest();
+    }
     return Status::OK();
   }
 
@@ -322,25 +347,32 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   // Heartbeat batching allows for network layer savings by reducing CPU cycles
   // spent on computing state, context switching (sending/receiving RPC's)
   // and serializing/deserializing protobufs.
-  if (req_is_heartbeat && multi_raft_batcher_
+  // Requests that only advance the committed op id could be batched as well, but they are sent
+  // without waiting for the next heartbeat interval.
+  const bool req_is_commit_update = !req_is_heartbeat && update_request_->ops().empty() &&
+                                    FLAGS_multi_raft_batch_commit_updates;
+  if ((req_is_heartbeat || req_is_commit_update) && multi_raft_batcher_
       && FLAGS_enable_multi_raft_heartbeat_batcher) {
     auto performing_heartbeat_lock = LockPerformingHeartbeat(std::try_to_lock);
-    if (!performing_heartbeat_lock.owns_lock()) {
+    if (performing_heartbeat_lock.owns_lock()) {
+      // TODO(lw_uc) support multiraft heartbeat with LW
+      update_request_->ToGoogleProtobuf(&heartbeat_request_);
+      update_response_->ToGoogleProtobuf(&heartbeat_response_);
+      cur_heartbeat_id_++;
+      processing_lock.unlock();
+      performing_update_lock.unlock();
+      performing_heartbeat_lock.release();
+      multi_raft_batcher_->AddRequestToBatch(
+          &heartbeat_request_, &heartbeat_response_,
+          std::bind(&Peer::ProcessHeartbeatResponse, retain_self, _1),
+          UrgentRequest(req_is_commit_update));
+      return;
+    }
+    if (req_is_heartbeat) {
       // Outstanding heartbeat already in flight so don't schedule another.
       return;
     }
-
-    // TODO(lw_uc) support multiraft heartbeat with LW
-    update_request_->ToGoogleProtobuf(&heartbeat_request_);
-    update_response_->ToGoogleProtobuf(&heartbeat_response_);
-    cur_heartbeat_id_++;
-    processing_lock.unlock();
-    performing_update_lock.unlock();
-    performing_heartbeat_lock.release();
-    multi_raft_batcher_->AddRequestToBatch(
-        &heartbeat_request_, &heartbeat_response_,
-        std::bind(&Peer::ProcessHeartbeatResponse, retain_self, _1));
-    return;
+    // Otherwise the committed op id update is sent as a regular request.
   }
 
   // The minimum_viable_heartbeat_ represents the
@@ -351,11 +383,191 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   // and this new request in the same order they were received by the remote peer.
   // TODO: Remove batched but unsent heartbeats (in the respective MultiRaftBatcher) in this case
   minimum_viable_heartbeat_ = cur_heartbeat_id_ + 1;
+  update_response_pending_ = true;
+  const bool pipelining = FLAGS_consensus_max_in_flight_requests_per_peer > 1;
+  if (pipelining) {
+    sending_request_ = true;
+  }
   processing_lock.unlock();
   performing_update_lock.release();
   controller_.set_invoke_callback_mode(rpc::InvokeCallbackMode::kThreadPoolHigh);
-  proxy_->UpdateAsync(update_request_, trigger_mode, update_response_, &controller_,
-                      std::bind(&Peer::ProcessResponse, retain_self));
+  SendUpdateRequest(update_request_, msgs_holder, trigger_mode, update_response_, &controller_,
+                    std::bind(&Peer::ProcessResponse, retain_self));
+
+  if (pipelining) {
+    processing_lock = StartProcessingUnlocked();
+    if (processing_lock.owns_lock()) {
+      sending_request_ = false;
+      RetryDeferredPipelinedRequest(&processing_lock);
+    }
+  }
+}
+
+void Peer::SendUpdateRequest(LWConsensusRequestPB* request,
+                             const LWReplicateMsgsHolder& msgs_holder,
+                             RequestTriggerMode trigger_mode,
+                             LWConsensusResponsePB* response,
+                             rpc::RpcController* controller,
+                             const rpc::ResponseCallback& callback) {
+  const auto& serialized_ops = msgs_holder.serialized_messages();
+  if (serialized_ops.empty() || !proxy_->SupportsSerializedOps()) {
+    proxy_->UpdateAsync(request, trigger_mode, response, controller, callback);
+    return;
+  }
+
+  DCHECK_EQ(serialized_ops.size(), request->ops().size());
+  request->mutable_ops()->clear();
+  proxy_->UpdateWithSerializedOpsAsync(request, serialized_ops, response, controller, callback);
+}
+
+Status Peer::MaybeSendPipelinedRequest() {
+  const auto max_in_flight = FLAGS_consensus_max_in_flight_requests_per_peer;
+  if (max_in_flight <= 1) {
+    return Status::OK();
+  }
+
+  auto call = std::make_shared<PipelinedCall>();
+  {
+    auto processing_lock = StartProcessingUnlocked();
+    if (!processing_lock.owns_lock()) {
+      return STATUS(IllegalState, "Peer was closed.");
+    }
+
+    // Requests are pipelined only behind a regular request that is in flight, and only while
+    // exchanges with the peer succeed. Otherwise the new operations are picked up when the
+    // outstanding response is processed.
+    if ((!update_response_pending_ && pipelined_calls_.empty()) || failed_attempts_ > 0) {
+      return Status::OK();
+    }
+
+    const auto num_in_flight = pipelined_calls_.size() + (update_response_pending_ ? 1 : 0);
+    if (sending_request_ || num_in_flight >= static_cast<size_t>(max_in_flight)) {
+      pipelined_request_deferred_ = true;
+      return Status::OK();
+    }
+
+    sending_request_ = true;
+    pipelined_calls_.push_back(call);
+    using_thread_pool_.fetch_add(1, std::memory_order_acq_rel);
+  }
+
+  auto status = raft_pool_token_->SubmitFunc(
+      std::bind(&Peer::SendPipelinedRequest, shared_from_this(), call));
+  using_thread_pool_.fetch_sub(1, std::memory_order_acq_rel);
+  if (!status.ok()) {
+    auto processing_lock = StartProcessingUnlocked();
+    if (processing_lock.owns_lock()) {
+      sending_request_ = false;
+      call->done = true;
+      ProcessPipelinedCalls(&processing_lock, /* more_pending= */ false);
+    }
+  }
+  return status;
+}
+
+void Peer::SendPipelinedRequest(const PipelinedCallPtr& call) {
+  auto retain_self = shared_from_this();
+  auto processing_lock = StartProcessingUnlocked();
+  if (!processing_lock.owns_lock()) {
+    return;
+  }
+
+  call->request = call->arena.NewObject<LWConsensusRequestPB>(&call->arena);
+  call->response = call->arena.NewObject<LWConsensusResponsePB>(&call->arena);
+  LWReplicateMsgsHolder msgs_holder;
+  auto status = queue_->PipelinedRequestForPeer(
+      peer_pb_.permanent_uuid(), call->request, &msgs_holder);
+  if (!status.ok() || call->request->ops().empty()) {
+    if (!status.ok()) {
+      VLOG_WITH_PREFIX(3) << "Pipelined request was not sent: " << status;
+    }
+    sending_request_ = false;
+    call->done = true;
+    ProcessPipelinedCalls(&processing_lock, /* more_pending= */ false);
+    return;
+  }
+
+  call->request->ref_tablet_id(tablet_id_);
+  call->request->ref_caller_uuid(leader_uuid_);
+  call->request->ref_dest_uuid(peer_pb_.permanent_uuid());
+  call->sent = true;
+  heartbeater_->Snooze();
+  minimum_viable_heartbeat_ = cur_heartbeat_id_ + 1;
+  processing_lock.unlock();
+
+  call->controller.set_invoke_callback_mode(rpc::InvokeCallbackMode::kThreadPoolHigh);
+  SendUpdateRequest(call->request, msgs_holder, RequestTriggerMode::kNonEmptyOnly, call->response,
+                    &call->controller,
+                    std::bind(&Peer::ProcessPipelinedResponse, retain_self, call));
+
+  processing_lock = StartProcessingUnlocked();
+  if (processing_lock.owns_lock()) {
+    sending_request_ = false;
+    RetryDeferredPipelinedRequest(&processing_lock);
+  }
+}
+
+void Peer::ProcessPipelinedResponse(const PipelinedCallPtr& call) {
+  auto status = call->controller.status();
+  if (status.ok()) {
+    status = call->controller.thread_pool_failure();
+  }
+
+  auto processing_lock = StartProcessingUnlocked();
+  if (!processing_lock.owns_lock()) {
+    return;
+  }
+  call->status = status;
+  call->done = true;
+  ProcessPipelinedCalls(&processing_lock, /* more_pending= */ false);
+}
+
+void Peer::ProcessPipelinedCalls(
+    std::unique_lock<simple_spinlock>* processing_lock, bool more_pending) {
+  if (update_response_pending_) {
+    // The response to update_request_ is processed first, it will pick up the pipelined ones.
+    return;
+  }
+
+  bool had_unsent_calls = false;
+  while (!pipelined_calls_.empty() && pipelined_calls_.front()->done) {
+    auto call = std::move(pipelined_calls_.front());
+    pipelined_calls_.pop_front();
+    if (call->sent) {
+      more_pending = ProcessResponseWithStatus(call->status, call->response, /* pipelined= */ true);
+    } else {
+      had_unsent_calls = true;
+    }
+  }
+
+  if (!pipelined_calls_.empty()) {
+    RetryDeferredPipelinedRequest(processing_lock);
+    return;
+  }
+
+  // All requests in flight were processed, so performing_update_mutex_ is not needed anymore.
+  auto performing_update_lock = LockPerformingUpdate(std::adopt_lock);
+  pipelined_request_deferred_ = false;
+  if (!more_pending && !had_unsent_calls) {
+    return;
+  }
+
+  // Operations could have been appended after an empty pipelined request was assembled, so ask
+  // the queue for them.
+  processing_lock->unlock();
+  performing_update_lock.release();
+  SendNextRequest(
+      more_pending ? RequestTriggerMode::kAlwaysSend : RequestTriggerMode::kNonEmptyOnly);
+}
+
+void Peer::RetryDeferredPipelinedRequest(std::unique_lock<simple_spinlock>* processing_lock) {
+  if (!pipelined_request_deferred_) {
+    processing_lock->unlock();
+    return;
+  }
+  pipelined_request_deferred_ = false;
+  processing_lock->unlock();
+  WARN_NOT_OK(MaybeSendPipelinedRequest(), "Failed to send pipelined request");
 }
 
 std::unique_lock<simple_spinlock> Peer::StartProcessingUnlocked() {
@@ -369,8 +581,10 @@ std::unique_lock<simple_spinlock> Peer::StartProcessingUnlocked() {
 }
 
 bool Peer::ProcessResponseWithStatus(const Status& status,
-                                     LWConsensusResponsePB* response) {
+                                     LWConsensusResponsePB* response,
+                                     bool pipelined) {
   if (!status.ok()) {
+    queue_->RequestFailed(peer_pb_.permanent_uuid(), pipelined);
     if (status.IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
       // failure to serialize a protobuf. Therefore, we generally consider these errors to indicate
@@ -395,6 +609,7 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
         Substitute("Leader communication with peer $0 received error $1, will try to "
                    "evict peer", peer_pb_.permanent_uuid(),
                    response->error().ShortDebugString()));
+    queue_->RequestFailed(peer_pb_.permanent_uuid(), pipelined);
     ProcessResponseError(StatusFromPB(response->error().status()));
     return false;
   }
@@ -428,11 +643,15 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
+    queue_->RequestFailed(peer_pb_.permanent_uuid(), pipelined);
     ProcessResponseError(StatusFromPB(response->error().status()));
     return false;
   }
 
   failed_attempts_ = 0;
+  if (pipelined) {
+    return queue_->PipelinedResponseFromPeer(peer_pb_.permanent_uuid(), *response);
+  }
   return queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), *response);
 }
 
@@ -449,8 +668,16 @@ void Peer::ProcessResponse() {
   if (!processing_lock.owns_lock()) {
     return;
   }
+  update_response_pending_ = false;
   bool more_pending = ProcessResponseWithStatus(status, update_response_);
 
+  if (!pipelined_calls_.empty()) {
+    // Requests pipelined behind this one keep performing the update.
+    performing_update_lock.release();
+    ProcessPipelinedCalls(&processing_lock, more_pending);
+    return;
+  }
+
   if (more_pending) {
     processing_lock.unlock();
     performing_update_lock.release();
@@ -585,6 +812,65 @@ Peer::~Peer() {
   CHECK_EQ(state_, kPeerClosed) << "Peer cannot be implicitly closed";
 }
 
+namespace {
+
+// ConsensusRequestPB that consists of the request without operations, followed by already
+// serialized operations. Protobuf parsers accept fields in any order, so it is wire compatible with
+// the regular request.
+class LWConsensusRequestWithSerializedOps : public LWConsensusRequestPB {
+ public:
+  LWConsensusRequestWithSerializedOps(
+      const LWConsensusRequestPB& request, const SerializedReplicateMsgs& ops)
+      : LWConsensusRequestPB(&request.arena()), request_(request), ops_(ops) {
+    DCHECK(request.ops().empty());
+  }
+
+  Status ParseFromCodedStream(google::protobuf::io::CodedInputStream* cis) override {
+    return STATUS(NotSupported, "Request with serialized ops could only be sent");
+  }
+
+  size_t SerializedSize() const override {
+    using google::protobuf::io::CodedOutputStream;
+    size_t result = request_.SerializedSize();
+    for (const auto& op : ops_) {
+      result += CodedOutputStream::VarintSize32(kOpsTag) +
+                CodedOutputStream::VarintSize32(narrow_cast<uint32_t>(op.size())) + op.size();
+    }
+    return result;
+  }
+
+  uint8_t* SerializeToArray(uint8_t* out) const override {
+    using google::protobuf::io::CodedOutputStream;
+    out = request_.SerializeToArray(out);
+    for (const auto& op : ops_) {
+      out = CodedOutputStream::WriteTagToArray(kOpsTag, out);
+      out = CodedOutputStream::WriteVarint32ToArray(narrow_cast<uint32_t>(op.size()), out);
+      memcpy(out, op.data(), op.size());
+      out += op.size();
+    }
+    return out;
+  }
+
+  void AppendToDebugString(std::string* out) const override {
+    request_.AppendToDebugString(out);
+    *out += Format(" serialized_ops: $0", ops_.size());
+  }
+
+  void Clear() override {
+    LOG(DFATAL) << "Request with serialized ops could not be cleared";
+  }
+
+ private:
+  static constexpr uint32_t kOpsTag = google::protobuf::internal::WireFormatLite::MakeTag(
+      ConsensusRequestPB::kOpsFieldNumber,
+      google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+
+  const LWConsensusRequestPB& request_;
+  const SerializedReplicateMsgs& ops_;
+};
+
+} // namespace
+
 RpcPeerProxy::RpcPeerProxy(HostPort hostport, ConsensusServiceProxyPtr consensus_proxy)
     : hostport_(std::move(hostport)), consensus_proxy_(std::move(consensus_proxy)) {
 }
@@ -598,6 +884,18 @@ void RpcPeerProxy::UpdateAsync(const LWConsensusRequestPB* request,
   consensus_proxy_->UpdateConsensusAsync(*request, response, controller, callback);
 }
 
+void RpcPeerProxy::UpdateWithSerializedOpsAsync(const LWConsensusRequestPB* request,
+                                                const SerializedReplicateMsgs& ops,
+                                                LWConsensusResponsePB* response,
+                                                rpc::RpcController* controller,
+                                                const rpc::ResponseCallback& callback) {
+  controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  // The request is serialized before UpdateConsensusAsync returns, so it is safe to pass a
+  // temporary object here.
+  LWConsensusRequestWithSerializedOps request_with_ops(*request, ops);
+  consensus_proxy_->UpdateConsensusAsync(request_with_ops, response, controller, callback);
+}
+
 void RpcPeerProxy::RequestConsensusVoteAsync(const VoteRequestPB* request,
                                              VoteResponsePB* response,
                                              rpc::RpcController* controller,
@@ -37,6 +37,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -125,6 +126,12 @@ namespace consensus {
 //        v                               v
 //  SignalRequest()                    return
 //
+// When FLAGS_consensus_max_in_flight_requests_per_peer is greater than 1 and the peer is in sync
+// with the leader, SignalRequest() does not wait for the outstanding request. Instead, it sends a
+// pipelined request containing the operations appended after those already in flight. Responses
+// are processed in the order requests were sent, and the peer returns to sending a single request
+// at a time as soon as an exchange fails.
+//
 class Peer;
 typedef std::shared_ptr<Peer> PeerPtr;
 
@@ -180,8 +187,32 @@ class Peer : public std::enable_shared_from_this<Peer> {
   }
 
  private:
+  struct PipelinedCall;
+  using PipelinedCallPtr = std::shared_ptr<PipelinedCall>;
+
   void SendNextRequest(RequestTriggerMode trigger_mode);
 
+  // Sends the update request to the peer, using the serialized form of operations from
+  // msgs_holder when the proxy supports it.
+  void SendUpdateRequest(LWConsensusRequestPB* request,
+                         const LWReplicateMsgsHolder& msgs_holder,
+                         RequestTriggerMode trigger_mode,
+                         LWConsensusResponsePB* response,
+                         rpc::RpcController* controller,
+                         const rpc::ResponseCallback& callback);
+
+  // Sends a request behind the ones that are already in flight, if the window allows it.
+  Status MaybeSendPipelinedRequest();
+  void SendPipelinedRequest(const PipelinedCallPtr& call);
+  void ProcessPipelinedResponse(const PipelinedCallPtr& call);
+
+  // Processes responses to pipelined requests that are ready to be processed in order. Once all
+  // in-flight requests are processed, sends the next request or stops performing the update.
+  void ProcessPipelinedCalls(std::unique_lock<simple_spinlock>* processing_lock, bool more_pending);
+
+  // Retries the deferred pipelined request, if any. Releases processing_lock.
+  void RetryDeferredPipelinedRequest(std::unique_lock<simple_spinlock>* processing_lock);
+
   // Signals that a response was received from the peer. This method does response handling that
   // requires IO or may block.
   void ProcessResponse();
@@ -191,7 +222,8 @@ class Peer : public std::enable_shared_from_this<Peer> {
 
   // Returns true if there are more pending ops to process, false otherwise.
   bool ProcessResponseWithStatus(const Status& status,
-                                 LWConsensusResponsePB* response);
+                                 LWConsensusResponsePB* response,
+                                 bool pipelined = false);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -259,8 +291,25 @@ class Peer : public std::enable_shared_from_this<Peer> {
 
   // Held if there is an outstanding request.  This is used in order to ensure that we only have a
   // single request outstanding at a time, and to wait for the outstanding requests at Close().
+  // Pipelined requests do not acquire it, they keep it locked until their responses are processed.
   AtomicTryMutex performing_update_mutex_;
 
+  // Whether update_request_ was sent and its response was not processed yet. Protected by
+  // peer_lock_, as well as pipelined_calls_.
+  bool update_response_pending_ = false;
+
+  // Requests sent while update_request_ or other pipelined requests were in flight, in the order
+  // they were sent. Responses are processed in the same order.
+  std::deque<PipelinedCallPtr> pipelined_calls_;
+
+  // Whether a request is being assembled or passed to the proxy, so a pipelined request cannot be
+  // sent yet without risking to overtake it.
+  bool sending_request_ = false;
+
+  // Whether a pipelined request was not sent because of the window size or a request being sent.
+  // It is retried once the window moves.
+  bool pipelined_request_deferred_ = false;
+
   // Held if there is an outstanding heartbeat request.
   // This is used in order to ensure that we only have a
   // single heartbeat request outstanding at a time.
@@ -305,6 +354,21 @@ class PeerProxy {
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) = 0;
 
+  // Whether UpdateWithSerializedOpsAsync is supported by this proxy.
+  virtual bool SupportsSerializedOps() const {
+    return false;
+  }
+
+  // Same as UpdateAsync, but operations are sent using their serialized form 'ops', and the
+  // request itself should not contain any operations.
+  virtual void UpdateWithSerializedOpsAsync(const LWConsensusRequestPB* request,
+                                            const SerializedReplicateMsgs& ops,
+                                            LWConsensusResponsePB* response,
+                                            rpc::RpcController* controller,
+                                            const rpc::ResponseCallback& callback) {
+    LOG(DFATAL) << "Not implemented";
+  }
+
   // Sends a RequestConsensusVote to a remote peer.
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
@@ -363,6 +427,16 @@ class RpcPeerProxy : public PeerProxy {
                            rpc::RpcController* controller,
                            const rpc::ResponseCallback& callback) override;
 
+  bool SupportsSerializedOps() const override {
+    return true;
+  }
+
+  void UpdateWithSerializedOpsAsync(const LWConsensusRequestPB* request,
+                                    const SerializedReplicateMsgs& ops,
+                                    LWConsensusResponsePB* response,
+                                    rpc::RpcController* controller,
+                                    const rpc::ResponseCallback& callback) override;
+
   virtual void RequestConsensusVoteAsync(const VoteRequestPB* request,
                                          VoteResponsePB* response,
                                          rpc::RpcController* controller,
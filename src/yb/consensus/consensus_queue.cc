@@ -112,6 +112,11 @@ DEFINE_RUNTIME_int32(consensus_lagging_follower_threshold, 10,
     "-1 disables the feature.");
 TAG_FLAG(consensus_lagging_follower_threshold, advanced);
 
+DEFINE_RUNTIME_bool(consensus_send_serialized_ops, false,
+    "Send operations to followers using their serialized form cached in the log cache, instead "
+    "of serializing them for each follower request.");
+TAG_FLAG(consensus_send_serialized_ops, advanced);
+
 DEFINE_RUNTIME_int64(cdc_intent_retention_ms, 4 * 3600 * 1000,
     "Interval up to which CDC consumer's checkpoint is considered for retaining intents."
     "If we haven't received an updated checkpoint from CDC consumer within the interval "
@@ -219,13 +224,15 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
                                    const string& tablet_id,
                                    const server::ClockPtr& clock,
                                    ConsensusContext* context,
-                                   unique_ptr<ThreadPoolToken> raft_pool_token)
+                                   unique_ptr<ThreadPoolToken> raft_pool_token,
+                                   unique_ptr<ThreadPoolToken> log_cache_read_ahead_token)
     : raft_pool_observers_token_(std::move(raft_pool_token)),
       local_peer_pb_(local_peer_pb),
       local_peer_uuid_(local_peer_pb_.has_permanent_uuid() ? local_peer_pb_.permanent_uuid()
                                                            : string()),
       tablet_id_(tablet_id),
-      log_cache_(metric_entity, log, server_tracker, local_peer_pb.permanent_uuid(), tablet_id),
+      log_cache_(metric_entity, log, server_tracker, local_peer_pb.permanent_uuid(), tablet_id,
+                 std::move(log_cache_read_ahead_token)),
       operations_mem_tracker_(
           MemTracker::FindOrCreateTracker("OperationsFromDisk", parent_tracker)),
       metrics_(metric_entity),
@@ -482,6 +489,27 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         bool* needs_remote_bootstrap,
                                         PeerMemberType* member_type,
                                         bool* last_exchange_successful) {
+  return DoRequestForPeer(
+      uuid, /* pipelined= */ false, request, msgs_holder, needs_remote_bootstrap, member_type,
+      last_exchange_successful);
+}
+
+Status PeerMessageQueue::PipelinedRequestForPeer(const string& uuid,
+                                                 LWConsensusRequestPB* request,
+                                                 LWReplicateMsgsHolder* msgs_holder) {
+  bool needs_remote_bootstrap = false;
+  return DoRequestForPeer(
+      uuid, /* pipelined= */ true, request, msgs_holder, &needs_remote_bootstrap,
+      /* member_type= */ nullptr, /* last_exchange_successful= */ nullptr);
+}
+
+Status PeerMessageQueue::DoRequestForPeer(const string& uuid,
+                                          bool pipelined,
+                                          LWConsensusRequestPB* request,
+                                          LWReplicateMsgsHolder* msgs_holder,
+                                          bool* needs_remote_bootstrap,
+                                          PeerMemberType* member_type,
+                                          bool* last_exchange_successful) {
   static constexpr uint64_t kSendUnboundedLogOps = std::numeric_limits<uint64_t>::max();
   DCHECK(request->ops().empty()) << request->ShortDebugString();
 
@@ -492,6 +520,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   int64_t previously_sent_index;
   uint64_t num_log_ops_to_send;
   HybridTime propagated_safe_time;
+  TrackedPeer::PipelinedLease lease;
 
   // Should be before now_ht, i.e. not greater than propagated_hybrid_time.
   if (context_) {
@@ -510,6 +539,12 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
       return STATUS(NotFound, "Peer not tracked or queue not in leader mode.");
     }
 
+    if (pipelined && (peer->is_new || !peer->is_last_exchange_successful ||
+                      peer->needs_remote_bootstrap ||
+                      peer->pipelined_next_index == kInvalidOpIdIndex)) {
+      return STATUS_FORMAT(IllegalState, "Cannot pipeline requests to peer: $0", *peer);
+    }
+
     HybridTime now_ht;
 
     is_new = peer->is_new;
@@ -533,9 +568,15 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
 
       // Because of coarse clocks we subtract 2ms, to be sure that our local version of lease
       // does not expire after it expires at follower.
-      peer->leader_lease_expiration.last_sent =
+      lease.leader_lease_expiration =
           CoarseMonoClock::Now() + leader_lease_duration_ms * 1ms - kCoarseClockPrecision * 2;
-      peer->leader_ht_lease_expiration.last_sent = ht_lease_expiration_micros;
+      lease.ht_lease_expiration = ht_lease_expiration_micros;
+      // Leases of a pipelined request are remembered until its response arrives, so that the
+      // responses to the requests sent before it do not extend the leases too far.
+      if (!pipelined) {
+        peer->leader_lease_expiration.last_sent = lease.leader_lease_expiration;
+        peer->leader_ht_lease_expiration.last_sent = lease.ht_lease_expiration;
+      }
     } else {
       now_ht = clock_->Now();
       request->clear_leader_lease_duration_ms();
@@ -582,19 +623,28 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     if (last_exchange_successful) *last_exchange_successful = peer->is_last_exchange_successful;
     *needs_remote_bootstrap = peer->needs_remote_bootstrap;
 
-    previously_sent_index = peer->next_index - 1;
-    if (FLAGS_enable_consensus_exponential_backoff && peer->last_num_messages_sent >= 0) {
-      // Previous request to peer has not been acked. Reduce number of entries to be sent
-      // in this attempt using exponential backoff. Note that to_index is inclusive.
-      num_log_ops_to_send = GetNumMessagesToSendWithBackoff(peer->last_num_messages_sent);
-    } else {
-      // Previous request to peer has been acked or a heartbeat response has been received.
-      // Transmit as many entries as allowed.
+    if (pipelined) {
+      // The peer is in sync with us, so the request continues right after the operations that are
+      // already in flight.
+      previously_sent_index = peer->pipelined_next_index - 1;
       num_log_ops_to_send = kSendUnboundedLogOps;
+    } else {
+      previously_sent_index = peer->next_index - 1;
+      // There are no other requests in flight, so pipelined requests will follow this one.
+      peer->pipelined_next_index = peer->next_index;
+      peer->pipelined_leases.clear();
+      if (FLAGS_enable_consensus_exponential_backoff && peer->last_num_messages_sent >= 0) {
+        // Previous request to peer has not been acked. Reduce number of entries to be sent
+        // in this attempt using exponential backoff. Note that to_index is inclusive.
+        num_log_ops_to_send = GetNumMessagesToSendWithBackoff(peer->last_num_messages_sent);
+      } else {
+        // Previous request to peer has been acked or a heartbeat response has been received.
+        // Transmit as many entries as allowed.
+        num_log_ops_to_send = kSendUnboundedLogOps;
+      }
+      peer->current_retransmissions++;
     }
 
-    peer->current_retransmissions++;
-
     if (peer->member_type == PeerMemberType::VOTER) {
       is_voter = true;
     }
@@ -661,14 +711,31 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
         return STATUS(NotFound, "Peer not tracked.");
       }
 
-      peer->last_num_messages_sent = result->messages.size();
+      if (pipelined) {
+        if (peer->pipelined_next_index != previously_sent_index + 1) {
+          return STATUS_FORMAT(IllegalState, "Pipeline to peer was reset: $0", *peer);
+        }
+        if (!result->messages.empty()) {
+          peer->pipelined_leases.push_back(lease);
+        }
+      } else {
+        peer->last_num_messages_sent = result->messages.size();
+      }
+      if (!result->messages.empty()) {
+        peer->pipelined_next_index = result->messages.back()->id().index() + 1;
+      }
     }
 
     ScopedTrackedConsumption consumption;
     if (result->read_from_disk_size) {
       consumption = ScopedTrackedConsumption(operations_mem_tracker_, result->read_from_disk_size);
     }
-    *msgs_holder = LWReplicateMsgsHolder(std::move(result->messages), std::move(consumption));
+    SerializedReplicateMsgs serialized_messages;
+    if (FLAGS_consensus_send_serialized_ops && !result->messages.empty()) {
+      serialized_messages = log_cache_.SerializeOps(result->messages);
+    }
+    *msgs_holder = LWReplicateMsgsHolder(
+        std::move(result->messages), std::move(consumption), std::move(serialized_messages));
 
     if (propagated_safe_time &&
         !result->have_more_messages &&
@@ -1207,8 +1274,33 @@ void PeerMessageQueue::RequestWasNotSent(const std::string& peer_uuid) {
 }
 
 
+void PeerMessageQueue::RequestFailed(const std::string& peer_uuid, bool pipelined) {
+  LockGuard scoped_lock(queue_lock_);
+
+  TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+  if (PREDICT_FALSE(queue_state_.state != State::kQueueOpen || peer == nullptr)) {
+    return;
+  }
+
+  if (pipelined && !peer->pipelined_leases.empty()) {
+    peer->pipelined_leases.pop_front();
+  }
+  peer->pipelined_next_index = kInvalidOpIdIndex;
+}
+
 bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
                                         const LWConsensusResponsePB& response) {
+  return DoResponseFromPeer(peer_uuid, /* pipelined= */ false, response);
+}
+
+bool PeerMessageQueue::PipelinedResponseFromPeer(const std::string& peer_uuid,
+                                                 const LWConsensusResponsePB& response) {
+  return DoResponseFromPeer(peer_uuid, /* pipelined= */ true, response);
+}
+
+bool PeerMessageQueue::DoResponseFromPeer(const std::string& peer_uuid,
+                                          bool pipelined,
+                                          const LWConsensusResponsePB& response) {
   MajorityReplicatedData majority_replicated;
   Mode mode_copy;
   bool result = false;
@@ -1224,6 +1316,15 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       return false;
     }
 
+    if (pipelined && !peer->pipelined_leases.empty()) {
+      // Responses are processed in the order requests were sent, so the front entry belongs to
+      // the request this response is for.
+      const auto& lease = peer->pipelined_leases.front();
+      peer->leader_lease_expiration.last_sent = lease.leader_lease_expiration;
+      peer->leader_ht_lease_expiration.last_sent = lease.ht_lease_expiration;
+      peer->pipelined_leases.pop_front();
+    }
+
     // Remotely bootstrap the peer if the tablet is not found or deleted.
     if (response.has_error()) {
       // We only let special types of errors through to this point from the peer.
@@ -1231,6 +1332,7 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
           << response.ShortDebugString();
 
       peer->needs_remote_bootstrap = true;
+      peer->pipelined_next_index = kInvalidOpIdIndex;
       // Since we received a response from the peer, we know it is alive. So we need to update
       // peer->last_successful_communication_time, otherwise, we will remove this peer from the
       // configuration if the remote bootstrap is not completed within
@@ -1300,8 +1402,16 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
         peer->next_index = peer->last_known_committed_idx + 1;
       }
 
+      if (pipelined && peer->last_received < previous.last_received) {
+        // A pipelined request is only sent to a peer that is in sync with us, and the operations
+        // it acknowledged in the current term cannot be lost. So a lower last received op means
+        // that the peer processed this request before the one preceding it, and rejected it.
+        peer->last_received = previous.last_received;
+      }
+
       if (PREDICT_FALSE(status.has_error())) {
         peer->is_last_exchange_successful = false;
+        peer->pipelined_next_index = kInvalidOpIdIndex;
         switch (status.error().code()) {
           case ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH: {
             DCHECK(status.has_last_received());
@@ -32,6 +32,7 @@
 
 #pragma once
 
+#include <deque>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -106,8 +107,9 @@ struct FollowerWatermark {
 // This also takes care of pushing requests to peers as new operations are added, and notifying
 // RaftConsensus when the commit index advances.
 //
-// TODO Currently this class is able to track one outstanding operation per peer. If we want to have
-// more than one outstanding RPC we need to modify it.
+// Usually there is one outstanding request per peer. When the peer is in sync with the leader,
+// additional requests could be pipelined behind it, see PipelinedRequestForPeer(). Responses to
+// those requests should be passed to the queue in the order the requests were sent.
 class PeerMessageQueue {
  public:
   struct TrackedPeer {
@@ -151,6 +153,11 @@ class PeerMessageQueue {
     // Next index to send to the peer.  This corresponds to "nextIndex" as specified in Raft.
     int64_t next_index = kInvalidOpIdIndex;
 
+    // Next index to send to the peer in a pipelined request, i.e. the index following the last
+    // operation sent to it so far. kInvalidOpIdIndex when requests to the peer cannot be pipelined
+    // until the next regular request, for instance after a failed exchange.
+    int64_t pipelined_next_index = kInvalidOpIdIndex;
+
     // Number of ops starting from next_index_ to retransmit.
     int64_t last_num_messages_sent = -1;
 
@@ -185,6 +192,15 @@ class PeerMessageQueue {
     // History cutoff from this follower's point of view.
     FollowerWatermark<HybridTime> history_cutoff{HybridTime::kMin};
 
+    // Leader leases sent with pipelined requests that are still in flight, in the order the
+    // requests were sent. A response extends the leases only up to the values sent with the
+    // request it corresponds to.
+    struct PipelinedLease {
+      CoarseTimePoint leader_lease_expiration;
+      MicrosTime ht_lease_expiration = 0;
+    };
+    std::deque<PipelinedLease> pipelined_leases;
+
     // Whether the follower was detected to need remote bootstrap.
     bool needs_remote_bootstrap = false;
 
@@ -218,7 +234,8 @@ class PeerMessageQueue {
                    const std::string& tablet_id,
                    const server::ClockPtr& clock,
                    ConsensusContext* context,
-                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token);
+                   std::unique_ptr<ThreadPoolToken> raft_pool_observers_token,
+                   std::unique_ptr<ThreadPoolToken> log_cache_read_ahead_token = nullptr);
 
   // Initialize the queue.
   virtual void Init(const OpId& last_locally_replicated);
@@ -299,6 +316,15 @@ class PeerMessageQueue {
       PeerMemberType* member_type = nullptr,
       bool* last_exchange_successful = nullptr);
 
+  // Assembles a request that continues right after the operations already sent to the peer, while
+  // the previous requests are still in flight. Returns an empty request if there is nothing new to
+  // send, and IllegalState if the peer is not known to be in sync with the leader, in which case
+  // the caller should wait for the outstanding responses and use RequestForPeer().
+  Status PipelinedRequestForPeer(
+      const std::string& uuid,
+      LWConsensusRequestPB* request,
+      LWReplicateMsgsHolder* msgs_holder);
+
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
   // peer->needs_remote_bootstrap to false.
@@ -321,8 +347,16 @@ class PeerMessageQueue {
   virtual bool ResponseFromPeer(const std::string& peer_uuid,
                                 const LWConsensusResponsePB& response);
 
+  // Same as ResponseFromPeer(), but for a request assembled by PipelinedRequestForPeer().
+  bool PipelinedResponseFromPeer(const std::string& peer_uuid,
+                                 const LWConsensusResponsePB& response);
+
   void RequestWasNotSent(const std::string& peer_uuid);
 
+  // Notifies the queue that no valid response was received for a request sent to the peer. Stops
+  // pipelining requests to the peer until the next regular request.
+  void RequestFailed(const std::string& peer_uuid, bool pipelined);
+
   // Closes the queue, peers are still allowed to call UntrackPeer() and ResponseFromPeer() but no
   // additional peers can be tracked or messages queued.
   virtual void Close();
@@ -435,6 +469,19 @@ class PeerMessageQueue {
   static const char* StateToStr(State state);
   friend std::ostream& operator <<(std::ostream& out, State mode);
 
+  Status DoRequestForPeer(
+      const std::string& uuid,
+      bool pipelined,
+      LWConsensusRequestPB* request,
+      LWReplicateMsgsHolder* msgs_holder,
+      bool* needs_remote_bootstrap,
+      PeerMemberType* member_type,
+      bool* last_exchange_successful);
+
+  bool DoResponseFromPeer(const std::string& peer_uuid,
+                          bool pipelined,
+                          const LWConsensusResponsePB& response);
+
   static constexpr ssize_t kUninitializedMajoritySize = -1;
 
   struct QueueState {
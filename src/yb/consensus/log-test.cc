@@ -34,6 +34,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <thread>
 #include <vector>
 
 #include <boost/function.hpp>
@@ -45,6 +46,7 @@
 #include "yb/consensus/log.messages.h"
 #include "yb/consensus/log-test-base.h"
 #include "yb/consensus/log_index.h"
+#include "yb/consensus/log_sync_group.h"
 #include "yb/consensus/opid_util.h"
 
 #include "yb/gutil/stl_util.h"
@@ -53,13 +55,18 @@
 #include "yb/util/random.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/test_thread_holder.h"
 #include "yb/util/flags.h"
 
 DEFINE_UNKNOWN_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
 
 DECLARE_int32(log_min_segments_to_retain);
+DECLARE_bool(log_enable_entry_batch_compression);
+DECLARE_bool(log_entry_batch_compression_format);
+DECLARE_bool(log_enable_file_system_group_sync);
 DECLARE_bool(never_fsync);
+DECLARE_int32(TEST_log_sync_group_delay_ms);
 DECLARE_bool(writable_file_use_fsync);
 DECLARE_int32(o_direct_block_alignment_bytes);
 DECLARE_int32(o_direct_block_size_bytes);
@@ -280,6 +287,51 @@ TEST_F(LogTest, TestFsync) {
   ASSERT_OK(log_->Close());
 }
 
+#if defined(__linux__)
+TEST_F(LogTest, TestFsyncWithFileSystemGroupSync) {
+  FLAGS_never_fsync = false;
+  FLAGS_log_enable_file_system_group_sync = true;
+  options_.durable_wal_write = true;
+  BuildLog();
+
+  auto group_result = LogSyncGroup::ForDirectory(tablet_wal_path_);
+  if (!group_result.ok() && group_result.status().IsNotSupported()) {
+    LOG(INFO) << "Log sync group is not supported: " << group_result.status();
+    ASSERT_OK(log_->Close());
+    return;
+  }
+  // Logs in the same file system share the group.
+  auto group = ASSERT_RESULT(std::move(group_result));
+  ASSERT_EQ(group, ASSERT_RESULT(LogSyncGroup::ForDirectory(fs_manager_->GetWalRootDirs()[0])));
+
+  OpIdPB opid;
+  opid.set_term(0);
+  opid.set_index(1);
+
+  FLAGS_TEST_log_sync_group_delay_ms = 10;
+  TestThreadHolder thread_holder;
+  constexpr int kThreads = 4;
+  constexpr int kSyncsPerThread = 10;
+  for (int i = 0; i != kThreads; ++i) {
+    thread_holder.AddThreadFunctor([group] {
+      for (int j = 0; j != kSyncsPerThread; ++j) {
+        ASSERT_OK(group->Sync());
+      }
+    });
+  }
+  ASSERT_OK(AppendNoOps(&opid, 10));
+  thread_holder.JoinAll();
+
+  // Concurrent syncs should share rounds.
+  auto num_requests = group->TEST_num_requests();
+  auto num_rounds = group->TEST_num_rounds();
+  LOG(INFO) << "Sync requests: " << num_requests << ", rounds: " << num_rounds;
+  ASSERT_GE(num_requests, static_cast<uint64_t>(kThreads * kSyncsPerThread));
+  ASSERT_LT(num_rounds, num_requests);
+  ASSERT_OK(log_->Close());
+}
+#endif
+
 // Tests interval for durable wal write
 TEST_F(LogTest, TestFsyncInterval) {
   options_.interval_durable_wal_write = MonoDelta::FromMilliseconds(1);
@@ -906,6 +958,64 @@ TEST_F(LogTest, TestWriteManyBatches) {
   }
 }
 
+// Compression should not be used until all processes are able to read compressed segments.
+TEST_F(LogTest, TestEntryBatchCompressionFormatNotEnabled) {
+  FLAGS_log_enable_entry_batch_compression = true;
+  FLAGS_log_entry_batch_compression_format = false;
+  BuildLog();
+  AppendReplicateBatch(MakeOpId(1, 1), MakeOpId(0, 0));
+  ASSERT_OK(log_->Close());
+
+  std::unique_ptr<LogReader> reader;
+  ASSERT_OK(LogReader::Open(
+      fs_manager_->env(), /* index= */ nullptr, "Log reader: ", tablet_wal_path_,
+      /* table_metric_entity= */ nullptr, /* tablet_metric_entity= */ nullptr, &reader));
+
+  SegmentSequence segments;
+  ASSERT_OK(reader->GetSegmentsSnapshot(&segments));
+  ASSERT_FALSE(segments.empty());
+  for (const auto& segment : segments) {
+    ASSERT_EQ(segment->header().compression_type(), LogCompressionTypePB::LOG_COMPRESSION_NONE);
+  }
+}
+
+TEST_F(LogTest, TestCompressedEntryBatches) {
+  FLAGS_log_enable_entry_batch_compression = true;
+  FLAGS_log_entry_batch_compression_format = true;
+  constexpr int64_t kNumBatches = 20;
+  BuildLog();
+
+  const std::string compressible_value(1_KB, 'x');
+  for (int64_t i = 1; i <= kNumBatches; ++i) {
+    // Mix batches that compress well with batches that are stored as is.
+    std::vector<TupleForAppend> writes;
+    if (i % 2 == 0) {
+      writes.emplace_back(
+          /* key */ narrow_cast<int32_t>(i), /* int_val */ 0, /* string_val */ compressible_value);
+    }
+    AppendReplicateBatch(MakeOpId(1, i), MakeOpId(0, 0), std::move(writes));
+  }
+  ASSERT_OK(log_->Close());
+
+  std::unique_ptr<LogReader> reader;
+  ASSERT_OK(LogReader::Open(
+      fs_manager_->env(), /* index= */ nullptr, "Log reader: ", tablet_wal_path_,
+      /* table_metric_entity= */ nullptr, /* tablet_metric_entity= */ nullptr, &reader));
+
+  SegmentSequence segments;
+  ASSERT_OK(reader->GetSegmentsSnapshot(&segments));
+  int64_t num_entries = 0;
+  for (const auto& segment : segments) {
+    ASSERT_EQ(segment->header().compression_type(), LogCompressionTypePB::LOG_COMPRESSION_LZ4);
+    auto read_entries = segment->ReadEntries();
+    ASSERT_OK(read_entries.status);
+    for (const auto& entry : read_entries.entries) {
+      ASSERT_EQ(entry->replicate().id().index(), ++num_entries);
+    }
+  }
+  ASSERT_EQ(num_entries, kNumBatches);
+}
+
 // This tests that querying LogReader works.
 // This sets up a reader with some segments to query which amount to the
 // following:
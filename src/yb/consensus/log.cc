@@ -52,6 +52,7 @@
 #include "yb/consensus/log_index.h"
 #include "yb/consensus/log_metrics.h"
 #include "yb/consensus/log_reader.h"
+#include "yb/consensus/log_sync_group.h"
 #include "yb/consensus/log_util.h"
 
 #include "yb/fs/fs_manager.h"
@@ -139,6 +140,24 @@ DEFINE_UNKNOWN_double(log_background_sync_interval_fraction, 0.6,
              "entry exceeds interval_durable_wal_write_ms*log_background_sync_interval_fraction "
              "the fsync task is pushed to the log-sync queue.");
 
+DEFINE_RUNTIME_bool(log_enable_entry_batch_compression, false,
+                    "Whether entry batches of new WAL segments should be compressed with LZ4. "
+                    "Takes effect starting from the next allocated segment, once "
+                    "log_entry_batch_compression_format is set.");
+TAG_FLAG(log_enable_entry_batch_compression, advanced);
+
+// Segments with compressed entry batches could not be read by versions that do not support them,
+// e.g. after rollback or by remote bootstrap to a server that is not upgraded yet.
+DEFINE_RUNTIME_AUTO_bool(log_entry_batch_compression_format, kLocalPersisted, false, true,
+    "Whether WAL segments could be written with compressed entry batches.");
+
+DEFINE_NON_RUNTIME_bool(log_enable_file_system_group_sync, false,
+    "Whether WAL syncs of all tablets stored on the same file system should be coalesced into a "
+    "single file system wide sync (syncfs). Beneficial with many tablets per server and durable "
+    "WAL writes, when WAL directories are not shared with data directories. Requires Linux 5.8 or "
+    "later, otherwise each log is synced separately.");
+TAG_FLAG(log_enable_file_system_group_sync, advanced);
+
 
 // Flags for controlling kernel watchdog limits.
 DEFINE_RUNTIME_int32(consensus_log_scoped_watch_delay_callback_threshold_ms, 1000,
@@ -634,6 +653,14 @@ Status Log::Init() {
   CHECK_EQ(kLogInitialized, log_state_);
   // Init the index
   log_index_ = VERIFY_RESULT(LogIndex::NewLogIndex(wal_dir_));
+  if (FLAGS_log_enable_file_system_group_sync) {
+    auto sync_group = LogSyncGroup::ForDirectory(wal_dir_);
+    if (sync_group.ok()) {
+      sync_group_ = std::move(*sync_group);
+    } else {
+      LOG_WITH_PREFIX(WARNING) << "Failed to use file system group sync: " << sync_group.status();
+    }
+  }
   // Reader for previous segments.
   RETURN_NOT_OK(LogReader::Open(get_env(),
                                 log_index_,
@@ -1000,7 +1027,7 @@ Status Log::DoSync() {
   LOG_SLOW_EXECUTION_EVERY_N_SECS(INFO, /* log at most one slow execution every 1 sec */ 1,
                                   50, "Fsync log took a long time") {
     SCOPED_LATENCY_METRIC(metrics_, sync_latency);
-    status = active_segment_->Sync();
+    status = active_segment_->Sync(sync_group_.get());
   }
 
   return status;
@@ -1728,6 +1755,10 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_unused_tablet_id(tablet_id_);
+  if (GetAtomicFlag(&FLAGS_log_enable_entry_batch_compression) &&
+      GetAtomicFlag(&FLAGS_log_entry_batch_compression_format)) {
+    header.set_compression_type(LogCompressionTypePB::LOG_COMPRESSION_LZ4);
+  }
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
@@ -564,6 +564,9 @@ class Log : public RefCountedThreadSafe<Log> {
   // A thread pool for performing log fsync operations.
   std::unique_ptr<ThreadPoolToken> background_sync_threadpool_token_;
 
+  // When set, syncs are coalesced with logs of other tablets on the same file system.
+  std::shared_ptr<LogSyncGroup> sync_group_;
+
   // If true, sync on all appends.
   bool durable_wal_write_;
 
@@ -59,6 +59,7 @@
 #include "yb/util/scope_exit.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/test_util.h"
+#include "yb/util/threadpool.h"
 #include "yb/util/tsan_util.h"
 
 using std::atomic;
@@ -428,6 +429,63 @@ TEST_F(LogCacheTest, TestReplaceMessages) {
             cache_->ToString());
 }
 
+TEST_F(LogCacheTest, TestSerializeOps) {
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumMessages));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  auto size_before = cache_->metrics_.size->value();
+
+  auto read_result = ASSERT_RESULT(cache_->ReadOps(0, 8_MB));
+  ASSERT_EQ(kNumMessages, read_result.messages.size());
+  auto serialized = cache_->SerializeOps(read_result.messages);
+  ASSERT_EQ(read_result.messages.size(), serialized.size());
+  size_t serialized_size = 0;
+  for (size_t i = 0; i != serialized.size(); ++i) {
+    ASSERT_EQ(read_result.messages[i]->SerializeAsString(), serialized[i].ToBuffer());
+    serialized_size += serialized[i].DynamicMemoryUsage();
+  }
+  ASSERT_EQ(size_before + serialized_size, cache_->metrics_.size->value());
+
+  // Serialized form is shared between subsequent calls.
+  auto serialized_again = cache_->SerializeOps(read_result.messages);
+  for (size_t i = 0; i != serialized.size(); ++i) {
+    ASSERT_EQ(serialized[i].data(), serialized_again[i].data());
+  }
+  ASSERT_EQ(size_before + serialized_size, cache_->metrics_.size->value());
+
+  cache_->EvictThroughOp(kNumMessages);
+  ASSERT_EQ(0, cache_->metrics_.size->value());
+}
+
+TEST_F(LogCacheTest, TestReadAhead) {
+  cache_.reset();
+  cache_.reset(new LogCache(
+      metric_entity_, log_.get(), nullptr /* mem_tracker */, kPeerUuid, kTestTablet,
+      log_thread_pool_->NewToken(ThreadPool::ExecutionMode::SERIAL)));
+  cache_->Init(MinimumOpId());
+
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumMessages));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  cache_->EvictThroughOp(kNumMessages);
+  ASSERT_EQ(0, cache_->metrics_.num_ops->value());
+
+  // Read a single operation from disk, following operations should be read ahead into the cache.
+  auto read_result = ASSERT_RESULT(cache_->ReadOps(0, 1));
+  ASSERT_EQ(1, read_result.messages.size());
+  cache_->read_ahead_token_->Wait();
+  ASSERT_EQ(kNumMessages - 1, cache_->metrics_.read_ahead_ops->value());
+  ASSERT_EQ(kNumMessages - 1, cache_->metrics_.num_ops->value());
+
+  auto disk_reads = cache_->metrics_.disk_reads->value();
+  read_result = ASSERT_RESULT(cache_->ReadOps(1, 8_MB));
+  ASSERT_EQ(kNumMessages - 1, read_result.messages.size());
+  ASSERT_EQ(MakeOpIdForIndex(2), OpId::FromPB(read_result.messages[0]->id()));
+  ASSERT_EQ(disk_reads, cache_->metrics_.disk_reads->value());
+
+  cache_->EvictThroughOp(kNumMessages);
+  ASSERT_EQ(0, cache_->metrics_.num_ops->value());
+  ASSERT_EQ(0, cache_->metrics_.size->value());
+}
+
 TEST_F(LogCacheTest, TestMTReadAndWrite) {
   atomic<bool> stop { false };
   bool stopped = false;
@@ -57,6 +57,7 @@
 #include "yb/util/result.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/status_format.h"
+#include "yb/util/threadpool.h"
 
 using std::vector;
 using std::string;
@@ -80,6 +81,12 @@ DEFINE_UNKNOWN_int32(global_log_cache_size_limit_percentage, 5,
              "entries across all tablets. Default is 5.");
 TAG_FLAG(global_log_cache_size_limit_percentage, advanced);
 
+DEFINE_RUNTIME_int64(log_cache_read_ahead_bytes, 8_MB,
+    "Max number of bytes of operations following a log cache miss that are asynchronously read "
+    "from disk into the log cache, so lagging peers don't wait for disk reads on each request. "
+    "0 to disable read ahead.");
+TAG_FLAG(log_cache_read_ahead_bytes, advanced);
+
 DEFINE_test_flag(bool, log_cache_skip_eviction, false,
                  "Don't evict log entries in tests.");
 
@@ -94,6 +101,9 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
 METRIC_DEFINE_counter(tablet, log_cache_disk_reads, "Log Cache Disk Reads",
                       yb::MetricUnit::kEntries,
                       "Amount of operations read from disk.");
+METRIC_DEFINE_counter(tablet, log_cache_read_ahead_ops, "Log Cache Read Ahead Operations",
+                      yb::MetricUnit::kEntries,
+                      "Amount of operations read from disk into the log cache in advance.");
 
 DECLARE_bool(get_changes_honor_deadline);
 
@@ -112,7 +122,8 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
                    const log::LogPtr& log,
                    const MemTrackerPtr& server_tracker,
                    const string& local_uuid,
-                   const string& tablet_id)
+                   const string& tablet_id,
+                   std::unique_ptr<ThreadPoolToken> read_ahead_token)
   : log_(log),
     local_uuid_(local_uuid),
     tablet_id_(tablet_id),
@@ -120,6 +131,7 @@ LogCache::LogCache(const scoped_refptr<MetricEntity>& metric_entity,
     next_sequential_op_index_(0),
     min_pinned_op_index_(0),
     num_batches_overwritten_cache_(0),
+    read_ahead_token_(std::move(read_ahead_token)),
     metrics_(metric_entity) {
 
   const int64_t max_ops_size_bytes = FLAGS_log_cache_size_limit_mb * 1_MB;
@@ -157,6 +169,9 @@ MemTrackerPtr LogCache::GetServerMemTracker(const MemTrackerPtr& server_tracker)
 }
 
 LogCache::~LogCache() {
+  if (read_ahead_token_) {
+    read_ahead_token_->Shutdown();
+  }
   tracker_->Release(tracker_->consumption());
   {
     std::lock_guard<simple_spinlock> l(lock_);
@@ -208,6 +223,8 @@ LogCache::PrepareAppendResult LogCache::PrepareAppendOperations(const ReplicateM
       }
     }
 
+    ++overwrite_epoch_;
+
     if (min_pinned_op_index_ < next_sequential_op_index_) {
       // There are ops in progress of flushing, increment the counter to avoid ops in the
       // current batch evicted before being flushed.
@@ -294,6 +311,67 @@ bool LogCache::HasOpBeenWritten(int64_t index) const {
   return index < next_sequential_op_index_;
 }
 
+namespace {
+
+RefCntBuffer SerializeReplicateMsg(const LWReplicateMsg& msg) {
+  RefCntBuffer result(msg.SerializedSize());
+  auto* end = msg.SerializeToArray(result.udata());
+  DCHECK_EQ(end, result.udata() + result.size());
+  return result;
+}
+
+} // namespace
+
+SerializedReplicateMsgs LogCache::SerializeOps(const ReplicateMsgs& msgs) {
+  SerializedReplicateMsgs result(msgs.size());
+  // Indexes of operations that are present in the cache, but were not serialized yet.
+  boost::container::small_vector<size_t, 8> serialized_now;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    for (size_t i = 0; i != msgs.size(); ++i) {
+      auto it = cache_.find(msgs[i]->id().index());
+      if (it == cache_.end() || it->second.msg != msgs[i]) {
+        continue;
+      }
+      if (it->second.serialized.empty()) {
+        serialized_now.push_back(i);
+      } else {
+        result[i] = it->second.serialized;
+      }
+    }
+  }
+
+  // Serialization is done outside of the lock.
+  for (size_t i = 0; i != msgs.size(); ++i) {
+    if (result[i].empty()) {
+      result[i] = SerializeReplicateMsg(*msgs[i]);
+    }
+  }
+
+  if (serialized_now.empty()) {
+    return result;
+  }
+
+  std::lock_guard<simple_spinlock> lock(lock_);
+  for (auto i : serialized_now) {
+    auto it = cache_.find(msgs[i]->id().index());
+    // The entry could be evicted, replaced or serialized by another peer while we were serializing.
+    if (it == cache_.end() || it->second.msg != msgs[i] || !it->second.serialized.empty()) {
+      continue;
+    }
+    auto& entry = it->second;
+    entry.serialized = result[i];
+    auto mem_usage = entry.serialized.DynamicMemoryUsage();
+    entry.mem_usage += mem_usage;
+    metrics_.size->IncrementBy(mem_usage);
+    if (entry.tracked) {
+      tracker_->Consume(mem_usage);
+    }
+  }
+
+  return result;
+}
+
 Result<yb::OpId> LogCache::LookupOpId(int64_t op_index) const {
   // First check the log cache itself.
   {
@@ -370,6 +448,7 @@ Result<ReadOpsResult> LogCache::ReadOps(
                                << ", to_op_index: " << to_op_index
                                << ", max_size_bytes: " << max_size_bytes;
   ReadOpsResult result;
+  bool read_from_disk = false;
   int64_t starting_op_segment_seq_num;
   int64_t next_index;
   int64_t to_index;
@@ -431,6 +510,7 @@ Result<ReadOpsResult> LogCache::ReadOps(
       metrics_.disk_reads->IncrementBy(raw_replicate_ptrs.size());
       LOG_WITH_PREFIX(INFO)
           << "Successfully read " << raw_replicate_ptrs.size() << " ops from disk.";
+      read_from_disk = true;
       l.lock();
 
       for (auto& msg : raw_replicate_ptrs) {
@@ -487,9 +567,126 @@ Result<ReadOpsResult> LogCache::ReadOps(
     }
   }
   result.have_more_messages = HaveMoreMessages(remaining_space < 0);
+
+  if (!fetch_single_entry && !result.messages.empty()) {
+    // Read following operations ahead either after a cache miss, or when the reader consumed
+    // enough of the previously read ahead operations.
+    auto last_index = result.messages.back()->id().index();
+    int64_t read_ahead_from = -1;
+    if (read_from_disk) {
+      read_ahead_from = last_index + 1;
+    } else if (read_ahead_trigger_index_ != 0 && last_index >= read_ahead_trigger_index_) {
+      read_ahead_from = std::max(last_index + 1, read_ahead_next_index_);
+    }
+    if (read_ahead_from >= 0) {
+      l.unlock();
+      StartReadAhead(read_ahead_from);
+    }
+  }
+
   return result;
 }
 
+void LogCache::StartReadAhead(int64_t from_index) {
+  auto max_bytes = FLAGS_log_cache_read_ahead_bytes;
+  if (!read_ahead_token_ || max_bytes <= 0) {
+    return;
+  }
+
+  int64_t up_to_index;
+  uint64_t overwrite_epoch;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    if (read_ahead_running_) {
+      return;
+    }
+    // Read up to the next cached operation. Operations starting from min_pinned_op_index_ are
+    // always present in the cache.
+    auto it = cache_.lower_bound(from_index);
+    up_to_index = std::min(it == cache_.end() ? next_sequential_op_index_ : it->first,
+                           min_pinned_op_index_) - 1;
+    if (up_to_index < from_index) {
+      return;
+    }
+    read_ahead_running_ = true;
+    read_ahead_trigger_index_ = 0;
+    overwrite_epoch = overwrite_epoch_;
+  }
+
+  VLOG_WITH_PREFIX(2) << "Start read ahead of ops " << from_index << ".." << up_to_index;
+  auto status = read_ahead_token_->SubmitFunc(
+      [this, from_index, up_to_index, max_bytes, overwrite_epoch] {
+    ReadAhead(from_index, up_to_index, max_bytes, overwrite_epoch);
+  });
+  if (!status.ok()) {
+    VLOG_WITH_PREFIX(1) << "Failed to submit read ahead: " << status;
+    std::lock_guard<simple_spinlock> lock(lock_);
+    read_ahead_running_ = false;
+  }
+}
+
+void LogCache::ReadAhead(
+    int64_t from_index, int64_t up_to_index, int64_t max_bytes, uint64_t overwrite_epoch) {
+  ReplicateMsgs msgs;
+  auto status = log_->GetLogReader()->ReadReplicatesInRange(
+      from_index, up_to_index, max_bytes, &msgs, /* starting_op_segment_seq_num= */ nullptr,
+      /* modified_schema= */ nullptr, /* schema_version= */ nullptr);
+  if (!status.ok()) {
+    LOG_WITH_PREFIX(WARNING) << "Failed to read ahead ops " << from_index << ".." << up_to_index
+                             << ": " << status;
+  }
+
+  // SpaceUsed is relatively expensive, so do calculations outside the lock.
+  std::vector<CacheEntry> entries;
+  entries.reserve(msgs.size());
+  int64_t mem_required = 0;
+  for (const auto& msg : msgs) {
+    CacheEntry e = { msg, msg->SpaceUsedLong() };
+    e.tracked = true;
+    mem_required += e.mem_usage;
+    entries.push_back(std::move(e));
+  }
+
+  std::lock_guard<simple_spinlock> lock(lock_);
+  read_ahead_running_ = false;
+  if (entries.empty()) {
+    return;
+  }
+  // Operations that were read could be replaced by a new leader in the meantime.
+  if (overwrite_epoch != overwrite_epoch_) {
+    VLOG_WITH_PREFIX_UNLOCKED(1) << "Drop read ahead ops, because log was overwritten";
+    return;
+  }
+  if (!tracker_->TryConsume(mem_required)) {
+    VLOG_WITH_PREFIX_UNLOCKED(1)
+        << "Drop read ahead ops, not enough memory for "
+        << HumanReadableNumBytes::ToString(mem_required);
+    return;
+  }
+
+  int64_t mem_used = 0;
+  size_t num_inserted = 0;
+  for (auto& e : entries) {
+    auto index = e.msg->id().index();
+    if (index >= min_pinned_op_index_) {
+      break;
+    }
+    auto mem_usage = e.mem_usage;
+    if (cache_.emplace(index, std::move(e)).second) {
+      mem_used += mem_usage;
+      ++num_inserted;
+    }
+  }
+  tracker_->Release(mem_required - mem_used);
+  metrics_.size->IncrementBy(mem_used);
+  metrics_.num_ops->IncrementBy(num_inserted);
+  metrics_.read_ahead_ops->IncrementBy(num_inserted);
+
+  auto last_index = msgs.back()->id().index();
+  read_ahead_next_index_ = last_index + 1;
+  read_ahead_trigger_index_ = from_index + (last_index - from_index) / 2;
+}
+
 size_t LogCache::EvictThroughOp(int64_t index, int64_t bytes_to_evict) {
   // Capture the evicted messages and release the memory outside of lock.
   ReplicateMsgVector evicted_messages;
@@ -662,7 +859,8 @@ void LogCache::TrackOperationsMemory(const OpIds& op_ids) {
     size_t mem_required = 0;
     for (const auto& op_id : op_ids) {
       auto it = cache_.find(op_id.index);
-      if (it != cache_.end() && it->second.msg->id().term() == op_id.term) {
+      if (it != cache_.end() && it->second.msg->id().term() == op_id.term &&
+          !it->second.tracked) {
         mem_required += it->second.mem_usage;
         it->second.tracked = true;
       }
@@ -701,7 +899,8 @@ int64_t LogCache::num_cached_ops() const {
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : INSTANTIATE_METRIC(num_ops, 0),
     INSTANTIATE_METRIC(size, 0),
-    INSTANTIATE_METRIC(disk_reads) {
+    INSTANTIATE_METRIC(disk_reads),
+    INSTANTIATE_METRIC(read_ahead_ops) {
 }
 #undef INSTANTIATE_METRIC
 
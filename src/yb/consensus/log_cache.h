@@ -60,6 +60,7 @@
 #include "yb/util/monotime.h"
 #include "yb/util/mutex.h"
 #include "yb/util/opid.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/restart_safe_clock.h"
 #include "yb/util/status_callback.h"
 
@@ -70,6 +71,7 @@ namespace yb {
 class MetricEntity;
 class MemTracker;
 class OpIdPB;
+class ThreadPoolToken;
 
 namespace consensus {
 
@@ -89,13 +91,18 @@ struct ReadOpsResult {
 // This stores a set of log messages by their index. New operations can be appended to the end as
 // they are written to the log. Readers fetch entries that were explicitly appended, or they can
 // fetch older entries which are asynchronously fetched from the disk.
+//
+// When 'read_ahead_token' is provided, reading operations from disk also starts an asynchronous
+// read of the following operations into the cache. So a lagging peer, and any other peer that
+// needs the same range, is served from memory by the next request instead of blocking on disk.
 class LogCache {
  public:
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
            const log::LogPtr& log,
            const std::shared_ptr<MemTracker>& server_tracker,
            const std::string& local_uuid,
-           const std::string& tablet_id);
+           const std::string& tablet_id,
+           std::unique_ptr<ThreadPoolToken> read_ahead_token = nullptr);
   ~LogCache();
 
   static std::shared_ptr<MemTracker> GetServerMemTracker(
@@ -134,6 +141,13 @@ class LogCache {
       CoarseTimePoint deadline = CoarseTimePoint::max(),
       bool fetch_single_entry = false);
 
+  // Returns the serialized form of the provided operations, in the same order.
+  //
+  // Operations that are present in the cache are serialized only once, their serialized form is
+  // kept together with the cached entry and is shared by requests to all peers. Operations that
+  // are not in the cache, i.e. were read from disk, are serialized on each call.
+  SerializedReplicateMsgs SerializeOps(const ReplicateMsgs& msgs);
+
   // Append the operations into the log and the cache.  When the messages have completed writing
   // into the on-disk log, fires 'callback'.
   //
@@ -189,7 +203,9 @@ class LogCache {
   FRIEND_TEST(LogCacheTest, TestAppendAndGetMessages);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimitMB);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimitPercentage);
+  FRIEND_TEST(LogCacheTest, TestReadAhead);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
+  FRIEND_TEST(LogCacheTest, TestSerializeOps);
   friend class LogCacheTest;
 
   // An entry in the cache.
@@ -201,6 +217,9 @@ class LogCache {
 
     // Did we start memory tracking for this entry.
     bool tracked = false;
+
+    // Serialized form of msg, filled on demand by SerializeOps. Its size is included in mem_usage.
+    RefCntBuffer serialized;
   };
 
   typedef boost::container::small_vector<ReplicateMsgPtr, 8> ReplicateMsgVector;
@@ -241,6 +260,16 @@ class LogCache {
 
   PrepareAppendResult PrepareAppendOperations(const ReplicateMsgs& msgs);
 
+  // Submits asynchronous read of operations starting from 'from_index' that are not present in
+  // the cache, unless another read ahead is already running.
+  void StartReadAhead(int64_t from_index);
+
+  // Reads operations in the specified range from disk and puts them to the cache.
+  // Nothing is added if some operations were overwritten since the read ahead was started,
+  // i.e. overwrite_epoch_ does not match 'overwrite_epoch'.
+  void ReadAhead(int64_t from_index, int64_t up_to_index, int64_t max_bytes,
+                 uint64_t overwrite_epoch);
+
   log::LogPtr const log_;
 
   // The UUID of the local peer.
@@ -272,6 +301,21 @@ class LogCache {
   // Number of batches in progress of preparing that have overwritten min_pinned_op_index_.
   int64_t num_batches_overwritten_cache_;
 
+  // Incremented each time appended operations overwrite previously appended ones.
+  uint64_t overwrite_epoch_ GUARDED_BY(lock_) = 0;
+
+  // Serial token used to read operations ahead, could be null.
+  std::unique_ptr<ThreadPoolToken> read_ahead_token_;
+
+  bool read_ahead_running_ GUARDED_BY(lock_) = false;
+
+  // Index following the last operation loaded by read ahead.
+  int64_t read_ahead_next_index_ GUARDED_BY(lock_) = 0;
+
+  // When a reader reaches this index, the next range is read ahead. 0 means that there is no
+  // pending range to read.
+  int64_t read_ahead_trigger_index_ GUARDED_BY(lock_) = 0;
+
   // Pointer to a parent memtracker for all log caches. This exists to compute server-wide cache
   // size and enforce a server-wide memory limit.  When the first instance of a log cache is
   // created, a new entry is added to MemTracker's static map; subsequent entries merely increment
@@ -292,6 +336,8 @@ class LogCache {
     scoped_refptr<AtomicGauge<int64_t>> size;
 
     scoped_refptr<Counter> disk_reads;
+
+    scoped_refptr<Counter> read_ahead_ops;
   };
   Metrics metrics_;
 
@@ -31,6 +31,7 @@ class LogIndex;
 class LogReader;
 class LogSegmentFooterPB;
 class LogSegmentHeaderPB;
+class LogSyncGroup;
 class ReadableLogSegment;
 class WritableLogSegment;
 
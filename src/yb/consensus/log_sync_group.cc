@@ -0,0 +1,158 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/log_sync_group.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/utsname.h>
+#endif
+
+#include <unordered_map>
+
+#include "yb/util/debug/trace_event.h"
+#include "yb/util/errno.h"
+#include "yb/util/flags.h"
+#include "yb/util/logging.h"
+#include "yb/util/monotime.h"
+#include "yb/util/result.h"
+#include "yb/util/status_format.h"
+#include "yb/util/thread_restrictions.h"
+
+DECLARE_bool(never_fsync);
+
+DEFINE_test_flag(int32, log_sync_group_delay_ms, 0,
+                 "Delay in milliseconds added to each file system wide sync of a log sync group.");
+
+namespace yb {
+namespace log {
+
+namespace {
+
+std::mutex groups_mutex;
+std::unordered_map<dev_t, std::weak_ptr<LogSyncGroup>> groups GUARDED_BY(groups_mutex);
+
+#if defined(__linux__)
+// Before Linux 5.8 syncfs returns success even when writeback of some file failed, so such errors
+// would be silently lost.
+Status CheckSyncfsReportsErrors() {
+  struct utsname uts_name;
+  if (uname(&uts_name) != 0) {
+    return STATUS_FROM_ERRNO("Failed to get kernel version", errno);
+  }
+  int major_version = 0;
+  int minor_version = 0;
+  if (sscanf(uts_name.release, "%d.%d", &major_version, &minor_version) != 2) {
+    return STATUS_FORMAT(NotSupported, "Unknown kernel version: $0", uts_name.release);
+  }
+  if (major_version * 1000 + minor_version < 5008) {
+    return STATUS_FORMAT(
+        NotSupported, "syncfs does not report writeback errors on kernel $0", uts_name.release);
+  }
+  return Status::OK();
+}
+#endif
+
+} // namespace
+
+Result<std::shared_ptr<LogSyncGroup>> LogSyncGroup::ForDirectory(const std::string& dir) {
+#if defined(__linux__)
+  static const Status syncfs_status = CheckSyncfsReportsErrors();
+  RETURN_NOT_OK(syncfs_status);
+
+  struct stat st;
+  if (stat(dir.c_str(), &st) != 0) {
+    return STATUS_FROM_ERRNO_SPECIAL_EIO_HANDLING(dir, errno);
+  }
+
+  std::lock_guard<std::mutex> lock(groups_mutex);
+  auto& weak_group = groups[st.st_dev];
+  auto group = weak_group.lock();
+  if (!group) {
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      return STATUS_FROM_ERRNO_SPECIAL_EIO_HANDLING(dir, errno);
+    }
+    group = std::make_shared<LogSyncGroup>(dir, fd);
+    weak_group = group;
+    LOG(INFO) << "Created log sync group for file system of " << dir;
+  }
+  return group;
+#else
+  return STATUS(NotSupported, "Log sync group is only supported on Linux");
+#endif
+}
+
+LogSyncGroup::LogSyncGroup(std::string path, int fd) : path_(std::move(path)), fd_(fd) {}
+
+LogSyncGroup::~LogSyncGroup() {
+  close(fd_);
+}
+
+Status LogSyncGroup::Sync() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++num_requests_;
+  // A round that is already in progress could have started before data of the caller was written,
+  // so the caller needs the next round.
+  const auto required_round = started_rounds_ + 1;
+  for (;;) {
+    if (finished_rounds_ >= required_round) {
+      return last_status_;
+    }
+    if (started_rounds_ == finished_rounds_) {
+      // There is no round in progress, so this caller leads the next round.
+      const auto round = ++started_rounds_;
+      lock.unlock();
+      auto status = DoSync();
+      lock.lock();
+      finished_rounds_ = round;
+      last_status_ = status;
+      cond_.notify_all();
+      return status;
+    }
+    cond_.wait(lock);
+  }
+}
+
+Status LogSyncGroup::DoSync() {
+  TRACE_EVENT1("log", "LogSyncGroup::DoSync", "path", path_);
+  ThreadRestrictions::AssertIOAllowed();
+  if (FLAGS_never_fsync) {
+    return Status::OK();
+  }
+  if (FLAGS_TEST_log_sync_group_delay_ms > 0) {
+    SleepFor(MonoDelta::FromMilliseconds(FLAGS_TEST_log_sync_group_delay_ms));
+  }
+#if defined(__linux__)
+  if (syncfs(fd_) < 0) {
+    return STATUS_FROM_ERRNO_SPECIAL_EIO_HANDLING(path_, errno);
+  }
+#endif
+  return Status::OK();
+}
+
+uint64_t LogSyncGroup::TEST_num_requests() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_requests_;
+}
+
+uint64_t LogSyncGroup::TEST_num_rounds() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return finished_rounds_;
+}
+
+} // namespace log
+} // namespace yb
@@ -0,0 +1,71 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "yb/gutil/thread_annotations.h"
+
+#include "yb/util/status.h"
+
+namespace yb {
+namespace log {
+
+// Coalesces WAL syncs of all tablets whose logs are stored on the same file system.
+//
+// With many tablets per server and durable_wal_write enabled, each log fsyncs its own small
+// segment file. Instead, a log could ask the group to make everything written so far durable.
+// The first caller becomes the leader of a sync round and issues a single syncfs(2) for the whole
+// file system, while other callers wait for the next round to complete. So concurrent syncs from
+// thousands of tablets are served by a few file system wide syncs.
+//
+// Since syncfs flushes all dirty data of the file system, this is only beneficial when WALs are
+// stored on file systems that are not shared with large data writes. Groups are only available on
+// Linux 5.8 and later, since earlier kernels do not report writeback errors from syncfs.
+class LogSyncGroup {
+ public:
+  // Returns the group for the file system containing the specified directory. Groups are shared
+  // between all logs of the process.
+  static Result<std::shared_ptr<LogSyncGroup>> ForDirectory(const std::string& dir);
+
+  LogSyncGroup(std::string path, int fd);
+  ~LogSyncGroup();
+
+  // Makes data written to any file of the file system before this call durable.
+  Status Sync();
+
+  uint64_t TEST_num_requests();
+  uint64_t TEST_num_rounds();
+
+ private:
+  Status DoSync();
+
+  const std::string path_;
+  const int fd_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Number of Sync calls.
+  uint64_t num_requests_ GUARDED_BY(mutex_) = 0;
+  // Number of started and finished sync rounds.
+  uint64_t started_rounds_ GUARDED_BY(mutex_) = 0;
+  uint64_t finished_rounds_ GUARDED_BY(mutex_) = 0;
+  Status last_status_ GUARDED_BY(mutex_);
+};
+
+} // namespace log
+} // namespace yb
@@ -38,6 +38,7 @@
 #include <utility>
 
 #include <glog/logging.h>
+#include <lz4.h>
 
 #include "yb/common/hybrid_time.h"
 
@@ -45,6 +46,7 @@
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/log.messages.h"
 #include "yb/consensus/log_index.h"
+#include "yb/consensus/log_sync_group.h"
 
 #include "yb/fs/fs_manager.h"
 
@@ -155,6 +157,68 @@ const int kLogMinorVersion = 0;
 // Maximum log segment header/footer size, in bytes (8 MB).
 const uint32_t kLogSegmentMaxHeaderOrFooterSize = 8 * 1024 * 1024;
 
+namespace {
+
+// Entry batch of a compressed segment is prefixed with the size of the uncompressed batch.
+const size_t kCompressedEntryBatchPrefixSize = 4;
+
+// Compresses entry batch into buffer, returns the data that should be stored in the segment.
+Result<Slice> CompressEntryBatch(
+    LogCompressionTypePB compression_type, const Slice& data, faststring* buffer) {
+  if (compression_type != LogCompressionTypePB::LOG_COMPRESSION_LZ4) {
+    return STATUS_FORMAT(
+        NotSupported, "Unsupported log compression type: $0",
+        LogCompressionTypePB_Name(compression_type));
+  }
+  const auto input_size = narrow_cast<int>(data.size());
+  const auto bound = LZ4_compressBound(input_size);
+  buffer->resize(kCompressedEntryBatchPrefixSize + bound);
+  const auto compressed_size = LZ4_compress_default(
+      data.cdata(), pointer_cast<char*>(buffer->data() + kCompressedEntryBatchPrefixSize),
+      input_size, bound);
+  if (compressed_size <= 0 || compressed_size >= input_size) {
+    // Batch does not compress, so it is stored as is.
+    buffer->resize(kCompressedEntryBatchPrefixSize);
+    InlineEncodeFixed32(buffer->data(), 0);
+    buffer->append(data.data(), data.size());
+  } else {
+    buffer->resize(kCompressedEntryBatchPrefixSize + compressed_size);
+    InlineEncodeFixed32(buffer->data(), narrow_cast<uint32_t>(data.size()));
+  }
+  return Slice(*buffer);
+}
+
+// Decompresses entry batch stored in the segment. When decompression is required, buffer is
+// replaced with the buffer holding decompressed data.
+Result<Slice> DecompressEntryBatch(
+    LogCompressionTypePB compression_type, const Slice& data, RefCntBuffer* buffer) {
+  if (compression_type != LogCompressionTypePB::LOG_COMPRESSION_LZ4) {
+    return STATUS_FORMAT(
+        NotSupported, "Unsupported log compression type: $0",
+        LogCompressionTypePB_Name(compression_type));
+  }
+  SCHECK_GE(data.size(), kCompressedEntryBatchPrefixSize, Corruption,
+            "Compressed entry batch is too short");
+  const auto uncompressed_size = DecodeFixed32(data.data());
+  const auto payload = data.WithoutPrefix(kCompressedEntryBatchPrefixSize);
+  if (uncompressed_size == 0) {
+    return payload;
+  }
+  RefCntBuffer result(uncompressed_size);
+  const auto decompressed_size = LZ4_decompress_safe(
+      payload.cdata(), result.data(), narrow_cast<int>(payload.size()),
+      narrow_cast<int>(uncompressed_size));
+  if (decompressed_size != implicit_cast<int64_t>(uncompressed_size)) {
+    return STATUS_FORMAT(
+        Corruption, "Decompressed $0 bytes, while $1 expected", decompressed_size,
+        uncompressed_size);
+  }
+  *buffer = std::move(result);
+  return Slice(buffer->data(), uncompressed_size);
+}
+
+} // namespace
+
 LogOptions::LogOptions()
     : segment_size_bytes(FLAGS_log_segment_size_bytes == 0 ? FLAGS_log_segment_size_mb * 1_MB
                                                            : FLAGS_log_segment_size_bytes),
@@ -920,6 +984,18 @@ Result<std::shared_ptr<LWLogEntryBatchPB>> ReadableLogSegment::ReadEntryBatch(
                                          *offset, *offset + header.msg_length,
                                          header.msg_crc, read_crc));
   }
+  const auto stored_size = entry_batch_slice.size();
+
+  if (header_.compression_type() != LogCompressionTypePB::LOG_COMPRESSION_NONE) {
+    auto decompressed = DecompressEntryBatch(
+        header_.compression_type(), entry_batch_slice.Prefix(header.msg_length), &buffer);
+    if (!decompressed.ok()) {
+      return STATUS_FORMAT(
+          Corruption, "Failed to decompress entry at offset: $0, length: $1. Cause: $2", *offset,
+          header.msg_length, decompressed.status());
+    }
+    entry_batch_slice = *decompressed;
+  }
 
   // TODO(lw_uc) embed buffer and first arena block into holder itself.
   struct DataHolder {
@@ -931,7 +1007,7 @@ Result<std::shared_ptr<LWLogEntryBatchPB>> ReadableLogSegment::ReadEntryBatch(
 
   auto holder = std::make_shared<DataHolder>(buffer);
   auto batch = holder->arena.NewArenaObject<LWLogEntryBatchPB>();
-  s = batch->ParseFromSlice(entry_batch_slice.Prefix(header.msg_length));
+  s = batch->ParseFromSlice(entry_batch_slice);
 
   if (!s.ok()) {
     return STATUS_FORMAT(
@@ -939,7 +1015,7 @@ Result<std::shared_ptr<LWLogEntryBatchPB>> ReadableLogSegment::ReadEntryBatch(
         header.msg_length, s);
   }
 
-  *offset += entry_batch_slice.size();
+  *offset += stored_size;
   return rpc::SharedField(holder, batch);
 }
 
@@ -1070,9 +1146,15 @@ Status WritableLogSegment::WriteIndexWithFooterAndClose(
   return Status::OK();
 }
 
-Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
+Status WritableLogSegment::WriteEntryBatch(const Slice& entry_batch_data) {
   DCHECK(is_header_written_);
   DCHECK(!is_footer_written_);
+  Slice data = entry_batch_data;
+  if (header_.compression_type() != LogCompressionTypePB::LOG_COMPRESSION_NONE) {
+    data = VERIFY_RESULT(CompressEntryBatch(
+        header_.compression_type(), entry_batch_data, &compression_buffer_));
+  }
+
   uint8_t header_buf[kEntryHeaderSize];
 
   // First encode the length of the message.
@@ -1136,8 +1218,13 @@ Status WritableLogSegment::WriteIndexBlock(const LogIndexBlock& index_block) {
   return writable_file_->Append(index_block.data);
 }
 
-Status WritableLogSegment::Sync() {
-  return writable_file_->Sync();
+Status WritableLogSegment::Sync(LogSyncGroup* sync_group) {
+  if (!sync_group) {
+    return writable_file_->Sync();
+  }
+  // Make sure that all written data is passed to the file system and start its writeback.
+  RETURN_NOT_OK(writable_file_->Flush(WritableFile::FLUSH_ASYNC));
+  return sync_group->Sync();
 }
 
 // Creates a LogEntryBatchPB from pre-allocated ReplicateMsgs managed using shared pointers. The
@@ -411,12 +411,14 @@ class WritableLogSegment {
   }
 
   // Appends the provided batch of data, including a header
-  // and checksum.
+  // and checksum. The data is compressed if it is requested by the segment header.
   // Makes sure that the log segment has not been closed.
   Status WriteEntryBatch(const Slice& entry_batch_data);
 
   // Makes sure the I/O buffers in the underlying writable file are flushed.
-  Status Sync();
+  // When sync_group is specified, written data is made durable by a file system wide sync of this
+  // group instead of syncing the file itself.
+  Status Sync(LogSyncGroup* sync_group = nullptr);
 
   // Returns true if the segment header has already been written to disk.
   bool IsHeaderWritten() const {
@@ -483,6 +485,9 @@ class WritableLogSegment {
 
   faststring index_block_header_buffer_;
 
+  // Buffer used to compress entry batches, reused between batches.
+  faststring compression_buffer_;
+
   DISALLOW_COPY_AND_ASSIGN(WritableLogSegment);
 };
 
@@ -19,9 +19,12 @@
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/consensus.proxy.h"
 
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/periodic.h"
 
 #include "yb/util/flags.h"
+#include "yb/util/source_location.h"
+#include "yb/util/tostring.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
@@ -37,6 +40,22 @@ DEFINE_UNKNOWN_uint64(multi_raft_batch_size, 0,
               "Maximum batch size for a multi-Raft consensus payload. Ignored if set to zero.");
 TAG_FLAG(multi_raft_batch_size, advanced);
 
+DEFINE_RUNTIME_bool(multi_raft_batch_commit_updates, false,
+    "If true, UpdateConsensus requests without operations, that only advance the committed op "
+    "id, are also sent through the multi-Raft batcher. Such batches are not delayed until the next "
+    "heartbeat interval, but sized according to the observed round trip time.");
+TAG_FLAG(multi_raft_batch_commit_updates, advanced);
+
+DEFINE_RUNTIME_int32(multi_raft_urgent_batch_delay_rtt_percent, 50,
+    "Delay before sending a multi-Raft batch containing committed op id updates, as a percentage "
+    "of the observed round trip time of batches to the same server.");
+TAG_FLAG(multi_raft_urgent_batch_delay_rtt_percent, advanced);
+
+DEFINE_RUNTIME_uint64(multi_raft_max_in_flight_batches, 2,
+    "Max number of in flight multi-Raft batches containing committed op id updates per remote "
+    "server. Further updates are accumulated into the next batch until one of them completes.");
+TAG_FLAG(multi_raft_max_in_flight_batches, advanced);
+
 DECLARE_int32(consensus_rpc_timeout_ms);
 
 namespace yb {
@@ -44,6 +63,19 @@ namespace consensus {
 
 using rpc::PeriodicTimer;
 
+MultiRaftBatcherStats& MultiRaftBatcherStats::operator+=(const MultiRaftBatcherStats& rhs) {
+  urgent_requests += rhs.urgent_requests;
+  urgent_batches += rhs.urgent_batches;
+  in_flight_batches += rhs.in_flight_batches;
+  scheduled_urgent_batches += rhs.scheduled_urgent_batches;
+  return *this;
+}
+
+std::string MultiRaftBatcherStats::ToString() const {
+  return YB_STRUCT_TO_STRING(
+      urgent_requests, urgent_batches, in_flight_batches, scheduled_urgent_batches);
+}
+
 namespace {
 
 // Tracks a single peers ConsensusResponsePB as well as its ProcessResponse callback.
@@ -59,6 +91,7 @@ struct MultiRaftHeartbeatBatcher::MultiRaftConsensusData {
   MultiRaftConsensusResponsePB batch_res;
   rpc::RpcController controller;
   std::vector<ResponseCallbackData> response_callback_data;
+  bool has_urgent_requests = false;
 };
 
 MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
@@ -92,19 +125,31 @@ MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
 
 void MultiRaftHeartbeatBatcher::AddRequestToBatch(ConsensusRequestPB* request,
                                                   ConsensusResponsePB* response,
-                                                  HeartbeatResponseCallback callback) {
+                                                  HeartbeatResponseCallback callback,
+                                                  UrgentRequest urgent) {
   std::shared_ptr<MultiRaftConsensusData> data = nullptr;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (shutdown_) {
+      lock.unlock();
+      callback(STATUS(Aborted, "MultiRaft shutdown"));
+      return;
+    }
     current_batch_->response_callback_data.push_back({
       .resp = response,
       .callback = std::move(callback)
     });
     // Add a ConsensusRequestPB to the batch
     current_batch_->batch_req.add_consensus_request()->Swap(request);
+    if (urgent) {
+      current_batch_->has_urgent_requests = true;
+      ++urgent_requests_;
+    }
     if (FLAGS_multi_raft_batch_size > 0
         && current_batch_->response_callback_data.size() >= FLAGS_multi_raft_batch_size) {
       data = PrepareNextBatchRequest();
+    } else if (urgent) {
+      data = ScheduleUrgentBatchUnlocked();
     }
   }
   SendBatchRequest(data);
@@ -127,11 +172,70 @@ std::shared_ptr<MultiRaftHeartbeatBatcher::MultiRaftConsensusData>
   batch_sender_->Snooze();
   auto data = std::make_shared<MultiRaftConsensusData>();
   current_batch_.swap(data);
+  ++in_flight_batches_;
+  if (data->has_urgent_requests) {
+    ++urgent_batches_;
+  }
   auto running_calls = ++*running_calls_;
   LOG_IF(DFATAL, running_calls <= 0) << "Wrong number or running calls: " << running_calls;
   return data;
 }
 
+std::shared_ptr<MultiRaftHeartbeatBatcher::MultiRaftConsensusData>
+    MultiRaftHeartbeatBatcher::ScheduleUrgentBatchUnlocked() {
+  if (shutdown_ || !current_batch_ || !current_batch_->has_urgent_requests ||
+      urgent_batch_task_id_ != rpc::kInvalidTaskId ||
+      in_flight_batches_ >= FLAGS_multi_raft_max_in_flight_batches) {
+    return nullptr;
+  }
+
+  // Give other tablets a fraction of the round trip time to join the batch, so the added latency
+  // stays proportional to the latency of the batch itself.
+  auto delay = std::min(
+      rtt_ewma_ * FLAGS_multi_raft_urgent_batch_delay_rtt_percent / 100,
+      MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_interval_ms));
+  if (delay <= MonoDelta::kZero) {
+    return PrepareNextBatchRequest();
+  }
+
+  std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self = shared_from_this();
+  urgent_batch_task_id_ = messenger_->ScheduleOnReactor(
+      [weak_self](const Status& status) {
+        if (auto self = weak_self.lock()) {
+          self->UrgentBatchTimeout(status);
+        }
+      },
+      delay, SOURCE_LOCATION(), messenger_);
+  return nullptr;
+}
+
+void MultiRaftHeartbeatBatcher::UrgentBatchTimeout(const Status& status) {
+  std::shared_ptr<MultiRaftConsensusData> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    urgent_batch_task_id_ = rpc::kInvalidTaskId;
+    if (!status.ok() || shutdown_) {
+      return;
+    }
+    // Otherwise the batch is sent when one of the in flight batches completes.
+    if (in_flight_batches_ < FLAGS_multi_raft_max_in_flight_batches) {
+      data = PrepareNextBatchRequest();
+    }
+  }
+  SendBatchRequest(data);
+}
+
+void MultiRaftHeartbeatBatcher::BatchCompleted(MonoDelta rtt) {
+  std::shared_ptr<MultiRaftConsensusData> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_batches_;
+    rtt_ewma_ = rtt_ewma_ == MonoDelta::kZero ? rtt : (rtt_ewma_ * 7 + rtt) / 8;
+    data = ScheduleUrgentBatchUnlocked();
+  }
+  SendBatchRequest(data);
+}
+
 void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsensusData> data) {
   if (!data) {
     return;
@@ -140,8 +244,11 @@ void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsen
   data->controller.Reset();
   data->controller.set_timeout(MonoDelta::FromMilliseconds(
       FLAGS_consensus_rpc_timeout_ms * data->batch_req.consensus_request_size()));
-  auto callback = [data, running_calls = running_calls_]() {
+  std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self = shared_from_this();
+  auto callback = [data, running_calls = running_calls_, weak_self,
+                   start = CoarseMonoClock::Now()]() {
     --*running_calls;
+    auto rtt = MonoDelta(CoarseMonoClock::Now() - start);
     auto status = data->controller.status();
     for (int i = 0; i < data->batch_req.consensus_request_size(); i++) {
       auto callback_data = data->response_callback_data[i];
@@ -150,6 +257,9 @@ void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsen
       }
       callback_data.callback(status);
     }
+    if (auto self = weak_self.lock()) {
+      self->BatchCompleted(rtt);
+    }
   };
   consensus_proxy_->MultiRaftUpdateConsensusAsync(
       data->batch_req, &data->batch_res, &data->controller, callback);
@@ -158,9 +268,15 @@ void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsen
 void MultiRaftHeartbeatBatcher::Shutdown() {
   decltype(current_batch_) batch;
   batch_sender_->Stop();
+  auto urgent_batch_task_id = rpc::kInvalidTaskId;
   {
     std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
     batch.swap(current_batch_);
+    std::swap(urgent_batch_task_id, urgent_batch_task_id_);
+  }
+  if (urgent_batch_task_id != rpc::kInvalidTaskId) {
+    messenger_->AbortOnReactor(urgent_batch_task_id);
   }
   static const Status status = STATUS(Aborted, "MultiRaft shutdown");
   for (const auto& callback : batch->response_callback_data) {
@@ -168,6 +284,16 @@ void MultiRaftHeartbeatBatcher::Shutdown() {
   }
 }
 
+MultiRaftBatcherStats MultiRaftHeartbeatBatcher::TEST_GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return MultiRaftBatcherStats {
+    .urgent_requests = urgent_requests_,
+    .urgent_batches = urgent_batches_,
+    .in_flight_batches = in_flight_batches_,
+    .scheduled_urgent_batches = urgent_batch_task_id_ != rpc::kInvalidTaskId ? 1U : 0U,
+  };
+}
+
 MultiRaftManager::MultiRaftManager(rpc::Messenger* messenger,
                                    rpc::ProxyCache* proxy_cache,
                                    CloudInfoPB local_peer_cloud_info_pb)
@@ -223,6 +349,24 @@ void MultiRaftManager::StartShutdown() {
   }
 }
 
+MultiRaftBatcherStats MultiRaftManager::TEST_GetStats() {
+  std::vector<MultiRaftHeartbeatBatcherPtr> batchers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [hostport, weak_batcher] : batchers_) {
+      auto batcher = weak_batcher.lock();
+      if (batcher) {
+        batchers.push_back(batcher);
+      }
+    }
+  }
+  MultiRaftBatcherStats result;
+  for (const auto& batcher : batchers) {
+    result += batcher->TEST_GetStats();
+  }
+  return result;
+}
+
 void MultiRaftManager::CompleteShutdown() {
   int expected = 0;
   while (!running_calls_.compare_exchange_weak(expected, std::numeric_limits<int>::min() / 2)) {
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "yb/common/common_net.pb.h"
 
@@ -20,7 +21,9 @@
 
 #include "yb/rpc/rpc_controller.h"
 
+#include "yb/util/monotime.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/strongly_typed_bool.h"
 
 namespace yb {
 
@@ -33,6 +36,23 @@ namespace consensus {
 
 using HeartbeatResponseCallback = std::function<void(const Status&)>;
 
+// Urgent requests, i.e. ones that advance the committed op id, are not delayed until the next
+// heartbeat interval.
+YB_STRONGLY_TYPED_BOOL(UrgentRequest);
+
+struct MultiRaftBatcherStats {
+  // Number of urgent requests added to batches, and number of batches they were sent in.
+  size_t urgent_requests = 0;
+  size_t urgent_batches = 0;
+  size_t in_flight_batches = 0;
+  // Number of batchers that scheduled sending of an urgent batch.
+  size_t scheduled_urgent_batches = 0;
+
+  MultiRaftBatcherStats& operator+=(const MultiRaftBatcherStats& rhs);
+
+  std::string ToString() const;
+};
+
 // - MultiRaftHeartbeatBatcher is responsible for the batching of heartbeats
 //   among peers that are communicating with remote peers at the same tserver
 // - It is also responsible for periodically sending out these batched requests
@@ -42,6 +62,10 @@ using HeartbeatResponseCallback = std::function<void(const Status&)>;
 //   FLAGS_multi_raft_batch_size
 // - To improve efficency multiple batches may be processed concurrently
 //   but only a single batch is being built at any given time
+// - When a batch contains an urgent request, it is sent after a delay derived from the observed
+//   round trip time of previous batches, instead of waiting for the heartbeat interval. While
+//   FLAGS_multi_raft_max_in_flight_batches batches are in flight, the batch keeps growing and is
+//   sent as soon as one of them completes.
 class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
  public:
   MultiRaftHeartbeatBatcher(const HostPort& hostport,
@@ -60,10 +84,13 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
   // executed with an error status.
   void AddRequestToBatch(ConsensusRequestPB* request,
                          ConsensusResponsePB* response,
-                         HeartbeatResponseCallback callback);
+                         HeartbeatResponseCallback callback,
+                         UrgentRequest urgent = UrgentRequest::kFalse);
 
   void Shutdown();
 
+  MultiRaftBatcherStats TEST_GetStats();
+
  private:
   // Tracks all the metadata for a single batch request, including a list of all
   // ResponseCallbackData registered by each local peer with this batch in AddRequestToBatch().
@@ -79,6 +106,15 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
 
   void MultiRaftUpdateHeartbeatResponseCallback(std::shared_ptr<MultiRaftConsensusData> data);
 
+  // Invoked when a batch RPC completes, after 'rtt' since it was sent.
+  void BatchCompleted(MonoDelta rtt);
+
+  // Returns batch that should be sent immediately, if any. Otherwise schedules sending of the
+  // current batch, if it contains an urgent request.
+  std::shared_ptr<MultiRaftConsensusData> ScheduleUrgentBatchUnlocked() REQUIRES(mutex_);
+
+  void UrgentBatchTimeout(const Status& status);
+
   rpc::Messenger* messenger_;
 
   ConsensusServiceProxyPtr consensus_proxy_;
@@ -89,6 +125,19 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
 
   std::shared_ptr<MultiRaftConsensusData> current_batch_ GUARDED_BY(mutex_);
 
+  // Number of batches sent by this batcher, that did not complete yet.
+  size_t in_flight_batches_ GUARDED_BY(mutex_) = 0;
+
+  // Exponentially weighted moving average of batch round trip time.
+  MonoDelta rtt_ewma_ GUARDED_BY(mutex_) = MonoDelta::kZero;
+
+  rpc::ScheduledTaskId urgent_batch_task_id_ GUARDED_BY(mutex_) = rpc::kInvalidTaskId;
+
+  bool shutdown_ GUARDED_BY(mutex_) = false;
+
+  size_t urgent_requests_ GUARDED_BY(mutex_) = 0;
+  size_t urgent_batches_ GUARDED_BY(mutex_) = 0;
+
   std::atomic<int>* running_calls_;
 };
 
@@ -111,6 +160,9 @@ class MultiRaftManager: public std::enable_shared_from_this<MultiRaftManager> {
   void StartShutdown();
   void CompleteShutdown();
 
+  // Returns sum of stats of all batchers.
+  MultiRaftBatcherStats TEST_GetStats();
+
  private:
   rpc::Messenger* messenger_;
 
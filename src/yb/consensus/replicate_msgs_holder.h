@@ -19,6 +19,7 @@
 
 #include "yb/util/mem_tracker.h"
 #include "yb/util/memory/arena.h"
+#include "yb/util/ref_cnt_buffer.h"
 
 namespace yb {
 namespace consensus {
@@ -62,14 +63,24 @@ class LWReplicateMsgsHolder {
  public:
   LWReplicateMsgsHolder() = default;
 
-  explicit LWReplicateMsgsHolder(ReplicateMsgs messages, ScopedTrackedConsumption consumption);
+  explicit LWReplicateMsgsHolder(
+      ReplicateMsgs messages, ScopedTrackedConsumption consumption,
+      SerializedReplicateMsgs serialized_messages = SerializedReplicateMsgs());
   LWReplicateMsgsHolder(LWReplicateMsgsHolder&& rhs);
   void operator=(LWReplicateMsgsHolder&& rhs);
 
   void Reset();
+
+  // Serialized form of the held messages, when requested. Empty otherwise.
+  const SerializedReplicateMsgs& serialized_messages() const {
+    return serialized_messages_;
+  }
+
  private:
   ReplicateMsgs messages_;
 
+  SerializedReplicateMsgs serialized_messages_;
+
   ScopedTrackedConsumption consumption_;
 };
 
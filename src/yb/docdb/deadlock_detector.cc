@@ -51,6 +51,27 @@ DEFINE_UNKNOWN_int32(
 TAG_FLAG(clear_active_probes_older_than_seconds, hidden);
 TAG_FLAG(clear_active_probes_older_than_seconds, advanced);
 
+DEFINE_RUNTIME_bool(enable_deadlock_detection_incremental_probes, false,
+    "If true, periodic deadlock detection rounds only re-send probes for waiters whose previous "
+    "probe did not complete successfully. Probes for new or changed wait-for edges are always sent "
+    "as soon as they are reported. A full scan of all waiters is still done every "
+    "deadlock_detection_full_scan_interval_rounds rounds, so a deadlock missed by a failed probe "
+    "could be detected only after that many rounds.");
+TAG_FLAG(enable_deadlock_detection_incremental_probes, advanced);
+
+DEFINE_RUNTIME_uint32(deadlock_detection_full_scan_interval_rounds, 10,
+    "When incremental deadlock detection probes are enabled, send probes for all waiters once "
+    "every this many detection rounds. A value of 0 or 1 results in a full scan on every round.");
+TAG_FLAG(deadlock_detection_full_scan_interval_rounds, advanced);
+
+DEFINE_test_flag(bool, skip_deadlock_probes_on_wait_for, false,
+                 "Don't send probes for wait-for edges as they are reported, so that they are sent "
+                 "only by periodic deadlock detection rounds.");
+
+DEFINE_test_flag(bool, fail_deadlock_probes_on_wait_for, false,
+                 "Fail probes for wait-for edges, which are sent as they are reported, without "
+                 "sending them to the blockers.");
+
 METRIC_DEFINE_coarse_histogram(
     tablet, deadlock_size, "Deadlock size", yb::MetricUnit::kTransactions,
     "The number of transactions involved in detected deadlocks");
@@ -60,6 +81,9 @@ METRIC_DEFINE_coarse_histogram(
 METRIC_DEFINE_gauge_uint64(
     tablet, deadlock_detector_waiters, "Num Waiting Txns", yb::MetricUnit::kTransactions,
     "The total number of waiting transactions tracked by one deadlock detector.");
+METRIC_DEFINE_counter(
+    tablet, deadlock_probes_sent, "Deadlock probes sent", yb::MetricUnit::kRequests,
+    "The number of probe RPCs originated or forwarded by one deadlock detector.");
 
 namespace yb {
 namespace tablet {
@@ -193,10 +217,12 @@ class LocalProbeProcessor : public std::enable_shared_from_this<LocalProbeProces
   LocalProbeProcessor(
       const std::string& detector_log_prefix, const DetectorId& origin_detector_id,
       uint32_t probe_num, uint32_t min_probe_num, const TransactionId& waiter_id, rpc::Rpcs* rpcs,
-      client::YBClient* client, scoped_refptr<Histogram> probe_latency)
+      client::YBClient* client, scoped_refptr<Histogram> probe_latency,
+      scoped_refptr<Counter> probes_sent)
       : detector_log_prefix_(detector_log_prefix), origin_detector_id_(origin_detector_id),
         waiter_(waiter_id), probe_num_(probe_num), min_probe_num_(min_probe_num), rpcs_(rpcs),
-        client_(client), probe_latency_(std::move(probe_latency)) {}
+        client_(client), probe_latency_(std::move(probe_latency)),
+        probes_sent_(std::move(probes_sent)) {}
 
   const std::string LogPrefix() const {
     return Format("$0- probe($1, $2) ", detector_log_prefix_, origin_detector_id_, probe_num_);
@@ -252,11 +278,26 @@ class LocalProbeProcessor : public std::enable_shared_from_this<LocalProbeProces
     if (probe_latency_) {
       sent_at_ = CoarseMonoClock::Now();
     }
+    if (probes_sent_) {
+      probes_sent_->IncrementBy(handles_.size());
+    }
     for (auto& handle : handles_) {
       (**handle).SendRpc();
     }
   }
 
+  // Completes the probe with the specified status, without sending it to the blockers.
+  void Fail(const Status& status) {
+    for (auto& handle : handles_) {
+      if (handle != rpcs_->InvalidHandle()) {
+        rpcs_->Unregister(&handle);
+      }
+    }
+    if (CanTrySendResponse()) {
+      callback_(status, tserver::ProbeTransactionDeadlockResponsePB());
+    }
+  }
+
   void SetCallback(LocalProbeProcessorCallback&& callback) {
     callback_ = std::move(callback);
   }
@@ -322,6 +363,7 @@ class LocalProbeProcessor : public std::enable_shared_from_this<LocalProbeProces
   rpc::Rpcs* rpcs_;
   client::YBClient* client_;
   scoped_refptr<Histogram> probe_latency_;
+  scoped_refptr<Counter> probes_sent_;
 
   CoarseTimePoint sent_at_;
 
@@ -354,7 +396,8 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
         log_prefix_(Format("T $0 D $1 ", status_tablet_id, detector_id_)),
         deadlock_size_(METRIC_deadlock_size.Instantiate(metrics)),
         probe_latency_(METRIC_deadlock_probe_latency.Instantiate(metrics)),
-        deadlock_detector_waiters_(METRIC_deadlock_detector_waiters.Instantiate(metrics, 0)) {
+        deadlock_detector_waiters_(METRIC_deadlock_detector_waiters.Instantiate(metrics, 0)),
+        probes_sent_(METRIC_deadlock_probes_sent.Instantiate(metrics)) {
     VLOG_WITH_PREFIX(4) << "Deadlock detector started with instance id: " << detector_id_;
   }
 
@@ -497,14 +540,23 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
     }
 
     callback(Status::OK());
+    if (FLAGS_TEST_skip_deadlock_probes_on_wait_for) {
+      return;
+    }
     for (const auto& probe : GetProbesToSend(waiters_to_probe)) {
+      if (FLAGS_TEST_fail_deadlock_probes_on_wait_for) {
+        probe->Fail(STATUS(NetworkError, "TEST: Injected deadlock probe failure"));
+        continue;
+      }
       probe->Send();
     }
   }
 
   void TriggerProbes() EXCLUDES(mutex_) {
-    // We should be able to trigger probes only once per unique waiting transaction, but we still
-    // trigger all active probes on a fixed interval for safetey/simplicity.
+    // Probes for new or changed wait-for edges are sent as soon as they are reported in
+    // ProcessWaitFor, which is sufficient to detect any cycle closed by that edge. Periodic rounds
+    // therefore only need to re-send probes which did not complete successfully, e.g. due to RPC
+    // failures. We still trigger probes for all waiters every few rounds for safety.
     std::vector<LocalProbeProcessorPtr> probes_to_send;
     {
       UniqueLock<decltype(mutex_)> l(mutex_);
@@ -513,10 +565,31 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
       if (is_probe_scan_active_) {
         return;
       }
-      is_probe_scan_active_ = true;
-      // TODO(wait-queues): Trigger probes only for waiters which which have
-      // wait_start_time > Now() - N seconds
-      probes_to_send = GetProbesToSend(waiters_);
+      auto full_scan_interval = FLAGS_deadlock_detection_full_scan_interval_rounds;
+      auto full_scan = !FLAGS_enable_deadlock_detection_incremental_probes ||
+                       full_scan_interval <= 1 || probe_round_++ % full_scan_interval == 0;
+      if (full_scan) {
+        reprobe_waiters_.clear();
+        if (!waiters_.empty()) {
+          is_probe_scan_active_ = true;
+          probes_to_send = GetProbesToSend(waiters_);
+        }
+      } else {
+        Waiters waiters_to_probe;
+        for (const auto& waiter_txn_id : reprobe_waiters_) {
+          auto it = waiters_.find(waiter_txn_id);
+          if (it != waiters_.end()) {
+            waiters_to_probe.insert(*it);
+          }
+        }
+        reprobe_waiters_.clear();
+        VLOG_WITH_PREFIX(4) << "Re-probing " << waiters_to_probe.size() << " of "
+                            << waiters_.size() << " waiters";
+        if (!waiters_to_probe.empty()) {
+          is_probe_scan_active_ = true;
+          probes_to_send = GetProbesToSend(waiters_to_probe);
+        }
+      }
     }
 
     for (auto& processor : probes_to_send) {
@@ -551,19 +624,27 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
       auto probe_num = seq_no_.fetch_add(1);
       auto processor = std::make_shared<LocalProbeProcessor>(
           log_prefix_, detector_id_, probe_num, created_probes_.GetSmallestProbeNo(),
-          waiter_txn_id, &rpcs_, &client(), probe_latency_);
+          waiter_txn_id, &rpcs_, &client(), probe_latency_, probes_sent_);
       for (const auto& blocker : waiter_data->blockers) {
         DCHECK(!blocker.status_tablet.empty());
         processor->AddBlocker(blocker.id, blocker.status_tablet);
       }
-      processor->SetCallback([detector = shared_from_this(), outstanding_probes, probe_num]
-          (const auto& status, const auto& resp) {
+      processor->SetCallback(
+          [detector = shared_from_this(), outstanding_probes, probe_num,
+           waiter_txn_id = waiter_txn_id](const auto& status, const auto& resp) {
         VLOG(4) << "Got callback for probe "
                 << Format("($0, $1)", probe_num, detector->detector_id_);
         detector->created_probes_.Remove(probe_num);
-        if (outstanding_probes->fetch_sub(1) == 1) {
+        {
           UniqueLock<decltype(mutex_)> l(detector->mutex_);
-          detector->is_probe_scan_active_ = false;
+          if (!status.ok() && resp.deadlocked_txn_ids_size() == 0) {
+            // The probe may not have reached all blockers, so it must be re-sent on the next
+            // detection round even if the wait-for edges of this waiter did not change.
+            detector->reprobe_waiters_.insert(waiter_txn_id);
+          }
+          if (outstanding_probes->fetch_sub(1) == 1) {
+            detector->is_probe_scan_active_ = false;
+          }
         }
         if (resp.deadlocked_txn_ids_size() > 0) {
           detector->deadlock_size_->Increment(resp.deadlocked_txn_ids_size());
@@ -677,7 +758,7 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
 
     auto local_processor = std::make_shared<LocalProbeProcessor>(
         log_prefix_, detector_id, probe_num, req.min_probe_num(), waiting_txn_id, &rpcs_,
-        &client(), nullptr /* probe_latency */);
+        &client(), nullptr /* probe_latency */, probes_sent_);
 
     for (const auto& blocker : *blockers) {
       local_processor->AddBlocker(blocker.id, blocker.status_tablet);
@@ -714,6 +795,7 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
   scoped_refptr<Histogram> deadlock_size_;
   scoped_refptr<Histogram> probe_latency_;
   scoped_refptr<AtomicGauge<uint64_t>> deadlock_detector_waiters_;
+  scoped_refptr<Counter> probes_sent_;
 
   mutable rw_spinlock mutex_;
 
@@ -729,6 +811,11 @@ class DeadlockDetector::Impl : public std::enable_shared_from_this<DeadlockDetec
 
   Waiters waiters_ GUARDED_BY(mutex_);
 
+  // Waiters whose last probe failed and should be re-probed on the next incremental round.
+  TransactionIdSet reprobe_waiters_ GUARDED_BY(mutex_);
+
+  uint64_t probe_round_ GUARDED_BY(mutex_) = 0;
+
   std::atomic<uint32_t> seq_no_ = 0;
 };
 
@@ -54,8 +54,12 @@ using DeadlockDetectorRpcCallback = std::function<void(const Status&)>;
 // from a tserver, it forwards this directly to the deadlock detector. The deadlock detector then
 // adds or overwrites information for each waiting transaction_id found in that request.
 //
-// On a regular interval (controlled by FLAGS_transaction_deadlock_detection_interval_usec), the
-// deadlock detector will scan all waiting transactions and, for each, do the following:
+// Probes are sent for a waiting transaction as soon as its wait-for edges are added or changed.
+// In addition, on a regular interval (controlled by
+// FLAGS_transaction_deadlock_detection_interval_usec), the deadlock detector re-sends probes for
+// waiting transactions whose previous probe failed, and every
+// FLAGS_deadlock_detection_full_scan_interval_rounds intervals it scans all waiting transactions.
+// For each waiting transaction being probed, it does the following:
 // 1. for each blocker:
 // 2.    probe_id = (probe_no++,detector_id)
 // 3.    send probe{probe_id, waiter_id, blocker_id} to blocker's coordinator
@@ -0,0 +1,188 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+#include <vector>
+
+#include "yb/common/pgsql_protocol.pb.h"
+#include "yb/common/schema.h"
+#include "yb/common/transaction.h"
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/docdb.h"
+#include "yb/docdb/docdb.messages.h"
+#include "yb/docdb/pgsql_operation.h"
+
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+using std::string;
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+constexpr uint16_t kHashCode = 0x1234;
+
+const Schema kSchema(
+    {ColumnSchema(
+         "h", DataType::INT32, /* is_nullable = */ false, /* is_hash_key = */ true),
+     ColumnSchema(
+         "r1", DataType::STRING, /* is_nullable = */ false, false, false, false, 0,
+         SortingType::kAscending),
+     ColumnSchema(
+         "r2", DataType::INT32, /* is_nullable = */ false, false, false, false, 0,
+         SortingType::kAscending),
+     // Non-key columns
+     ColumnSchema("payload", DataType::INT32, true)},
+    {10_ColId, 11_ColId, 12_ColId, 13_ColId}, 3);
+
+// Returns the value in the form YSQL sends strings of columns with a non-C collation:
+// a zero byte, the sort key, a zero byte and the original string.
+string CollationEncoded(const string& value) {
+  return string(1, '\0') + "sort_" + value + string(1, '\0') + value;
+}
+
+QLValuePB Int32Value(int32_t value) {
+  QLValuePB result;
+  result.set_int32_value(value);
+  return result;
+}
+
+QLValuePB StringValue(const string& value) {
+  QLValuePB result;
+  result.set_string_value(value);
+  return result;
+}
+
+KeyEntryValue KeyValue(const QLValuePB& value, size_t column_idx) {
+  return KeyEntryValue::FromQLValuePB(value, kSchema.column(column_idx).sorting_type());
+}
+
+void AddCondition(
+    PgsqlConditionPB* cond, QLOperator op, ColumnId column_id, const QLValuePB& value) {
+  auto* sub_cond = cond->add_operands()->mutable_condition();
+  sub_cond->set_op(op);
+  sub_cond->add_operands()->set_column_id(column_id);
+  *sub_cond->add_operands()->mutable_value() = value;
+}
+
+PgsqlReadRequestPB MakeRequest(int32_t h) {
+  PgsqlReadRequestPB req;
+  *req.add_partition_column_values()->mutable_value() = Int32Value(h);
+  req.set_hash_code(kHashCode);
+  req.mutable_condition_expr()->mutable_condition()->set_op(QL_OP_AND);
+  return req;
+}
+
+PgsqlConditionPB* Condition(PgsqlReadRequestPB* req) {
+  return req->mutable_condition_expr()->mutable_condition();
+}
+
+Result<string> ReadIntentKey(const PgsqlReadRequestPB& req) {
+  TransactionOperationContext txn_op_context;
+  PgsqlReadOperation read_op(req, txn_op_context);
+  ThreadSafeArena arena;
+  LWKeyValueWriteBatchPB batch(&arena);
+  RETURN_NOT_OK(read_op.GetIntents(kSchema, &batch));
+  SCHECK_EQ(batch.read_pairs().size(), 1U, IllegalState, "Single read intent expected");
+  return batch.read_pairs().front().key().ToBuffer();
+}
+
+DocKey RowDocKey(int32_t h, const string& r1, int32_t r2) {
+  return DocKey(
+      kSchema, kHashCode, {KeyValue(Int32Value(h), 0)},
+      {KeyValue(StringValue(r1), 1), KeyValue(Int32Value(r2), 2)});
+}
+
+// Returns true if a write of the payload column of the specified row conflicts with the strong
+// read intent on read_intent_key, i.e. when one of the weak intents of this write is placed on
+// read_intent_key.
+Result<bool> WriteConflicts(
+    const string& read_intent_key, int32_t h, const string& r1, int32_t r2) {
+  auto write_key = SubDocKey(
+      RowDocKey(h, r1, r2), KeyEntryValue::MakeColumnId(13_ColId)).Encode();
+  bool result = false;
+  KeyBytes buffer;
+  RETURN_NOT_OK(EnumerateIntents(
+      write_key.AsSlice(), Slice(),
+      [&read_intent_key, &result](
+          IntentStrength, FullDocKey, Slice, KeyBytes* key, LastKey) -> Status {
+        if (key->AsSlice() == Slice(read_intent_key)) {
+          result = true;
+        }
+        return Status::OK();
+      }, &buffer, PartialRangeKeyIntents::kTrue));
+  return result;
+}
+
+} // namespace
+
+TEST(PgsqlOperationTest, ReadIntentKeyWithoutCondition) {
+  PgsqlReadRequestPB req;
+  *req.add_partition_column_values()->mutable_value() = Int32Value(1);
+  req.set_hash_code(kHashCode);
+  auto key = ASSERT_RESULT(ReadIntentKey(req));
+  ASSERT_EQ(key, DocKey(kSchema, kHashCode, {KeyValue(Int32Value(1), 0)}, {})
+                     .Encode().ToStringBuffer());
+}
+
+TEST(PgsqlOperationTest, ReadIntentKeySingleValueRange) {
+  const auto r1 = CollationEncoded("a");
+  auto req = MakeRequest(1);
+  AddCondition(Condition(&req), QL_OP_EQUAL, 11_ColId, StringValue(r1));
+  AddCondition(Condition(&req), QL_OP_GREATER_THAN_EQUAL, 12_ColId, Int32Value(5));
+  auto key = ASSERT_RESULT(ReadIntentKey(req));
+
+  auto range_component = KeyValue(StringValue(r1), 1);
+  ASSERT_EQ(range_component.type(), KeyEntryType::kCollString);
+  ASSERT_EQ(key, DocKey(kSchema, kHashCode, {KeyValue(Int32Value(1), 0)}, {range_component})
+                     .Encode().ToStringBuffer());
+
+  // Rows within the locked prefix conflict with the read, rows outside of it do not.
+  ASSERT_TRUE(ASSERT_RESULT(WriteConflicts(key, 1, r1, 5)));
+  ASSERT_TRUE(ASSERT_RESULT(WriteConflicts(key, 1, r1, 1)));
+  ASSERT_FALSE(ASSERT_RESULT(WriteConflicts(key, 1, CollationEncoded("b"), 5)));
+  ASSERT_FALSE(ASSERT_RESULT(WriteConflicts(key, 2, r1, 5)));
+}
+
+TEST(PgsqlOperationTest, ReadIntentKeyAllRangeColumns) {
+  const auto r1 = CollationEncoded("a");
+  auto req = MakeRequest(1);
+  AddCondition(Condition(&req), QL_OP_EQUAL, 12_ColId, Int32Value(5));
+  AddCondition(Condition(&req), QL_OP_EQUAL, 11_ColId, StringValue(r1));
+  auto key = ASSERT_RESULT(ReadIntentKey(req));
+  ASSERT_EQ(key, RowDocKey(1, r1, 5).Encode().ToStringBuffer());
+
+  ASSERT_TRUE(ASSERT_RESULT(WriteConflicts(key, 1, r1, 5)));
+  ASSERT_FALSE(ASSERT_RESULT(WriteConflicts(key, 1, r1, 6)));
+}
+
+TEST(PgsqlOperationTest, ReadIntentKeyStopsAtNonSingleValueColumn) {
+  const auto r1 = CollationEncoded("a");
+  auto req = MakeRequest(1);
+  // r1 is not restricted to a single value, so r2 could not extend the prefix.
+  AddCondition(Condition(&req), QL_OP_GREATER_THAN_EQUAL, 11_ColId, StringValue(r1));
+  AddCondition(Condition(&req), QL_OP_EQUAL, 12_ColId, Int32Value(5));
+  auto key = ASSERT_RESULT(ReadIntentKey(req));
+  ASSERT_EQ(key, DocKey(kSchema, kHashCode, {KeyValue(Int32Value(1), 0)}, {})
+                     .Encode().ToStringBuffer());
+
+  ASSERT_TRUE(ASSERT_RESULT(WriteConflicts(key, 1, r1, 5)));
+  ASSERT_TRUE(ASSERT_RESULT(WriteConflicts(key, 1, CollationEncoded("b"), 7)));
+  ASSERT_FALSE(ASSERT_RESULT(WriteConflicts(key, 2, r1, 5)));
+}
+
+}  // namespace docdb
+}  // namespace yb
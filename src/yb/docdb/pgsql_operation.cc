@@ -22,6 +22,7 @@
 
 #include "yb/common/partition.h"
 #include "yb/common/pg_system_attr.h"
+#include "yb/common/ql_scanspec.h"
 #include "yb/common/ql_value.h"
 
 #include "yb/docdb/doc_path.h"
@@ -181,6 +182,54 @@ Result<string> FetchEncodedDocKey(const Schema& schema, const PgsqlReadRequestPB
       [](const auto& encoded_doc_key) { return encoded_doc_key; });
 }
 
+// Appends to range_components the values of the following range key columns that the condition
+// restricts to a single value, stopping at the first column that is not restricted this way.
+void AppendSingleValueRangeComponents(
+    const Schema& schema, const PgsqlConditionPB& condition,
+    std::vector<KeyEntryValue>* range_components) {
+  QLScanRange scan_range(schema, condition);
+  for (auto i = schema.num_hash_key_columns() + range_components->size();
+       i < schema.num_key_columns(); ++i) {
+    const auto range = scan_range.RangeFor(schema.column_id(i));
+    if (!range.min_bound || !range.max_bound ||
+        !range.min_bound->IsInclusive() || !range.max_bound->IsInclusive() ||
+        IsNull(range.min_bound->GetValue()) ||
+        !(range.min_bound->GetValue() == range.max_bound->GetValue())) {
+      break;
+    }
+    range_components->push_back(KeyEntryValue::FromQLValuePB(
+        range.min_bound->GetValue(), schema.column(i).sorting_type()));
+  }
+}
+
+// Returns the key to lock for the read request. A read that does not address specific rows locks
+// the doc key prefix that covers all rows it could read with a single intent. Besides the key
+// columns specified explicitly, we extend this prefix with the leading range columns that are
+// restricted to a single value by the condition, so that e.g. a serializable range scan over
+// rows with the same leading key columns does not lock the whole table or hash bucket.
+Result<std::string> FetchEncodedReadIntentKey(
+    const Schema& schema, const PgsqlReadRequestPB& request) {
+  if (request.has_ybctid_column_value() || !request.has_condition_expr() ||
+      !request.condition_expr().has_condition()) {
+    return FetchEncodedDocKey(schema, request);
+  }
+  auto hashed_components = VERIFY_RESULT(InitKeyColumnPrimitiveValues(
+      request.partition_column_values(), schema, 0 /* start_idx */));
+  // Without hash components, rows of a hash partitioned table do not share a range prefix.
+  if (hashed_components.empty() && schema.num_hash_key_columns() != 0) {
+    return FetchEncodedDocKey(schema, request);
+  }
+  auto range_components = VERIFY_RESULT(InitKeyColumnPrimitiveValues(
+      request.range_column_values(), schema, schema.num_hash_key_columns()));
+  AppendSingleValueRangeComponents(
+      schema, request.condition_expr().condition(), &range_components);
+  auto doc_key = hashed_components.empty()
+      ? DocKey(schema, std::move(range_components))
+      : DocKey(schema, request.hash_code(), std::move(hashed_components),
+               std::move(range_components));
+  return doc_key.Encode().ToStringBuffer();
+}
+
 Result<DocKey> FetchDocKey(const Schema& schema, const PgsqlWriteRequestPB& request) {
   return FetchDocKeyImpl<DocKey>(
       schema, request,
@@ -1464,7 +1513,8 @@ Status PgsqlReadOperation::GetIntents(const Schema& schema, LWKeyValueWriteBatch
       RETURN_NOT_OK(AddIntent(batch_argument.ybctid(), request_.wait_policy(), out));
     }
   } else {
-    AddIntent(VERIFY_RESULT(FetchEncodedDocKey(schema, request_)), request_.wait_policy(), out);
+    AddIntent(
+        VERIFY_RESULT(FetchEncodedReadIntentKey(schema, request_)), request_.wait_policy(), out);
   }
   return Status::OK();
 }
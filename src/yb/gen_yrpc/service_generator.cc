@@ -48,6 +48,14 @@ std::vector<MetricDescriptor> inbound_metrics = {
     .units = "yb::MetricUnit::kMicroseconds",
     .description = "Microseconds spent handling",
   },
+  {
+    .name = "handler_cpu_time",
+    .prefix = "",
+    .kind = "histogram_with_percentiles",
+    .extra_args = ",\n  60000000LU, 2",
+    .units = "yb::MetricUnit::kMicroseconds",
+    .description = "Microseconds of thread CPU time spent handling",
+  },
 };
 
 } // namespace
@@ -0,0 +1,149 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <chrono>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "yb/consensus/consensus.h"
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include "yb/integration-tests/mini_cluster.h"
+#include "yb/integration-tests/test_workload.h"
+
+#include "yb/tablet/tablet_peer.h"
+
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
+
+#include "yb/util/test_util.h"
+
+using namespace std::literals;
+
+DECLARE_bool(enable_multi_raft_heartbeat_batcher);
+DECLARE_bool(multi_raft_batch_commit_updates);
+DECLARE_int32(multi_raft_urgent_batch_delay_rtt_percent);
+DECLARE_uint64(multi_raft_heartbeat_interval_ms);
+
+namespace yb {
+namespace consensus {
+
+class MultiRaftBatcherITest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+    FLAGS_enable_multi_raft_heartbeat_batcher = true;
+    FLAGS_multi_raft_batch_commit_updates = true;
+    // Give committed op id updates of different tablets time to join the same batch.
+    FLAGS_multi_raft_urgent_batch_delay_rtt_percent = 1000;
+  }
+
+  void TearDown() override {
+    if (workload_) {
+      workload_->StopAndJoin();
+    }
+    if (cluster_) {
+      cluster_->Shutdown();
+    }
+    YBTest::TearDown();
+  }
+
+  void StartClusterAndWorkload() {
+    MiniClusterOptions opts;
+    opts.num_tablet_servers = 3;
+    cluster_ = std::make_unique<MiniCluster>(opts);
+    ASSERT_OK(cluster_->Start());
+
+    workload_ = std::make_unique<TestWorkload>(cluster_.get());
+    workload_->set_num_tablets(6);
+    workload_->set_num_write_threads(4);
+    workload_->set_write_batch_size(1);
+    workload_->set_timeout_allowed(true);
+    workload_->set_write_timeout_millis(5000);
+    workload_->Setup();
+    workload_->Start();
+  }
+
+  MultiRaftBatcherStats GetStats() {
+    MultiRaftBatcherStats result;
+    for (size_t i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      result += cluster_->GetTabletManager(i)->TEST_multi_raft_manager()->TEST_GetStats();
+    }
+    return result;
+  }
+
+  std::unique_ptr<MiniCluster> cluster_;
+  std::unique_ptr<TestWorkload> workload_;
+};
+
+TEST_F(MultiRaftBatcherITest, CommitUpdates) {
+  ASSERT_NO_FATALS(StartClusterAndWorkload());
+  workload_->WaitInserted(500);
+  workload_->StopAndJoin();
+
+  // Followers learn about the last committed operations only from the batched updates and
+  // heartbeats.
+  ASSERT_OK(WaitFor([this] {
+    std::unordered_map<TabletId, OpId> leader_committed_op_ids;
+    for (const auto& peer : ListTabletPeers(cluster_.get(), ListPeersFilter::kLeaders)) {
+      auto consensus = peer->shared_consensus();
+      if (!consensus) {
+        return false;
+      }
+      leader_committed_op_ids[peer->tablet_id()] = consensus->GetLastCommittedOpId();
+    }
+    for (const auto& peer : ListTabletPeers(cluster_.get(), ListPeersFilter::kNonLeaders)) {
+      auto consensus = peer->shared_consensus();
+      auto it = leader_committed_op_ids.find(peer->tablet_id());
+      if (!consensus || it == leader_committed_op_ids.end() ||
+          consensus->GetLastCommittedOpId() != it->second) {
+        return false;
+      }
+    }
+    return true;
+  }, 10s * kTimeMultiplier, "Followers committed op ids"));
+
+  ASSERT_OK(WaitFor([this] {
+    return GetStats().in_flight_batches == 0;
+  }, 10s * kTimeMultiplier, "In flight batches completed"));
+
+  auto stats = GetStats();
+  LOG(INFO) << "Stats: " << stats.ToString();
+  ASSERT_GT(stats.urgent_requests, 0);
+  ASSERT_GT(stats.urgent_batches, 0);
+  // Updates of different tablets should share batches.
+  ASSERT_LT(stats.urgent_batches, stats.urgent_requests);
+}
+
+TEST_F(MultiRaftBatcherITest, ShutdownWithScheduledUrgentBatch) {
+  // Long delay, so the urgent batch is still scheduled when the cluster is shut down.
+  FLAGS_multi_raft_heartbeat_interval_ms = 1000;
+  FLAGS_multi_raft_urgent_batch_delay_rtt_percent = 100000;
+  ASSERT_NO_FATALS(StartClusterAndWorkload());
+
+  ASSERT_OK(WaitFor([this] {
+    return GetStats().scheduled_urgent_batches > 0;
+  }, 30s * kTimeMultiplier, "Urgent batch scheduled"));
+
+  // Batchers should fail pending requests and abort the scheduled task, without waiting for it.
+  workload_->Stop();
+  cluster_->Shutdown();
+  cluster_.reset();
+  workload_->Join();
+  workload_.reset();
+}
+
+} // namespace consensus
+} // namespace yb
@@ -52,6 +52,7 @@
 #include "yb/util/metrics.h"
 #include "yb/util/result.h"
 #include "yb/util/status_format.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/string_util.h"
 #include "yb/util/trace.h"
 #include "yb/util/tsan_util.h"
@@ -66,6 +67,16 @@ using strings::Substitute;
 DEFINE_UNKNOWN_uint64(rpc_connection_timeout_ms, yb::NonTsanVsTsan(15000, 30000),
     "Timeout for RPC connection operations");
 
+DEFINE_RUNTIME_uint64(rpc_write_coalesce_delay_us, 0,
+    "Max time that sending of small outbound data could be delayed, so it is written to the socket "
+    "together with data queued later. 0 to write queued data immediately.");
+TAG_FLAG(rpc_write_coalesce_delay_us, advanced);
+
+DEFINE_RUNTIME_uint64(rpc_write_coalesce_max_bytes, 16_KB,
+    "Outbound data is written immediately when this number of bytes is pending on connection, "
+    "regardless of rpc_write_coalesce_delay_us.");
+TAG_FLAG(rpc_write_coalesce_max_bytes, advanced);
+
 METRIC_DEFINE_histogram_with_percentiles(
     server, handler_latency_outbound_transfer, "Time taken to transfer the response ",
     yb::MetricUnit::kMicroseconds, "Microseconds spent to queue and write the response to the wire",
@@ -152,6 +163,7 @@ void Connection::Shutdown(const Status& status) {
   active_calls_.clear();
 
   timer_.Shutdown();
+  write_coalesce_timer_.Shutdown();
 
   // TODO(bogdan): re-enable once we decide how to control verbose logs better...
   // LOG_WITH_PREFIX(INFO) << "Connection::Shutdown completed, status: " << status;
@@ -160,6 +172,30 @@ void Connection::Shutdown(const Status& status) {
 void Connection::OutboundQueued() {
   DCHECK(reactor_->IsCurrentThread());
 
+  auto delay_us = FLAGS_rpc_write_coalesce_delay_us;
+  if (delay_us != 0 && write_coalesce_timer_.IsInitialized() && stream_->IsConnected() &&
+      stream_->GetPendingWriteBytes() < FLAGS_rpc_write_coalesce_max_bytes) {
+    // Wait a bit for more data, so multiple small calls are sent with a single system call.
+    if (!write_coalesce_timer_->is_active()) {
+      IncrementCounter(rpc_metrics_->outbound_writes_delayed);
+      write_coalesce_timer_.Start(std::chrono::microseconds(delay_us));
+    }
+    return;
+  }
+
+  if (write_coalesce_timer_.IsInitialized()) {
+    write_coalesce_timer_->stop();
+  }
+  Flush();
+}
+
+void Connection::HandleWriteCoalesceTimeout(ev::timer& watcher, int revents) {  // NOLINT
+  DCHECK(reactor_->IsCurrentThread());
+
+  Flush();
+}
+
+void Connection::Flush() {
   auto status = stream_->TryWrite();
   if (!status.ok()) {
     VLOG_WITH_PREFIX(1) << "Write failed: " << status;
@@ -475,6 +511,9 @@ Status Connection::Start(ev::loop_ref* loop) {
 
   timer_.Init(*loop);
   timer_.SetCallback<Connection, &Connection::HandleTimeout>(this); // NOLINT
+  write_coalesce_timer_.Init(*loop);
+  write_coalesce_timer_.SetCallback<Connection, &Connection::HandleWriteCoalesceTimeout>( // NOLINT
+      this);
 
   if (!stream_->IsConnected()) {
     timer_.Start(FLAGS_rpc_connection_timeout_ms * 1ms);
@@ -150,6 +150,8 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
 
   void HandleTimeout(ev::timer& watcher, int revents); // NOLINT
 
+  void HandleWriteCoalesceTimeout(ev::timer& watcher, int revents); // NOLINT
+
   // Safe to be called from other threads.
   std::string ToString() const;
 
@@ -170,6 +172,8 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
                 RpcConnectionPB* resp);
 
   // Do appropriate actions after adding outbound call.
+  // When rpc_write_coalesce_delay_us is set, small pending data is written after this delay,
+  // so it could be coalesced with data queued in the meantime.
   void OutboundQueued();
 
   // An incoming packet has completed on the client side. This parses the
@@ -193,6 +197,9 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
  private:
   Status DoWrite();
 
+  // Writes queued data to the stream, destroying connection on failure.
+  void Flush();
+
   // Does actual outbound data queueing. Invoked in appropriate reactor thread.
   size_t DoQueueOutboundData(OutboundDataPtr call, bool batch);
 
@@ -260,6 +267,9 @@ class Connection final : public StreamContext, public std::enable_shared_from_th
 
   EvTimerHolder timer_;
 
+  // Fires when delay of coalesced write expired.
+  EvTimerHolder write_coalesce_timer_;
+
   simple_spinlock outbound_data_queue_lock_;
 
   // Responses we are going to process.
@@ -183,6 +183,14 @@ void InboundCall::RecordHandlingCompleted() {
   }
 }
 
+void InboundCall::RecordHandlerCpuTime(MonoDelta cpu_time) {
+  auto cpu_time_us = cpu_time.ToMicroseconds();
+  handler_cpu_time_us_.fetch_add(cpu_time_us, std::memory_order_acq_rel);
+  if (rpc_method_handler_cpu_time_) {
+    rpc_method_handler_cpu_time_->Increment(cpu_time_us);
+  }
+}
+
 bool InboundCall::ClientTimedOut() const {
   auto deadline = GetClientDeadline();
   if (deadline == CoarseTimePoint::max()) {
@@ -248,6 +256,7 @@ void InboundCall::SetRpcMethodMetrics(std::reference_wrapper<const RpcMethodMetr
   const auto& metrics = value.get();
   rpc_method_response_bytes_ = metrics.response_bytes;
   rpc_method_handler_latency_ = metrics.handler_latency;
+  rpc_method_handler_cpu_time_ = metrics.handler_cpu_time;
   if (metrics.request_bytes) {
     auto request_size = request_data_.size();
     if (request_size) {
@@ -147,6 +147,16 @@ class InboundCall : public RpcCall, public MPSCQueueEntry<InboundCall> {
   // Not thread-safe. Should only be called by the current "owner" thread.
   void RecordHandlingCompleted();
 
+  // Records CPU time spent by the service thread while running the handler of this call.
+  // Does not include time spent by other threads on asynchronous parts of the call processing.
+  // It is recorded after the handler returns, so it is available while the call is in progress
+  // only for handlers that respond asynchronously.
+  void RecordHandlerCpuTime(MonoDelta cpu_time);
+
+  MonoDelta handler_cpu_time() const {
+    return MonoDelta::FromMicroseconds(handler_cpu_time_us_.load(std::memory_order_acquire));
+  }
+
   // Return true if the deadline set by the client has already elapsed.
   // In this case, the server may stop processing the call, since the
   // call response will be ignored anyway.
@@ -177,6 +187,12 @@ class InboundCall : public RpcCall, public MPSCQueueEntry<InboundCall> {
 //  virtual const std::string& service_name() const = 0;
   virtual void RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code, const Status& status) = 0;
 
+  // Responds with ERROR_SERVER_TOO_BUSY, suggesting the client to wait for retry_after before
+  // retrying the call. Protocols that could not pass the hint just respond with the failure.
+  virtual void RespondTooBusy(const Status& status, MonoDelta retry_after) {
+    RespondFailure(ErrorStatusPB::ERROR_SERVER_TOO_BUSY, status);
+  }
+
   // Do appropriate actions when call is timed out.
   //
   // message contains human readable information on why call timed out.
@@ -251,6 +267,9 @@ class InboundCall : public RpcCall, public MPSCQueueEntry<InboundCall> {
 
   scoped_refptr<Counter> rpc_method_response_bytes_;
   scoped_refptr<Histogram> rpc_method_handler_latency_;
+  scoped_refptr<Histogram> rpc_method_handler_cpu_time_;
+
+  std::atomic<int64_t> handler_cpu_time_us_{0};
 
   bool cleared_ = false;
   mutable simple_spinlock mutex_;
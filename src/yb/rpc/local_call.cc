@@ -22,6 +22,7 @@
 
 #include "yb/util/format.h"
 #include "yb/util/memory/memory.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/result.h"
 #include "yb/util/status_format.h"
 
@@ -30,6 +31,16 @@ namespace rpc {
 
 using std::shared_ptr;
 
+namespace {
+
+Status CopyResponse(AnyMessageConstPtr source, AnyMessagePtr dest) {
+  RefCntBuffer buffer(source.SerializedSize());
+  RETURN_NOT_OK(source.SerializeToArray(buffer.udata()));
+  return dest.ParseFromSlice(buffer.AsSlice());
+}
+
+} // namespace
+
 LocalOutboundCall::LocalOutboundCall(
     const RemoteMethod* remote_method,
     const shared_ptr<OutboundCallMetrics>& outbound_call_metrics,
@@ -98,6 +109,14 @@ void LocalYBInboundCall::Respond(AnyMessageConstPtr resp, bool is_success) {
   }
 
   if (is_success) {
+    auto response = call->response();
+    if (response.is_lightweight() != resp.is_lightweight()) {
+      auto status = CopyResponse(resp, response);
+      if (!status.ok()) {
+        call->SetFailed(status);
+        return;
+      }
+    }
     call->SetFinished();
   } else {
     std::unique_ptr<ErrorStatusPB> error;
@@ -114,7 +133,15 @@ void LocalYBInboundCall::Respond(AnyMessageConstPtr resp, bool is_success) {
 }
 
 Status LocalYBInboundCall::ParseParam(RpcCallParams* params) {
-  LOG(FATAL) << "local call should not require parsing";
+  // Only used when the service expects a different kind of messages than the proxy has sent.
+  auto call = outbound_call();
+  if (!call) {
+    return STATUS(Aborted, "Local call is already finished");
+  }
+  const auto& request = call->request();
+  RefCntBuffer buffer(request.SerializedSize());
+  RETURN_NOT_OK(request.SerializeToArray(buffer.udata()));
+  return ResultToStatus(params->ParseRequest(buffer.AsSlice(), buffer));
 }
 
 Result<size_t> LocalYBInboundCall::ParseRequest(Slice param, const RefCntBuffer& buffer) {
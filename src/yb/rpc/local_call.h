@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "yb/gutil/casts.h"
 
 #include "yb/rpc/outbound_call.h"
@@ -94,12 +96,23 @@ class LocalYBInboundCall : public YBInboundCall, public RpcCallParams {
   const CoarseTimePoint deadline_;
 };
 
+template <class Params>
+bool SameMessageKind(const LocalOutboundCall& outbound_call) {
+  return outbound_call.request().is_lightweight() ==
+         std::is_base_of<RpcCallLWParams, Params>::value;
+}
+
 template <class Params, class F>
 auto HandleCall(InboundCallPtr call, F f) {
   auto yb_call = std::static_pointer_cast<YBInboundCall>(call);
+  std::shared_ptr<LocalOutboundCall> outbound_call;
   if (yb_call->IsLocalCall()) {
+    outbound_call = std::static_pointer_cast<LocalYBInboundCall>(yb_call)->outbound_call();
+  }
+  // When proxy and service use different kinds of messages, i.e. protobuf and lightweight
+  // protobuf, the local call is handled as a regular call that passes messages in serialized form.
+  if (outbound_call && SameMessageKind<Params>(*outbound_call)) {
     auto local_call = std::static_pointer_cast<LocalYBInboundCall>(yb_call);
-    auto outbound_call = local_call->outbound_call();
     auto* req = yb::down_cast<const typename Params::RequestType*>(
         Params::CastMessage(outbound_call->request()));
     auto* resp = yb::down_cast<typename Params::ResponseType*>(
@@ -11,14 +11,21 @@
 // under the License.
 //
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "yb/gutil/casts.h"
+
 #include "yb/rpc/lightweight_message.h"
 #include "yb/rpc/rtest.messages.h"
 #include "yb/rpc/rtest.pb.h"
 
 #include "yb/util/faststring.h"
 #include "yb/util/logging.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/random_util.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/test_macros.h"
 
 namespace yb {
@@ -82,5 +89,134 @@ TEST(LWProtoTest, SkipsUnknownFields) {
   }
 }
 
+#ifdef YB_TCMALLOC_ENABLED
+// Compares memory allocated from the heap to parse a request into regular and lightweight
+// protobufs. Regular protobuf allocates each string and nested message separately, while
+// lightweight protobuf allocates from the arena and its strings refer to the received buffer.
+TEST(LWProtoTest, ParseAllocations) {
+  constexpr size_t kMessages = 1000;
+
+  rpc_test::LightweightRequestPB pb;
+  pb.set_str(RandomHumanReadableString(32));
+  pb.set_bytes(RandomHumanReadableString(32));
+  for (int i = 0; i != 8; ++i) {
+    pb.add_rstr(RandomHumanReadableString(32));
+    auto& pair = *pb.add_pairs();
+    pair.set_s1(RandomHumanReadableString(16));
+    pair.set_s2(RandomHumanReadableString(48));
+  }
+  RefCntBuffer buffer(pb.ByteSizeLong());
+  pb.SerializeToArray(buffer.data(), narrow_cast<int>(buffer.size()));
+
+  std::vector<rpc_test::LightweightRequestPB> messages(kMessages);
+  auto start_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes();
+  for (auto& msg : messages) {
+    ASSERT_TRUE(msg.ParseFromArray(buffer.data(), narrow_cast<int>(buffer.size())));
+  }
+  auto heap_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes() - start_bytes;
+
+  std::vector<rpc_test::LWLightweightRequestPB*> lw_messages;
+  lw_messages.reserve(kMessages);
+  start_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes();
+  ThreadSafeArena arena;
+  for (size_t i = 0; i != kMessages; ++i) {
+    auto* msg = arena.NewArenaObject<rpc_test::LWLightweightRequestPB>();
+    ASSERT_OK(msg->ParseFromSlice(buffer.AsSlice()));
+    lw_messages.push_back(msg);
+  }
+  auto lw_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes() - start_bytes;
+
+  LOG(INFO) << "Serialized size: " << buffer.size()
+            << ", heap bytes per message, protobuf: " << heap_bytes / kMessages
+            << ", lightweight: " << lw_bytes / kMessages;
+
+  // Strings are not copied.
+  const auto& str = lw_messages.back()->str();
+  ASSERT_EQ(str, pb.str());
+  ASSERT_GE(str.cdata(), buffer.data());
+  ASSERT_LE(str.cend(), buffer.end());
+  ASSERT_LT(lw_bytes, heap_bytes);
+}
+
+namespace {
+
+constexpr int kLocalCallPairs = 8;
+
+// Fills the response the way a lightweight service does for a local call.
+void FillLocalCallResponse(
+    const rpc_test::LWLightweightRequestPB& req, rpc_test::LWLightweightResponsePB* resp) {
+  resp->dup_str(req.str());
+  for (const auto& p : req.pairs()) {
+    auto& pair = *resp->add_pairs();
+    pair.dup_s1(p.s2());
+    pair.dup_s2(p.s1());
+  }
+}
+
+} // namespace
+
+// Compares memory allocated from the heap for local calls of a method that uses lightweight
+// messages on both sides. A caller that keeps regular protobufs copies its request into a
+// lightweight message and converts the response back, while a caller that builds lightweight
+// messages directly only allocates their arenas.
+TEST(LWProtoTest, LocalCallAllocations) {
+  constexpr size_t kCalls = 1000;
+
+  auto str = RandomHumanReadableString(32);
+  std::vector<std::pair<std::string, std::string>> pairs;
+  for (int i = 0; i != kLocalCallPairs; ++i) {
+    pairs.emplace_back(RandomHumanReadableString(16), RandomHumanReadableString(48));
+  }
+
+  struct RegularCall {
+    rpc_test::LightweightRequestPB request;
+    rpc_test::LightweightResponsePB response;
+    std::shared_ptr<rpc_test::LWLightweightRequestPB> lw_request;
+    std::shared_ptr<rpc_test::LWLightweightResponsePB> lw_response;
+  };
+  std::vector<RegularCall> regular_calls(kCalls);
+  auto start_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes();
+  for (auto& call : regular_calls) {
+    call.request.set_str(str);
+    for (const auto& [s1, s2] : pairs) {
+      auto& pair = *call.request.add_pairs();
+      pair.set_s1(s1);
+      pair.set_s2(s2);
+    }
+    call.lw_request = CopySharedMessage(call.request);
+    call.lw_response = MakeSharedMessage<rpc_test::LWLightweightResponsePB>();
+    FillLocalCallResponse(*call.lw_request, call.lw_response.get());
+    call.lw_response->ToGoogleProtobuf(&call.response);
+  }
+  auto regular_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes() - start_bytes;
+
+  struct LightweightCall {
+    std::shared_ptr<rpc_test::LWLightweightRequestPB> request;
+    std::shared_ptr<rpc_test::LWLightweightResponsePB> response;
+  };
+  std::vector<LightweightCall> lw_calls(kCalls);
+  start_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes();
+  for (auto& call : lw_calls) {
+    call.request = MakeSharedMessage<rpc_test::LWLightweightRequestPB>();
+    call.request->dup_str(str);
+    for (const auto& [s1, s2] : pairs) {
+      auto& pair = *call.request->add_pairs();
+      pair.dup_s1(s1);
+      pair.dup_s2(s2);
+    }
+    call.response = MakeSharedMessage<rpc_test::LWLightweightResponsePB>();
+    FillLocalCallResponse(*call.request, call.response.get());
+  }
+  auto lw_bytes = MemTracker::GetTCMallocCurrentAllocatedBytes() - start_bytes;
+
+  LOG(INFO) << "Heap bytes per local call, protobuf with conversion: " << regular_bytes / kCalls
+            << ", lightweight: " << lw_bytes / kCalls;
+
+  ASSERT_EQ(regular_calls.back().response.str(), str);
+  ASSERT_EQ(lw_calls.back().response->str(), str);
+  ASSERT_LT(lw_bytes, regular_bytes);
+}
+#endif
+
 } // namespace rpc
 } // namespace yb
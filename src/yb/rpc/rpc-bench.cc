@@ -41,6 +41,7 @@
 #include "yb/rpc/rtest.proxy.h"
 
 #include "yb/util/countdown_latch.h"
+#include "yb/util/metrics.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/status_log.h"
 #include "yb/util/test_util.h"
@@ -48,6 +49,9 @@
 
 using namespace std::literals; // NOLINT
 
+METRIC_DECLARE_counter(tcp_send_calls);
+METRIC_DECLARE_counter(tcp_recv_calls);
+
 using std::string;
 using std::shared_ptr;
 
@@ -120,6 +124,11 @@ TEST_F(RpcBench, BenchmarkCalls) {
   client_options.n_reactors = 2;
   auto client_messenger = CreateAutoShutdownMessengerHolder("Client", client_options);
 
+  auto send_calls = METRIC_tcp_send_calls.Instantiate(metric_entity());
+  auto recv_calls = METRIC_tcp_recv_calls.Instantiate(metric_entity());
+  auto initial_send_calls = send_calls->value();
+  auto initial_recv_calls = recv_calls->value();
+
   Stopwatch sw(Stopwatch::ALL_THREADS);
   sw.start();
 
@@ -149,10 +158,17 @@ TEST_F(RpcBench, BenchmarkCalls) {
   float reqs_per_second = static_cast<float>(total_reqs / sw.elapsed().wall_seconds());
   float user_cpu_micros_per_req = static_cast<float>(sw.elapsed().user / 1000.0 / total_reqs);
   float sys_cpu_micros_per_req = static_cast<float>(sw.elapsed().system / 1000.0 / total_reqs);
+  // Client and server messengers share the same metric entity, so both sides are counted.
+  float send_calls_per_req = static_cast<float>(
+      static_cast<double>(send_calls->value() - initial_send_calls) / total_reqs);
+  float recv_calls_per_req = static_cast<float>(
+      static_cast<double>(recv_calls->value() - initial_recv_calls) / total_reqs);
 
   LOG(INFO) << "Reqs/sec:         " << reqs_per_second;
   LOG(INFO) << "User CPU per req: " << user_cpu_micros_per_req << "us";
   LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
+  LOG(INFO) << "Sends per req:    " << send_calls_per_req;
+  LOG(INFO) << "Recvs per req:    " << recv_calls_per_req;
 }
 
 } // namespace rpc
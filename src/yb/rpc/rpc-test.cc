@@ -34,6 +34,7 @@
 
 #include <condition_variable>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <thread>
@@ -49,6 +50,7 @@
 #include "yb/rpc/compressed_stream.h"
 #include "yb/rpc/network_error.h"
 #include "yb/rpc/proxy.h"
+#include "yb/rpc/rpc.h"
 #include "yb/rpc/rpc_controller.h"
 #include "yb/rpc/secure_stream.h"
 #include "yb/rpc/serialization.h"
@@ -72,24 +74,38 @@
 #include "yb/util/flags.h"
 
 METRIC_DECLARE_histogram(handler_latency_yb_rpc_test_CalculatorService_Sleep);
+METRIC_DECLARE_histogram(handler_cpu_time_yb_rpc_test_CalculatorService_Sleep);
 METRIC_DECLARE_histogram(rpc_incoming_queue_time);
 METRIC_DECLARE_counter(tcp_bytes_sent);
 METRIC_DECLARE_counter(tcp_bytes_received);
 METRIC_DECLARE_counter(rpcs_timed_out_early_in_queue);
+METRIC_DECLARE_counter(rpcs_queue_overflow);
+METRIC_DECLARE_counter(rpcs_shed_by_adaptive_limit);
+METRIC_DECLARE_counter(rpc_outbound_writes_delayed);
+METRIC_DECLARE_counter(tcp_zero_copy_bytes_sent);
 
 DEFINE_UNKNOWN_int32(rpc_test_connection_keepalive_num_iterations, 1,
   "Number of iterations in TestRpc.TestConnectionKeepalive");
 
 DECLARE_bool(TEST_pause_calculator_echo_request);
+DECLARE_bool(TEST_tcp_stream_ignore_zero_copy_completions);
 DECLARE_bool(binary_call_parser_reject_on_mem_tracker_hard_limit);
 DECLARE_bool(enable_rpc_keepalive);
+DECLARE_bool(rpc_adaptive_queue_limit);
+DECLARE_bool(rpc_track_handler_cpu_time);
+DECLARE_bool(tcp_stream_zero_copy_send);
+DECLARE_int32(min_backoff_ms_exponent);
 DECLARE_int32(num_connections_to_server);
+DECLARE_int32(rpc_adaptive_queue_target_latency_ms);
+DECLARE_int64(rpc_adaptive_queue_min_limit);
 DECLARE_int64(rpc_throttle_threshold_bytes);
 DECLARE_int32(stream_compression_algo);
 DECLARE_int64(memory_limit_hard_bytes);
+DECLARE_string(rpc_high_priority_methods);
 DECLARE_string(vmodule);
 DECLARE_uint64(rpc_connection_timeout_ms);
 DECLARE_uint64(rpc_read_buffer_size);
+DECLARE_uint64(rpc_write_coalesce_delay_us);
 
 using namespace std::chrono_literals;
 using std::string;
@@ -655,6 +671,7 @@ Result<CounterPtr> GetCounter(
 
 // Test handler latency metric.
 TEST_F(TestRpc, TestRpcHandlerLatencyMetric) {
+  FLAGS_rpc_track_handler_cpu_time = true;
 
   const uint64_t sleep_micros = 20 * 1000;
 
@@ -688,6 +705,12 @@ TEST_F(TestRpc, TestRpcHandlerLatencyMetric) {
   ASSERT_GE(latency_histogram->MaxValueForTests(), sleep_micros);
   ASSERT_TRUE(latency_histogram->MinValueForTests() == latency_histogram->MaxValueForTests());
 
+  // Deferred sleep happens outside of the handler, so it is not accounted as handler CPU time.
+  auto cpu_time_histogram = ASSERT_RESULT(GetHistogram(
+      metric_entity(), METRIC_handler_cpu_time_yb_rpc_test_CalculatorService_Sleep));
+  ASSERT_EQ(1, cpu_time_histogram->TotalCount());
+  ASSERT_LT(cpu_time_histogram->MaxValueForTests(), sleep_micros);
+
   // TODO: Implement an incoming queue latency test.
   // For now we just assert that the metric exists.
   ASSERT_OK(GetHistogram(metric_entity(), METRIC_rpc_incoming_queue_time));
@@ -794,6 +817,149 @@ TEST_F(TestRpc, QueueTimeout) {
   ASSERT_EQ(counter->value(), kCalls - 1);
 }
 
+// Sends a sleep call, retrying it while the server is too busy, and records the retry hints
+// received from the server along with the resulting retry delays.
+class BusyRetryCommand : public Rpc {
+ public:
+  BusyRetryCommand(Messenger* messenger, ProxyCache* proxy_cache, const HostPort& server_addr)
+      : Rpc(CoarseMonoClock::Now() + 30s, messenger, proxy_cache),
+        proxy_(messenger, server_addr) {
+    req_.set_sleep_micros(0);
+  }
+
+  void SendRpc() override {
+    send_times_.push_back(CoarseMonoClock::Now());
+    proxy_.AsyncRequest(
+        CalculatorServiceMethods::SleepMethod(), /* method_metrics= */ nullptr, req_, &resp_,
+        PrepareController(), std::bind(&BusyRetryCommand::Finished, this, Status::OK()));
+  }
+
+  std::string ToString() const override {
+    return "BusyRetryCommand";
+  }
+
+  void Finished(const Status& status) override {
+    const auto* err = retrier().controller().error_response();
+    if (err && err->has_retry_after_ms()) {
+      retry_hints_.push_back(err->retry_after_ms() * 1ms);
+    }
+    auto result = status;
+    if (result.ok() && mutable_retrier()->HandleResponse(this, &result)) {
+      retry_delays_.push_back(retrier().retry_delay());
+      return;
+    }
+    promise_.set_value(result);
+  }
+
+  Status Wait() {
+    return promise_.get_future().get();
+  }
+
+  const std::vector<CoarseTimePoint>& send_times() const { return send_times_; }
+  const std::vector<MonoDelta>& retry_hints() const { return retry_hints_; }
+  const std::vector<MonoDelta>& retry_delays() const { return retry_delays_; }
+
+ private:
+  Proxy proxy_;
+  rpc_test::SleepRequestPB req_;
+  rpc_test::SleepResponsePB resp_;
+  // Attempts are sequential, so these are not accessed concurrently.
+  std::vector<CoarseTimePoint> send_times_;
+  std::vector<MonoDelta> retry_hints_;
+  std::vector<MonoDelta> retry_delays_;
+  std::promise<Status> promise_;
+};
+
+// Calls that wait in the queue longer than the target latency should shrink the adaptive queue
+// limit, so excess calls are rejected before being queued. High priority calls are not limited by
+// it, and each call handled in time grows the limit by one.
+TEST_F(TestRpc, AdaptiveQueueLimit) {
+  constexpr auto kSleep = 50ms;
+  constexpr auto kCalls = 60;
+  constexpr auto kFastCalls = 10;
+
+  FLAGS_rpc_adaptive_queue_limit = true;
+  FLAGS_rpc_adaptive_queue_target_latency_ms = 10;
+  FLAGS_rpc_adaptive_queue_min_limit = 1;
+  FLAGS_rpc_high_priority_methods = Format(
+      "$0.$1", rpc_test::CalculatorServiceIf::static_service_name(),
+      CalculatorServiceMethods::kAddMethodName);
+  FLAGS_min_backoff_ms_exponent = 0;
+
+  TestServerOptions options;
+  options.n_worker_threads = 1;
+  HostPort server_addr;
+  StartTestServerWithGeneratedCode(&server_addr, options);
+  auto& service_pool = server().service_pool();
+  const auto initial_limit = service_pool.TEST_adaptive_queue_limit();
+
+  auto client_messenger = CreateAutoShutdownMessengerHolder("Client");
+  ProxyCache proxy_cache(client_messenger.get());
+  Proxy p(client_messenger.get(), server_addr);
+
+  struct Call {
+    rpc_test::SleepRequestPB req;
+    rpc_test::SleepResponsePB resp;
+    RpcController controller;
+  };
+  std::vector<Call> calls(kCalls);
+  CountDownLatch latch(kCalls);
+  for (auto& call : calls) {
+    call.req.set_sleep_micros(narrow_cast<uint32_t>(ToMicroseconds(kSleep)));
+    call.controller.set_timeout(30s);
+    p.AsyncRequest(
+        CalculatorServiceMethods::SleepMethod(), /* method_metrics= */ nullptr, call.req,
+        &call.resp, &call.controller, latch.CountDownCallback());
+  }
+
+  // Queued calls are handled late, so the limit drops.
+  ASSERT_OK(WaitFor([&service_pool] {
+    return service_pool.TEST_adaptive_queue_limit() == 1;
+  }, 10s, "Adaptive queue limit decreased"));
+
+  // The queue is still over the limit, so the call is rejected with a retry hint. Retries should
+  // wait for the hint, while the backoff of subsequent retries is not affected by it.
+  auto command = std::make_shared<BusyRetryCommand>(
+      client_messenger.get(), &proxy_cache, server_addr);
+  command->SendRpc();
+
+  // High priority calls are not limited by the adaptive limit.
+  ASSERT_OK(DoTestSyncCall(&p, CalculatorServiceMethods::AddMethod()));
+
+  latch.Wait();
+  for (auto& call : calls) {
+    ASSERT_OK(call.controller.status());
+  }
+  ASSERT_OK(command->Wait());
+
+  const auto& hints = command->retry_hints();
+  const auto& delays = command->retry_delays();
+  const auto& send_times = command->send_times();
+  ASSERT_FALSE(hints.empty());
+  ASSERT_EQ(hints.size(), delays.size());
+  ASSERT_EQ(send_times.size(), delays.size() + 1);
+  for (size_t i = 0; i != delays.size(); ++i) {
+    ASSERT_GE(hints[i], MonoDelta::FromMilliseconds(FLAGS_rpc_adaptive_queue_target_latency_ms));
+    // Exponential backoff starting from 2ms, as if there were no hints.
+    ASSERT_EQ(delays[i], MonoDelta::FromMilliseconds(2LL << i));
+    ASSERT_GE(MonoDelta(send_times[i + 1] - send_times[i]), hints[i]);
+  }
+
+  auto shed = ASSERT_RESULT(GetCounter(metric_entity(), METRIC_rpcs_shed_by_adaptive_limit));
+  auto overflow = ASSERT_RESULT(GetCounter(metric_entity(), METRIC_rpcs_queue_overflow));
+  ASSERT_EQ(shed->value(), static_cast<int64_t>(hints.size()));
+  ASSERT_EQ(overflow->value(), 0);
+
+  // Calls that are handled in time increase the limit additively.
+  FLAGS_rpc_adaptive_queue_target_latency_ms = 10000;
+  auto limit = service_pool.TEST_adaptive_queue_limit();
+  ASSERT_LT(limit, initial_limit);
+  for (int i = 0; i != kFastCalls; ++i) {
+    ASSERT_OK(DoTestSyncCall(&p, CalculatorServiceMethods::AddMethod()));
+  }
+  ASSERT_EQ(service_pool.TEST_adaptive_queue_limit(), limit + kFastCalls);
+}
+
 struct DisconnectShare {
   Proxy proxy;
   size_t left;
@@ -1170,6 +1336,39 @@ TEST_F(TestRpcSecure, BigOpWithSmallBuffer) {
   RunSecureTest(&TestBigOp);
 }
 
+TEST_F(TestRpc, ZeroCopySend) {
+  FLAGS_tcp_stream_zero_copy_send = true;
+  RunPlainTest([this](CalculatorServiceProxy* proxy) {
+    // Kernel holds buffers of zero copy sends after the call completes, so check that data of
+    // subsequent calls is not corrupted.
+    for (int i = 0; i != 10; ++i) {
+      TestBigOp(proxy);
+    }
+#if defined(__linux__)
+    auto zero_copy_sent = ASSERT_RESULT(
+        GetCounter(metric_entity(), METRIC_tcp_zero_copy_bytes_sent));
+    ASSERT_GT(zero_copy_sent->value(), 0);
+#endif
+  });
+}
+
+#if defined(__linux__)
+TEST_F(TestRpc, ZeroCopySendShutdownWithPendingSends) {
+  FLAGS_tcp_stream_zero_copy_send = true;
+  // Over loopback the kernel completes zero copy sends immediately, so emulate buffers that are
+  // still pinned by the kernel.
+  FLAGS_TEST_tcp_stream_ignore_zero_copy_completions = true;
+  StringWaiterLogSink log_waiter("pending zero copy sends");
+  RunPlainTest([](CalculatorServiceProxy* proxy) {
+    for (int i = 0; i != 3; ++i) {
+      TestBigOp(proxy);
+    }
+  });
+  // Messengers are shut down at this point, so connections with pending sends should be reset.
+  ASSERT_OK(log_waiter.WaitFor(10s * kTimeMultiplier));
+}
+#endif
+
 void TestManyOps(CalculatorServiceProxy* proxy) {
   for (int i = 0; i != RegularBuildVsSanitizers(1000, 100); ++i) {
     RpcController controller;
@@ -1212,6 +1411,16 @@ TEST_F(TestRpcSecure, ConcurrentOps) {
   RunSecureTest(&TestConcurrentOps);
 }
 
+TEST_F(TestRpc, WriteCoalescing) {
+  FLAGS_rpc_write_coalesce_delay_us = 200;
+  RunPlainTest([this](CalculatorServiceProxy* proxy) {
+    TestConcurrentOps(proxy);
+    auto delayed_writes = ASSERT_RESULT(
+        GetCounter(metric_entity(), METRIC_rpc_outbound_writes_delayed));
+    ASSERT_GT(delayed_writes->value(), 0);
+  });
+}
+
 TEST_F(TestRpcSecure, CantAllocateReadBuffer) {
   RunSecureTest(&TestCantAllocateReadBuffer, SetupServerForTestCantAllocateReadBuffer());
 }
@@ -106,7 +106,12 @@ bool RpcRetrier::HandleResponse(
     if (err &&
         err->has_code() &&
         err->code() == ErrorStatusPB::ERROR_SERVER_TOO_BUSY) {
-      auto status = DelayedRetry(rpc, controller_status, BackoffStrategy::kExponential);
+      // The server could suggest how long its queue is backed up, don't retry earlier than that.
+      // The hint applies to this retry only, so it does not inflate the backoff of next retries.
+      auto min_delay = err->has_retry_after_ms()
+          ? MonoDelta::FromMilliseconds(err->retry_after_ms()) : MonoDelta::kZero;
+      auto status = DelayedRetry(
+          rpc, controller_status, BackoffStrategy::kExponential, min_delay);
       if (!status.ok()) {
         *out_status = status;
         return false;
@@ -120,7 +125,7 @@ bool RpcRetrier::HandleResponse(
 }
 
 Status RpcRetrier::DelayedRetry(
-    RpcCommand* rpc, const Status& why_status, BackoffStrategy strategy) {
+    RpcCommand* rpc, const Status& why_status, BackoffStrategy strategy, MonoDelta min_delay) {
   // Add some jitter to the retry delay.
   //
   // If the delay causes us to miss our deadline, RetryCb will fail the
@@ -135,7 +140,7 @@ Status RpcRetrier::DelayedRetry(
     retry_delay_ += 1ms * FLAGS_linear_backoff_ms;
   }
 
-  return DoDelayedRetry(rpc, why_status);
+  return DoDelayedRetry(rpc, why_status, min_delay);
 }
 
 Status RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoDelta add_delay) {
@@ -143,7 +148,8 @@ Status RpcRetrier::DelayedRetry(RpcCommand* rpc, const Status& why_status, MonoD
   return DoDelayedRetry(rpc, why_status);
 }
 
-Status RpcRetrier::DoDelayedRetry(RpcCommand* rpc, const Status& why_status) {
+Status RpcRetrier::DoDelayedRetry(
+    RpcCommand* rpc, const Status& why_status, MonoDelta min_delay) {
   if (!why_status.ok() && (last_error_.ok() || last_error_.IsTimedOut())) {
     last_error_ = why_status;
   }
@@ -166,7 +172,7 @@ Status RpcRetrier::DoDelayedRetry(RpcCommand* rpc, const Status& why_status) {
   auto retain_rpc = rpc->shared_from_this();
   task_id_ = messenger_->ScheduleOnReactor(
       std::bind(&RpcRetrier::DoRetry, this, rpc, _1),
-      retry_delay_ + MonoDelta::FromMilliseconds(RandomUniformInt(0, 4)),
+      std::max(retry_delay_, min_delay) + MonoDelta::FromMilliseconds(RandomUniformInt(0, 4)),
       SOURCE_LOCATION(), messenger_);
 
   // Scheduling state can be changed only in this method, so we expected both
@@ -117,9 +117,12 @@ class RpcRetrier {
   // deadline has already expired at the time that Retry() was called.
   //
   // Callers should ensure that 'rpc' remains alive.
+  //
+  // The retry is not sent earlier than min_delay, but min_delay does not affect the delay of
+  // subsequent retries.
   Status DelayedRetry(
       RpcCommand* rpc, const Status& why_status,
-      BackoffStrategy strategy = BackoffStrategy::kLinear);
+      BackoffStrategy strategy = BackoffStrategy::kLinear, MonoDelta min_delay = MonoDelta::kZero);
 
   Status DelayedRetry(
       RpcCommand* rpc, const Status& why_status, MonoDelta add_delay);
@@ -143,6 +146,8 @@ class RpcRetrier {
 
   int attempt_num() const { return attempt_num_; }
 
+  MonoDelta retry_delay() const { return retry_delay_; }
+
   void Abort();
 
   std::string ToString() const;
@@ -156,7 +161,8 @@ class RpcRetrier {
   }
 
  private:
-  Status DoDelayedRetry(RpcCommand* rpc, const Status& why_status);
+  Status DoDelayedRetry(
+      RpcCommand* rpc, const Status& why_status, MonoDelta min_delay = MonoDelta::kZero);
 
   // Called when an RPC comes up for retrying. Actually sends the RPC.
   void DoRetry(RpcCommand* rpc, const Status& status);
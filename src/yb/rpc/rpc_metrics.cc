@@ -45,6 +45,12 @@ METRIC_DEFINE_counter(server, rpc_outbound_calls_created,
                       yb::MetricUnit::kRequests,
                       "Number of created RPC outbound calls.");
 
+METRIC_DEFINE_counter(server, rpc_outbound_writes_delayed,
+                      "Number of delayed RPC writes.",
+                      yb::MetricUnit::kRequests,
+                      "Number of times writing of outbound RPC data was delayed to coalesce it "
+                      "with data queued later.");
+
 namespace yb {
 namespace rpc {
 
@@ -56,6 +62,7 @@ RpcMetrics::RpcMetrics(const scoped_refptr<MetricEntity>& metric_entity) {
     inbound_calls_created = METRIC_rpc_inbound_calls_created.Instantiate(metric_entity);
     outbound_calls_alive = METRIC_rpc_outbound_calls_alive.Instantiate(metric_entity, 0);
     outbound_calls_created = METRIC_rpc_outbound_calls_created.Instantiate(metric_entity);
+    outbound_writes_delayed = METRIC_rpc_outbound_writes_delayed.Instantiate(metric_entity);
   }
 }
 
@@ -910,9 +910,7 @@ void Generate(rpc_test::LightweightSubMessagePB* sub_message) {
   }
 }
 
-TEST_F(RpcStubTest, Lightweight) {
-  CalculatorServiceProxy proxy(proxy_cache_.get(), server_hostport_);
-
+void CheckLightweight(CalculatorServiceProxy* proxy) {
   RpcController controller;
   rpc_test::LightweightRequestPB req;
   req.set_i32(RandomUniformInt<int32_t>());
@@ -971,7 +969,7 @@ TEST_F(RpcStubTest, Lightweight) {
   Generate(req.mutable_ptr_message());
 
   rpc_test::LightweightResponsePB resp;
-  ASSERT_OK(proxy.Lightweight(req, &resp, &controller));
+  ASSERT_OK(proxy->Lightweight(req, &resp, &controller));
 
   ASSERT_EQ(resp.i32(), -req.i32());
   ASSERT_EQ(resp.i64(), -req.i64());
@@ -1029,6 +1027,19 @@ TEST_F(RpcStubTest, Lightweight) {
   ASSERT_STR_EQ(AsString(resp.short_debug_string()), req_str);
 }
 
+TEST_F(RpcStubTest, Lightweight) {
+  CalculatorServiceProxy proxy(proxy_cache_.get(), server_hostport_);
+  ASSERT_NO_FATALS(CheckLightweight(&proxy));
+}
+
+// Proxy uses regular protobufs while the service uses lightweight ones, so the local call should
+// pass messages in serialized form.
+TEST_F(RpcStubTest, LightweightLocalCall) {
+  ProxyCache local_proxy_cache(server_messenger());
+  CalculatorServiceProxy proxy(&local_proxy_cache, HostPort());
+  ASSERT_NO_FATALS(CheckLightweight(&proxy));
+}
+
 TEST_F(RpcStubTest, CustomServiceName) {
   SendSimpleCall();
 
@@ -51,9 +51,10 @@ RpcMethodMetrics::RpcMethodMetrics() = default;
 
 RpcMethodMetrics::RpcMethodMetrics(const scoped_refptr<Counter>& request_bytes_,
                                    const scoped_refptr<Counter>& response_bytes_,
-                                   const scoped_refptr<Histogram>& handler_latency_)
+                                   const scoped_refptr<Histogram>& handler_latency_,
+                                   const scoped_refptr<Histogram>& handler_cpu_time_)
     : request_bytes(request_bytes_), response_bytes(response_bytes_),
-      handler_latency(handler_latency_) {
+      handler_latency(handler_latency_), handler_cpu_time(handler_cpu_time_) {
 }
 
 RpcMethodMetrics::~RpcMethodMetrics() = default;
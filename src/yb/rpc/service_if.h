@@ -56,11 +56,14 @@ struct RpcMethodMetrics {
   scoped_refptr<Counter> request_bytes;
   scoped_refptr<Counter> response_bytes;
   scoped_refptr<Histogram> handler_latency;
+  // CPU time of the service thread spent in the synchronous part of the handler.
+  scoped_refptr<Histogram> handler_cpu_time;
 
   RpcMethodMetrics();
   RpcMethodMetrics(const scoped_refptr<Counter>& request_bytes,
                    const scoped_refptr<Counter>& response_bytes,
-                   const scoped_refptr<Histogram>& handler_latency);
+                   const scoped_refptr<Histogram>& handler_latency,
+                   const scoped_refptr<Histogram>& handler_cpu_time = nullptr);
   RpcMethodMetrics(const RpcMethodMetrics&);
   ~RpcMethodMetrics();
 };
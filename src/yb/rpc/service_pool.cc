@@ -35,10 +35,13 @@
 #include <pthread.h>
 #include <sys/types.h>
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/asio/strand.hpp>
@@ -49,11 +52,16 @@
 
 #include "yb/gutil/atomicops.h"
 #include "yb/gutil/ref_counted.h"
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/strings/strip.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/walltime.h"
 
 #include "yb/rpc/inbound_call.h"
 #include "yb/rpc/scheduler.h"
+#include "yb/rpc/serialization.h"
 #include "yb/rpc/service_if.h"
+#include "yb/rpc/thread_pool.h"
 
 #include "yb/util/countdown_latch.h"
 #include "yb/util/flags.h"
@@ -79,6 +87,40 @@ DEFINE_RUNTIME_int64(backpressure_recovery_period_ms, 600000,
     "Once we hit a backpressure/service-overflow we will consider dropping stale requests "
     "for this duration (in ms)");
 TAG_FLAG(backpressure_recovery_period_ms, advanced);
+DEFINE_NON_RUNTIME_string(rpc_high_priority_methods, "",
+    "Comma separated list of RPC services or methods (service.method), calls of which are queued "
+    "to the rpc thread pool with high priority. For example: yb.tserver.TabletServerService.Read");
+TAG_FLAG(rpc_high_priority_methods, advanced);
+DEFINE_NON_RUNTIME_string(rpc_low_priority_methods, "",
+    "Comma separated list of RPC services or methods (service.method), calls of which are queued "
+    "to the rpc thread pool with low priority. For example: "
+    "yb.tserver.RemoteBootstrapService,yb.cdc.CDCService.GetChanges");
+TAG_FLAG(rpc_low_priority_methods, advanced);
+DEFINE_RUNTIME_int64(rpc_low_priority_queue_limit, 0,
+    "Max number of queued low priority calls per service. 0 means that low priority calls are "
+    "limited only by the service queue length.");
+TAG_FLAG(rpc_low_priority_queue_limit, advanced);
+DEFINE_RUNTIME_int64(rpc_low_priority_max_time_in_queue_ms, 0,
+    "Fail low priority calls that waited in the queue longer than the specified amount of time "
+    "(in ms). 0 to disable.");
+TAG_FLAG(rpc_low_priority_max_time_in_queue_ms, advanced);
+DEFINE_RUNTIME_bool(rpc_adaptive_queue_limit, false,
+    "Adaptively limit the number of queued calls of each service based on the observed queue "
+    "time. The limit is decreased multiplicatively while calls wait in the queue longer than "
+    "rpc_adaptive_queue_target_latency_ms, and increased additively otherwise. Calls over the "
+    "limit are rejected with a retry hint before the queue itself overflows.");
+TAG_FLAG(rpc_adaptive_queue_limit, advanced);
+DEFINE_RUNTIME_int32(rpc_adaptive_queue_target_latency_ms, 50,
+    "Target queue time of calls for the adaptive queue limit.");
+TAG_FLAG(rpc_adaptive_queue_target_latency_ms, advanced);
+DEFINE_RUNTIME_int64(rpc_adaptive_queue_min_limit, 32,
+    "Lower bound for the adaptive queue limit of a service.");
+TAG_FLAG(rpc_adaptive_queue_min_limit, advanced);
+DEFINE_RUNTIME_bool(rpc_track_handler_cpu_time, false,
+    "Whether thread CPU time spent in RPC handlers should be measured and reported in per method "
+    "handler_cpu_time metrics and /rpcz. Adds two thread CPU clock syscalls to each call.");
+TAG_FLAG(rpc_track_handler_cpu_time, advanced);
+
 DEFINE_test_flag(bool, enable_backpressure_mode_for_testing, false,
             "For testing purposes. Enables the rpc's to be considered timed out in the queue even "
             "when we have not had any backpressure in the recent past.");
@@ -88,6 +130,24 @@ METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time,
                         yb::MetricUnit::kMicroseconds,
                         "Number of microseconds incoming RPC requests spend in the worker queue");
 
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_high_priority,
+                        "RPC Queue Time For High Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming high priority RPC requests spend in the "
+                        "worker queue");
+
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_normal_priority,
+                        "RPC Queue Time For Normal Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming normal priority RPC requests spend in the "
+                        "worker queue, when RPC priorities are configured");
+
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_low_priority,
+                        "RPC Queue Time For Low Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming low priority RPC requests spend in the "
+                        "worker queue");
+
 METRIC_DEFINE_counter(server, rpcs_timed_out_in_queue,
                       "RPC Queue Timeouts",
                       yb::MetricUnit::kRequests,
@@ -108,6 +168,12 @@ METRIC_DEFINE_counter(server, rpcs_queue_overflow,
                       "Number of RPCs dropped because the service queue "
                       "was full.");
 
+METRIC_DEFINE_counter(server, rpcs_shed_by_adaptive_limit,
+                      "RPCs Shed By Adaptive Limit",
+                      yb::MetricUnit::kRequests,
+                      "Number of RPCs rejected because the service had more queued calls than "
+                      "allowed by the adaptive queue limit.");
+
 namespace yb {
 namespace rpc {
 
@@ -116,6 +182,16 @@ namespace {
 const CoarseDuration kTimeoutCheckGranularity = 100ms;
 const char* const kTimedOutInQueue = "Call waited in the queue past deadline";
 
+std::unordered_set<std::string> ParseMethodList(const std::string& input) {
+  std::unordered_set<std::string> result;
+  std::vector<std::string> entries = strings::Split(input, ",", strings::SkipWhitespace());
+  for (auto& entry : entries) {
+    StripWhiteSpace(&entry);
+    result.insert(std::move(entry));
+  }
+  return result;
+}
+
 } // namespace
 
 class ServicePoolImpl final : public InboundCallHandler {
@@ -134,6 +210,8 @@ class ServicePoolImpl final : public InboundCallHandler {
         rpcs_timed_out_early_in_queue_(
             METRIC_rpcs_timed_out_early_in_queue.Instantiate(entity)),
         rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
+        rpcs_shed_by_adaptive_limit_(METRIC_rpcs_shed_by_adaptive_limit.Instantiate(entity)),
+        metric_entity_(entity),
         check_timeout_strand_(scheduler->io_service()),
         log_prefix_(Format("$0: ", service_->service_name())) {
 
@@ -183,9 +261,29 @@ class ServicePoolImpl final : public InboundCallHandler {
   void Enqueue(const InboundCallPtr& call) {
     TRACE_TO(call->trace(), "Inserting onto call queue");
 
+    auto priority = CallPriority(*call);
+    // High priority calls are limited only by the service queue length.
+    if (priority != TaskPriority::kHigh && GetAtomicFlag(&FLAGS_rpc_adaptive_queue_limit)) {
+      auto limit = adaptive_queue_limit_.load(std::memory_order_acquire);
+      if (queued_calls_.load(std::memory_order_acquire) >= limit) {
+        Overflow(call, "adaptive", limit, rpcs_shed_by_adaptive_limit_.get());
+        return;
+      }
+    }
+
+    if (priority == TaskPriority::kLow && !LowPriorityCallQueued()) {
+      Overflow(call, "low priority", low_priority_queued_calls_.load(std::memory_order_relaxed),
+               rpcs_queue_overflow_.get());
+      return;
+    }
+
     auto task = call->BindTask(this);
     if (!task) {
-      Overflow(call, "service", queued_calls_.load(std::memory_order_relaxed));
+      if (priority == TaskPriority::kLow) {
+        low_priority_queued_calls_.fetch_sub(1, std::memory_order_acq_rel);
+      }
+      Overflow(call, "service", queued_calls_.load(std::memory_order_relaxed),
+               rpcs_queue_overflow_.get());
       return;
     }
 
@@ -195,7 +293,7 @@ class ServicePoolImpl final : public InboundCallHandler {
       ScheduleCheckTimeout(call_deadline);
     }
 
-    thread_pool_.Enqueue(task);
+    thread_pool_.Enqueue(task, priority);
   }
 
   const Counter* RpcsTimedOutInQueueMetricForTests() const {
@@ -214,7 +312,13 @@ class ServicePoolImpl final : public InboundCallHandler {
     return service_;
   }
 
-  void Overflow(const InboundCallPtr& call, const char* type, size_t limit) {
+  int64_t TEST_adaptive_queue_limit() const {
+    return adaptive_queue_limit_.load(std::memory_order_acquire);
+  }
+
+  // Rejects the call, since the queue of the specified type is full. counter is the metric of
+  // calls rejected by this queue.
+  void Overflow(const InboundCallPtr& call, const char* type, size_t limit, Counter* counter) {
     const auto err_msg =
         Format("$0 request on $1 from $2 dropped due to backpressure. "
                    "The $3 queue is full, it has $4 items.",
@@ -225,13 +329,16 @@ class ServicePoolImpl final : public InboundCallHandler {
             limit);
     YB_LOG_EVERY_N_SECS(WARNING, 3) << LogPrefix() << err_msg;
     const auto response_status = STATUS(ServiceUnavailable, err_msg);
-    rpcs_queue_overflow_->Increment();
-    call->RespondFailure(ErrorStatusPB::ERROR_SERVER_TOO_BUSY, response_status);
+    counter->Increment();
+    call->RespondTooBusy(response_status, RetryAfter());
     last_backpressure_at_.store(
         CoarseMonoClock::Now().time_since_epoch(), std::memory_order_release);
   }
 
   void Failure(const InboundCallPtr& call, const Status& status) override {
+    if (CallPriority(*call) == TaskPriority::kLow) {
+      low_priority_queued_calls_.fetch_sub(1, std::memory_order_acq_rel);
+    }
     if (!call->TryStartProcessing()) {
       return;
     }
@@ -246,21 +353,47 @@ class ServicePoolImpl final : public InboundCallHandler {
 
   void FillEndpoints(const RpcServicePtr& service, RpcEndpointMap* map) {
     service_->FillEndpoints(service, map);
+    InitMethodPriorities(service, *map);
   }
 
   void Handle(InboundCallPtr incoming) override {
     incoming->RecordHandlingStarted(incoming_queue_time_);
     ADOPT_TRACE(incoming->trace());
 
+    auto time_in_queue = incoming->GetTimeInQueue();
+    UpdateAdaptiveQueueLimit(time_in_queue);
+
+    auto priority = CallPriority(*incoming);
+    if (priority == TaskPriority::kLow) {
+      low_priority_queued_calls_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    if (!method_priorities_.empty()) {
+      priority_queue_time_[to_underlying(priority)]->Increment(time_in_queue.ToMicroseconds());
+    }
+
     const char* error_message;
     if (PREDICT_FALSE(incoming->ClientTimedOut())) {
       error_message = kTimedOutInQueue;
     } else if (PREDICT_FALSE(ShouldDropRequestDuringHighLoad(incoming))) {
       error_message = "The server is overloaded. Call waited in the queue past max_time_in_queue.";
+    } else if (priority == TaskPriority::kLow &&
+               PREDICT_FALSE(ShouldDropLowPriorityRequest(incoming))) {
+      error_message =
+          "Low priority call waited in the queue past rpc_low_priority_max_time_in_queue_ms.";
     } else {
       if (incoming->TryStartProcessing()) {
         TRACE_TO(incoming->trace(), "Handling call $0", AsString(incoming->method_name()));
-        service_->Handle(std::move(incoming));
+        if (FLAGS_rpc_track_handler_cpu_time) {
+          // The call could be responded and released by the handler, so keep it alive to
+          // record CPU time.
+          auto call = incoming;
+          auto start_cpu_time_us = GetThreadCpuTimeMicros();
+          service_->Handle(std::move(incoming));
+          call->RecordHandlerCpuTime(
+              MonoDelta::FromMicroseconds(GetThreadCpuTimeMicros() - start_cpu_time_us));
+        } else {
+          service_->Handle(std::move(incoming));
+        }
       }
       return;
     }
@@ -275,6 +408,142 @@ class ServicePoolImpl final : public InboundCallHandler {
   }
 
  private:
+  // AIMD control of the adaptive queue limit. Every call that spent less than the target latency in
+  // the queue increases the limit by one, up to the configured queue length. A call that waited
+  // longer decreases it by a quarter (at least by one), but at most once per target latency, so a
+  // burst of late calls that were queued under the old limit does not collapse it.
+  void UpdateAdaptiveQueueLimit(MonoDelta time_in_queue) {
+    const bool adaptive_queue_limit = GetAtomicFlag(&FLAGS_rpc_adaptive_queue_limit);
+    // Without the adaptive limit, calls are rejected only by the queue overflow, after which
+    // last_backpressure_at_ is set until the backpressure recovery period passes. Skip the
+    // shared writes of the average on the common path, when no rejection needs the retry hint.
+    if (!adaptive_queue_limit &&
+        last_backpressure_at_.load(std::memory_order_relaxed) ==
+            CoarseTimePoint().time_since_epoch()) {
+      return;
+    }
+
+    auto time_in_queue_us = time_in_queue.ToMicroseconds();
+    // Exponential moving average of the queue time with 1/8 weight of the new sample, used as the
+    // retry hint for rejected calls.
+    auto average_us = queue_time_average_us_.load(std::memory_order_relaxed);
+    queue_time_average_us_.store(
+        average_us + (time_in_queue_us - average_us) / 8, std::memory_order_relaxed);
+
+    if (!adaptive_queue_limit) {
+      return;
+    }
+
+    auto target = FLAGS_rpc_adaptive_queue_target_latency_ms * 1ms;
+    auto limit = adaptive_queue_limit_.load(std::memory_order_acquire);
+    if (time_in_queue_us <= FLAGS_rpc_adaptive_queue_target_latency_ms * 1000LL) {
+      if (implicit_cast<size_t>(limit) < max_queued_calls_) {
+        adaptive_queue_limit_.compare_exchange_strong(limit, limit + 1, std::memory_order_acq_rel);
+      }
+      return;
+    }
+
+    auto now = CoarseMonoClock::Now();
+    auto last_decrease = last_adaptive_limit_decrease_at_.load(std::memory_order_acquire);
+    if (now.time_since_epoch() - last_decrease < target ||
+        !last_adaptive_limit_decrease_at_.compare_exchange_strong(
+            last_decrease, now.time_since_epoch(), std::memory_order_acq_rel)) {
+      return;
+    }
+    auto new_limit = std::max<int64_t>(
+        limit - std::max<int64_t>(limit / 4, 1),
+        std::max<int64_t>(FLAGS_rpc_adaptive_queue_min_limit, 1));
+    adaptive_queue_limit_.store(new_limit, std::memory_order_release);
+    VLOG_WITH_PREFIX(2) << "Decreased adaptive queue limit: " << limit << " => " << new_limit
+                        << ", time in queue: " << time_in_queue;
+  }
+
+  // Delay suggested to clients whose calls were rejected because of overload.
+  MonoDelta RetryAfter() const {
+    return MonoDelta::FromMicroseconds(std::max<int64_t>(
+        queue_time_average_us_.load(std::memory_order_relaxed),
+        FLAGS_rpc_adaptive_queue_target_latency_ms * 1000));
+  }
+
+  // Assigns priorities to methods of this service listed in rpc_high_priority_methods and
+  // rpc_low_priority_methods. Invoked once, before the service starts receiving calls.
+  void InitMethodPriorities(const RpcServicePtr& service, const RpcEndpointMap& map) {
+    auto high_priority_methods = ParseMethodList(FLAGS_rpc_high_priority_methods);
+    auto low_priority_methods = ParseMethodList(FLAGS_rpc_low_priority_methods);
+    if (high_priority_methods.empty() && low_priority_methods.empty()) {
+      return;
+    }
+
+    const auto service_name = service_->service_name();
+    auto priority_for_name = [&](const std::string& name) -> std::optional<TaskPriority> {
+      if (high_priority_methods.count(name)) {
+        return TaskPriority::kHigh;
+      }
+      if (low_priority_methods.count(name)) {
+        return TaskPriority::kLow;
+      }
+      return std::nullopt;
+    };
+    const auto service_priority = priority_for_name(service_name);
+
+    std::vector<TaskPriority> method_priorities;
+    for (const auto& [serialized_method, service_and_index] : map) {
+      if (service_and_index.first.get() != service.get()) {
+        continue;
+      }
+      auto remote_method = ParseRemoteMethod(serialized_method);
+      if (!remote_method.ok()) {
+        continue;
+      }
+      auto priority = priority_for_name(
+          service_name + "." + remote_method->method.ToBuffer());
+      if (!priority) {
+        priority = service_priority;
+      }
+      if (!priority || *priority == TaskPriority::kNormal) {
+        continue;
+      }
+      auto index = service_and_index.second;
+      if (method_priorities.size() <= index) {
+        method_priorities.resize(index + 1, TaskPriority::kNormal);
+      }
+      method_priorities[index] = *priority;
+      LOG_WITH_PREFIX(INFO) << "Using " << *priority << " for " << remote_method->method;
+    }
+    if (method_priorities.empty()) {
+      return;
+    }
+
+    priority_queue_time_[to_underlying(TaskPriority::kHigh)] =
+        METRIC_rpc_incoming_queue_time_high_priority.Instantiate(metric_entity_);
+    priority_queue_time_[to_underlying(TaskPriority::kNormal)] =
+        METRIC_rpc_incoming_queue_time_normal_priority.Instantiate(metric_entity_);
+    priority_queue_time_[to_underlying(TaskPriority::kLow)] =
+        METRIC_rpc_incoming_queue_time_low_priority.Instantiate(metric_entity_);
+    method_priorities_ = std::move(method_priorities);
+  }
+
+  TaskPriority CallPriority(const InboundCall& call) const {
+    auto index = call.method_index();
+    return index < method_priorities_.size() ? method_priorities_[index] : TaskPriority::kNormal;
+  }
+
+  bool LowPriorityCallQueued() {
+    auto limit = FLAGS_rpc_low_priority_queue_limit;
+    auto queued_calls = low_priority_queued_calls_.fetch_add(1, std::memory_order_acq_rel);
+    if (limit > 0 && queued_calls >= limit) {
+      low_priority_queued_calls_.fetch_sub(1, std::memory_order_acq_rel);
+      return false;
+    }
+    return true;
+  }
+
+  bool ShouldDropLowPriorityRequest(const InboundCallPtr& incoming) {
+    auto max_time_in_queue_ms = FLAGS_rpc_low_priority_max_time_in_queue_ms;
+    return max_time_in_queue_ms > 0 &&
+           incoming->GetTimeInQueue().ToMilliseconds() > max_time_in_queue_ms;
+  }
+
   void TimedOut(InboundCall* call, const char* error_message, Counter* metric) {
     if (call->RespondTimedOutIfPending(error_message)) {
       metric->Increment();
@@ -409,10 +678,22 @@ class ServicePoolImpl final : public InboundCallHandler {
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_timed_out_early_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
+  scoped_refptr<Counter> rpcs_shed_by_adaptive_limit_;
   scoped_refptr<AtomicGauge<int64_t>> rpcs_in_queue_;
+  scoped_refptr<MetricEntity> metric_entity_;
+  // Priorities of service methods indexed by method index, empty when priorities are not
+  // configured for this service.
+  std::vector<TaskPriority> method_priorities_;
+  std::array<scoped_refptr<Histogram>, kTaskPriorityMapSize> priority_queue_time_;
+  std::atomic<int64_t> low_priority_queued_calls_{0};
   // Have to use CoarseDuration here, since CoarseTimePoint does not work with clang + libstdc++
   std::atomic<CoarseDuration> last_backpressure_at_{CoarseTimePoint().time_since_epoch()};
   std::atomic<int64_t> queued_calls_{0};
+  // Max number of queued calls allowed by rpc_adaptive_queue_limit.
+  std::atomic<int64_t> adaptive_queue_limit_{static_cast<int64_t>(max_queued_calls_)};
+  std::atomic<CoarseDuration> last_adaptive_limit_decrease_at_{
+      CoarseTimePoint().time_since_epoch()};
+  std::atomic<int64_t> queue_time_average_us_{0};
 
   // It is too expensive to update timeout priority queue when each call is received.
   // So we are doing the following trick.
@@ -503,5 +784,9 @@ ServiceIfPtr ServicePool::TEST_get_service() const {
   return impl_->TEST_get_service();
 }
 
+int64_t ServicePool::TEST_adaptive_queue_limit() const {
+  return impl_->TEST_adaptive_queue_limit();
+}
+
 } // namespace rpc
 } // namespace yb
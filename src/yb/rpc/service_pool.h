@@ -83,6 +83,7 @@ class ServicePool : public RpcService {
   std::string service_name() const;
 
   ServiceIfPtr TEST_get_service() const;
+  int64_t TEST_adaptive_queue_limit() const;
  private:
   std::unique_ptr<ServicePoolImpl> impl_;
 };
@@ -60,6 +60,10 @@ class Sidecars {
     return buffer_.size();
   }
 
+  size_t num_sidecars() const {
+    return offsets_.size();
+  }
+
   void CopyTo(std::byte* out);
 
   void Flush(ByteBlocks* output);
@@ -23,14 +23,33 @@
 #include "yb/util/memory/memory_usage.h"
 #include "yb/util/metrics.h"
 #include "yb/util/result.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/status_log.h"
 #include "yb/util/string_util.h"
 
 using namespace std::literals;
+using namespace yb::size_literals;
 
 DECLARE_uint64(rpc_connection_timeout_ms);
 DEFINE_test_flag(int32, delay_connect_ms, 0,
                  "Delay connect in tests for specified amount of milliseconds.");
+DEFINE_RUNTIME_bool(tcp_stream_stop_on_short_io, true,
+                    "Stop reading from or writing to a socket as soon as a single recvmsg/sendmsg "
+                    "transfers less than requested, instead of repeating the call until it fails "
+                    "with EAGAIN. Saves one syscall per readiness event.");
+TAG_FLAG(tcp_stream_stop_on_short_io, advanced);
+DEFINE_RUNTIME_bool(tcp_stream_zero_copy_send, false,
+                    "Send large outbound data with MSG_ZEROCOPY, so the kernel does not copy it. "
+                    "Only supported on Linux. Takes effect for new connections.");
+TAG_FLAG(tcp_stream_zero_copy_send, advanced);
+DEFINE_RUNTIME_uint64(tcp_stream_zero_copy_send_threshold_bytes, 64_KB,
+                      "Minimal number of bytes in a single send to use zero copy, when "
+                      "tcp_stream_zero_copy_send is enabled. Pinning pages is more expensive than "
+                      "copying small amounts of data.");
+TAG_FLAG(tcp_stream_zero_copy_send_threshold_bytes, advanced);
+DEFINE_test_flag(bool, tcp_stream_ignore_zero_copy_completions, false,
+                 "Drain zero copy completions from the socket error queue without applying them, "
+                 "as if the kernel still used buffers of all zero copy sends.");
 
 METRIC_DEFINE_simple_counter(
   server, tcp_bytes_sent, "Bytes sent over TCP connections", yb::MetricUnit::kBytes);
@@ -38,12 +57,30 @@ METRIC_DEFINE_simple_counter(
 METRIC_DEFINE_simple_counter(
   server, tcp_bytes_received, "Bytes received via TCP connections", yb::MetricUnit::kBytes);
 
+METRIC_DEFINE_simple_counter(
+  server, tcp_send_calls, "Number of sendmsg calls issued on TCP connections",
+  yb::MetricUnit::kOperations);
+
+METRIC_DEFINE_simple_counter(
+  server, tcp_recv_calls, "Number of recvmsg calls issued on TCP connections",
+  yb::MetricUnit::kOperations);
+
+METRIC_DEFINE_simple_counter(
+  server, tcp_zero_copy_bytes_sent, "Bytes sent over TCP connections with MSG_ZEROCOPY",
+  yb::MetricUnit::kBytes);
+
+METRIC_DEFINE_simple_counter(
+  server, tcp_zero_copy_fallbacks,
+  "Number of zero copy sends for which the kernel fell back to copying data",
+  yb::MetricUnit::kOperations);
+
 namespace yb {
 namespace rpc {
 
 namespace {
 
-const size_t kMaxIov = 16;
+// Enough to send a batch of coalesced small calls with a single system call.
+const size_t kMaxIov = 64;
 
 }
 
@@ -56,6 +93,11 @@ TcpStream::TcpStream(const StreamCreateData& data)
   if (data.metric_entity) {
     bytes_received_counter_ = METRIC_tcp_bytes_received.Instantiate(data.metric_entity);
     bytes_sent_counter_ = METRIC_tcp_bytes_sent.Instantiate(data.metric_entity);
+    send_calls_counter_ = METRIC_tcp_send_calls.Instantiate(data.metric_entity);
+    recv_calls_counter_ = METRIC_tcp_recv_calls.Instantiate(data.metric_entity);
+    zero_copy_bytes_sent_counter_ =
+        METRIC_tcp_zero_copy_bytes_sent.Instantiate(data.metric_entity);
+    zero_copy_fallbacks_counter_ = METRIC_tcp_zero_copy_fallbacks.Instantiate(data.metric_entity);
   }
 }
 
@@ -79,6 +121,15 @@ Status TcpStream::Start(bool connect, ev::loop_ref* loop, StreamContext* context
   RETURN_NOT_OK(socket_.SetSendTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
   RETURN_NOT_OK(socket_.SetRecvTimeout(FLAGS_rpc_connection_timeout_ms * 1ms));
 
+  if (FLAGS_tcp_stream_zero_copy_send) {
+    auto status = socket_.SetZeroCopy(true);
+    if (status.ok()) {
+      zero_copy_enabled_ = true;
+    } else {
+      YB_LOG_EVERY_N_SECS(WARNING, 60) << "Failed to enable zero copy send: " << status;
+    }
+  }
+
   if (connect && FLAGS_TEST_delay_connect_ms) {
     connect_delayer_.set(*loop);
     connect_delayer_.set<TcpStream, &TcpStream::DelayConnectHandler>(this);
@@ -139,6 +190,7 @@ void TcpStream::Close() {
 
 void TcpStream::Shutdown(const Status& status) {
   ClearSending(status);
+  ResetIfZeroCopyPending();
 
   if (!ReadBuffer().Empty()) {
     LOG_WITH_PREFIX(WARNING) << "Shutting down with pending inbound data ("
@@ -151,6 +203,25 @@ void TcpStream::Shutdown(const Status& status) {
   ReadBuffer().Reset();
 
   WARN_NOT_OK(socket_.Close(), "Error closing socket");
+
+  // Buffers of zero copy sends are released only after the connection was reset.
+  zero_copy_pending_.clear();
+}
+
+void TcpStream::ResetIfZeroCopyPending() {
+  if (zero_copy_pending_.empty()) {
+    return;
+  }
+  WARN_NOT_OK(ProcessZeroCopyCompletions(), "Failed to process zero copy completions");
+  if (zero_copy_pending_.empty()) {
+    return;
+  }
+  // Completions are not delivered after the socket is closed, while the kernel could still read
+  // the buffers. Reset the connection instead of closing it gracefully, so the kernel drops unsent
+  // data instead of transmitting buffers after they are released.
+  LOG_WITH_PREFIX(INFO) << "Resetting connection with " << zero_copy_pending_.size()
+                        << " pending zero copy sends";
+  WARN_NOT_OK(socket_.SetLinger(true, MonoDelta::kZero), "Failed to set SO_LINGER");
 }
 
 Status TcpStream::TryWrite() {
@@ -163,9 +234,12 @@ Status TcpStream::TryWrite() {
 
 TcpStream::FillIovResult TcpStream::FillIov(iovec* out) {
   int index = 0;
+  size_t total_bytes = 0;
+  size_t entries = 0;
   size_t offset = send_position_;
   bool only_heartbeats = true;
   for (auto& data : sending_) {
+    ++entries;
     const auto wrapped_data = data.data;
     if (wrapped_data && !wrapped_data->IsHeartbeat()) {
       only_heartbeats = false;
@@ -184,14 +258,15 @@ TcpStream::FillIovResult TcpStream::FillIov(iovec* out) {
 
       out[index].iov_base = const_cast<char*>(bytes.data()) + offset;
       out[index].iov_len = bytes.size() - offset;
+      total_bytes += out[index].iov_len;
       offset = 0;
       if (++index == kMaxIov) {
-        return FillIovResult{index, only_heartbeats};
+        return FillIovResult{index, total_bytes, entries, only_heartbeats};
       }
     }
   }
 
-  return FillIovResult{index, only_heartbeats};
+  return FillIovResult{index, total_bytes, entries, only_heartbeats};
 }
 
 Status TcpStream::DoWrite() {
@@ -213,9 +288,21 @@ Status TcpStream::DoWrite() {
       context_->UpdateLastActivity();
     }
 
+    auto zero_copy = zero_copy_enabled_ &&
+                     fill_result.bytes >= FLAGS_tcp_stream_zero_copy_send_threshold_bytes;
+    if (fill_result.len != 0) {
+      IncrementCounter(send_calls_counter_);
+    }
     auto result = fill_result.len != 0
-        ? socket_.Writev(iov, fill_result.len)
+        ? socket_.Writev(iov, fill_result.len, ZeroCopy(zero_copy))
         : 0;
+    if (zero_copy && !result.ok() && Errno(result.status()) == ENOBUFS) {
+      // Socket reached the limit of memory that could be pinned, so send this chunk with copying.
+      IncrementCounter(zero_copy_fallbacks_counter_);
+      IncrementCounter(send_calls_counter_);
+      zero_copy = false;
+      result = socket_.Writev(iov, fill_result.len);
+    }
     DVLOG_WITH_PREFIX(4) << "Queued writes " << queued_bytes_to_send_ << " bytes. Result "
                          << result << ", sending_.size(): " << sending_.size();
 
@@ -233,6 +320,19 @@ Status TcpStream::DoWrite() {
 
     IncrementCounterBy(bytes_sent_counter_, *result);
 
+    if (zero_copy) {
+      IncrementCounterBy(zero_copy_bytes_sent_counter_, *result);
+      auto seq = zero_copy_next_seq_++;
+      for (size_t i = 0; i != fill_result.entries; ++i) {
+        sending_[i].zero_copy_seq = seq;
+      }
+    }
+
+    // Socket send buffer is full, so next write would fail with EAGAIN.
+    bool short_write = fill_result.len != 0 &&
+                       *result < fill_result.bytes &&
+                       FLAGS_tcp_stream_stop_on_short_io;
+
     send_position_ += *result;
     while (!sending_.empty()) {
       auto& front = sending_.front();
@@ -251,17 +351,66 @@ Status TcpStream::DoWrite() {
         context_->Transferred(data, Status::OK());
       }
     }
+
+    if (short_write) {
+      break;
+    }
   }
 
   return Status::OK();
 }
 
 void TcpStream::PopSending() {
-  queued_bytes_to_send_ -= sending_.front().bytes_size();
+  auto& front = sending_.front();
+  queued_bytes_to_send_ -= front.bytes_size();
+  if (front.zero_copy_seq && !IsZeroCopyCompleted(*front.zero_copy_seq)) {
+    // Kernel could still read from these buffers, keep them until the send is completed.
+    zero_copy_pending_.push_back(std::move(front));
+  }
   sending_.pop_front();
   ++data_blocks_sent_;
 }
 
+bool TcpStream::IsZeroCopyCompleted(uint32_t seq) const {
+  // Handles wrap around of sequence numbers.
+  return static_cast<int32_t>(seq - zero_copy_completed_) < 0;
+}
+
+void TcpStream::ZeroCopyCompleted(uint32_t first, uint32_t last, bool copied) {
+  VLOG_WITH_PREFIX(4) << "Zero copy completed: [" << first << ", " << last << "], copied: "
+                      << copied;
+  if (copied) {
+    IncrementCounterBy(zero_copy_fallbacks_counter_, last - first + 1);
+  }
+  if (first != zero_copy_completed_) {
+    zero_copy_out_of_order_.emplace(first, last);
+    return;
+  }
+  zero_copy_completed_ = last + 1;
+  for (;;) {
+    auto it = zero_copy_out_of_order_.find(zero_copy_completed_);
+    if (it == zero_copy_out_of_order_.end()) {
+      break;
+    }
+    zero_copy_completed_ = it->second + 1;
+    zero_copy_out_of_order_.erase(it);
+  }
+}
+
+Status TcpStream::ProcessZeroCopyCompletions() {
+  RETURN_NOT_OK(socket_.ProcessZeroCopyCompletions(
+      [this](uint32_t first, uint32_t last, bool copied) {
+        if (!FLAGS_TEST_tcp_stream_ignore_zero_copy_completions) {
+          ZeroCopyCompleted(first, last, copied);
+        }
+      }));
+  while (!zero_copy_pending_.empty() &&
+         IsZeroCopyCompleted(*zero_copy_pending_.front().zero_copy_seq)) {
+    zero_copy_pending_.pop_front();
+  }
+  return Status::OK();
+}
+
 void TcpStream::Handler(ev::io& watcher, int revents) {  // NOLINT
   DVLOG_WITH_PREFIX(4) << "Handler(revents=" << revents << ")";
   Status status = Status::OK();
@@ -270,6 +419,15 @@ void TcpStream::Handler(ev::io& watcher, int revents) {  // NOLINT
     VLOG_WITH_PREFIX(3) << status;
   }
 
+  // Zero copy completions are delivered via the socket error queue, that is reported as both read
+  // and write readiness.
+  if (status.ok() && zero_copy_next_seq_ != zero_copy_completed_) {
+    status = ProcessZeroCopyCompletions();
+    if (!status.ok()) {
+      VLOG_WITH_PREFIX(3) << "ProcessZeroCopyCompletions() returned error: " << status;
+    }
+  }
+
   if (status.ok() && (revents & ev::READ)) {
     status = ReadHandler();
     if (!status.ok()) {
@@ -314,7 +472,8 @@ Status TcpStream::ReadHandler() {
   context_->UpdateLastRead();
 
   for (;;) {
-    auto received = Receive();
+    bool drained = false;
+    auto received = Receive(&drained);
     if (PREDICT_FALSE(!received.ok())) {
       if (Errno(received.status()) == ESHUTDOWN) {
         VLOG_WITH_PREFIX(1) << "Shut down by remote end.";
@@ -336,10 +495,14 @@ Status TcpStream::ReadHandler() {
     if (!continue_receiving.get()) {
       return Status::OK();
     }
+    // Socket has no more data, the event loop will notify us when new data arrives.
+    if (drained) {
+      return Status::OK();
+    }
   }
 }
 
-Result<bool> TcpStream::Receive() {
+Result<bool> TcpStream::Receive(bool* drained) {
   auto iov = ReadBuffer().PrepareAppend();
   if (!iov.ok()) {
     VLOG_WITH_PREFIX(3) << "ReadBuffer().PrepareAppend() error: " << iov.status();
@@ -355,6 +518,7 @@ Result<bool> TcpStream::Receive() {
     auto global_skip_buffer = GetGlobalSkipBuffer();
     do {
       VLOG_WITH_PREFIX(3) << "inbound_bytes_to_skip_: " << inbound_bytes_to_skip_;
+      IncrementCounter(recv_calls_counter_);
       auto nread = socket_.Recv(
           global_skip_buffer.mutable_data(),
           std::min(global_skip_buffer.size(), inbound_bytes_to_skip_));
@@ -370,6 +534,7 @@ Result<bool> TcpStream::Receive() {
     } while (inbound_bytes_to_skip_ > 0);
   }
 
+  IncrementCounter(recv_calls_counter_);
   auto nread = socket_.Recvv(iov.get_ptr());
   if (!nread.ok()) {
     DVLOG_WITH_PREFIX(3) << "socket_.Recvv() error: " << nread.status();
@@ -382,6 +547,7 @@ Result<bool> TcpStream::Receive() {
 
   IncrementCounterBy(bytes_received_counter_, *nread);
   ReadBuffer().DataAppended(*nread);
+  *drained = *nread < IoVecsFullSize(*iov) && FLAGS_tcp_stream_stop_on_short_io;
   return *nread != 0;
 }
 
@@ -441,6 +607,13 @@ bool TcpStream::Idle(std::string* reason_not_idle) {
     result = false;
   }
 
+  if (!zero_copy_pending_.empty()) {
+    if (reason_not_idle) {
+      AppendWithSeparator("zero copy send not completed", reason_not_idle);
+    }
+    result = false;
+  }
+
   return result;
 }
 
@@ -450,6 +623,10 @@ void TcpStream::ClearSending(const Status& status) {
     if (data.data) {
       context_->Transferred(data.data, status);
     }
+    if (data.zero_copy_seq && !IsZeroCopyCompleted(*data.zero_copy_seq)) {
+      // Partially sent data, kernel could still read from its buffers.
+      zero_copy_pending_.push_back(std::move(data));
+    }
   }
   sending_.clear();
   queued_bytes_to_send_ = 0;
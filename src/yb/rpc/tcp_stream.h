@@ -13,6 +13,9 @@
 
 #pragma once
 
+#include <optional>
+#include <unordered_map>
+
 #include <ev++.h>
 
 #include "yb/rpc/stream.h"
@@ -49,6 +52,8 @@ struct TcpStreamSendingData {
   SendingBytes bytes;
   ScopedTrackedConsumption consumption;
   bool skipped = false;
+  // Sequence number of the last zero copy send that referenced bytes of this data.
+  std::optional<uint32_t> zero_copy_seq;
 };
 
 class TcpStream : public Stream {
@@ -68,6 +73,9 @@ class TcpStream : public Stream {
  private:
   struct FillIovResult {
     int len;
+    size_t bytes;
+    // Number of entries at the beginning of sending_ that were used to fill iov.
+    size_t entries;
     bool only_heartbeats;
   };
 
@@ -99,7 +107,9 @@ class TcpStream : public Stream {
   Status ReadHandler();
   Status WriteHandler(bool just_connected);
 
-  Result<bool> Receive();
+  // Receives data from socket. Sets `drained` when the socket did not have enough data to fill
+  // the read buffer, so the next receive would fail with EAGAIN.
+  Result<bool> Receive(bool* drained);
   // Try to parse received data and process it.
   Result<bool> TryProcessReceived();
 
@@ -118,6 +128,14 @@ class TcpStream : public Stream {
 
   void PopSending();
 
+  // Handles completion of zero copy sends with sequence numbers in [first, last].
+  void ZeroCopyCompleted(uint32_t first, uint32_t last, bool copied);
+  bool IsZeroCopyCompleted(uint32_t seq) const;
+  Status ProcessZeroCopyCompletions();
+  // Makes the socket reset the connection on close, when buffers of zero copy sends could still be
+  // used by the kernel.
+  void ResetIfZeroCopyPending();
+
   // The socket we're communicating on.
   Socket socket_;
 
@@ -152,6 +170,21 @@ class TcpStream : public Stream {
   MemTrackerPtr mem_tracker_;
   scoped_refptr<Counter> bytes_sent_counter_;
   scoped_refptr<Counter> bytes_received_counter_;
+  scoped_refptr<Counter> send_calls_counter_;
+  scoped_refptr<Counter> recv_calls_counter_;
+
+  // Zero copy send state, see FLAGS_tcp_stream_zero_copy_send.
+  bool zero_copy_enabled_ = false;
+  // Sequence number that will be assigned to the next zero copy send.
+  uint32_t zero_copy_next_seq_ = 0;
+  // All zero copy sends with sequence number before this one were completed.
+  uint32_t zero_copy_completed_ = 0;
+  // Completions that arrived before completions of preceding sends, first -> last.
+  std::unordered_map<uint32_t, uint32_t> zero_copy_out_of_order_;
+  // Sent data that could still be read by the kernel, ordered by zero_copy_seq.
+  std::deque<TcpStreamSendingData> zero_copy_pending_;
+  scoped_refptr<Counter> zero_copy_bytes_sent_counter_;
+  scoped_refptr<Counter> zero_copy_fallbacks_counter_;
 };
 
 } // namespace rpc
@@ -13,7 +13,9 @@
 //
 //
 
+#include <algorithm>
 #include <atomic>
+#include <mutex>
 #include <thread>
 
 #include <gtest/gtest.h>
@@ -23,10 +25,12 @@
 
 #include "yb/util/backoff_waiter.h"
 #include "yb/util/countdown_latch.h"
+#include "yb/util/test_thread_holder.h"
 #include "yb/util/test_util.h"
 #include "yb/util/thread.h"
 #include "yb/util/tsan_util.h"
 
+DECLARE_bool(rpc_thread_pool_work_stealing);
 DECLARE_int32(TEST_strand_done_inject_delay_ms);
 
 using namespace std::literals;
@@ -277,6 +281,157 @@ TEST_F(ThreadPoolTest, TestOwns) {
   ASSERT_TRUE(pool.Owns(task.thread()));
 }
 
+TEST_F(ThreadPoolTest, TaskPriorities) {
+  constexpr size_t kTasksPerPriority = 130;
+
+  ThreadPool pool(ThreadPoolOptions {
+    .name = "test",
+    .max_workers = 1,
+  });
+
+  // Block the only worker, so tasks of both priorities are queued before any of them is picked.
+  CountDownLatch started(1);
+  CountDownLatch unblock(1);
+  pool.EnqueueFunctor([&started, &unblock] {
+    started.CountDown();
+    unblock.Wait();
+  });
+  started.Wait();
+
+  std::mutex mutex;
+  std::vector<TaskPriority> executed;
+  CountDownLatch latch(2 * kTasksPerPriority);
+  for (auto priority : {TaskPriority::kLow, TaskPriority::kHigh}) {
+    for (size_t i = 0; i != kTasksPerPriority; ++i) {
+      ASSERT_TRUE(pool.Enqueue(MakeFunctorThreadPoolTask([&mutex, &executed, &latch, priority] {
+        {
+          std::lock_guard lock(mutex);
+          executed.push_back(priority);
+        }
+        latch.CountDown();
+      }), priority));
+    }
+  }
+  unblock.CountDown();
+  latch.Wait();
+
+  std::lock_guard lock(mutex);
+  ASSERT_EQ(executed.size(), 2 * kTasksPerPriority);
+  auto low_in_first_half = std::count(
+      executed.begin(), executed.begin() + kTasksPerPriority, TaskPriority::kLow);
+  LOG(INFO) << "Low priority tasks among first " << kTasksPerPriority << ": "
+            << low_in_first_half;
+  // Low priority tasks were queued first, but should get only a small share of the worker while
+  // high priority tasks are available.
+  ASSERT_LE(low_in_first_half * 4, kTasksPerPriority);
+  ASSERT_GT(low_in_first_half, 0);
+}
+
+// Task that enqueues itself again from the worker, until it is executed the specified number of
+// times.
+class ChainTask final : public ThreadPoolTask {
+ public:
+  ChainTask(ThreadPool* pool, size_t length, CountDownLatch* latch)
+      : pool_(pool), left_(length), latch_(latch) {}
+
+  void Run() override {
+  }
+
+  void Done(const Status& status) override {
+    if (status.ok() && --left_ != 0) {
+      // When enqueue fails, Done is invoked again with failure status.
+      pool_->Enqueue(this);
+      return;
+    }
+    latch_->CountDown();
+  }
+
+ private:
+  ThreadPool* const pool_;
+  size_t left_;
+  CountDownLatch* const latch_;
+};
+
+// Tasks enqueued by a worker go to its own queue, so while that worker is busy they should be
+// executed by other workers.
+TEST_F(ThreadPoolTest, WorkStealing) {
+  constexpr size_t kWorkers = 4;
+  constexpr size_t kTasks = 100;
+  FLAGS_rpc_thread_pool_work_stealing = true;
+  ThreadPool pool(ThreadPoolOptions {
+    .name = "test",
+    .max_workers = kWorkers,
+  });
+
+  CountDownLatch latch(kTasks);
+  std::atomic<size_t> executed_by_busy_worker{0};
+  std::atomic<bool> completed_while_busy{false};
+  CountDownLatch busy_done(1);
+  ASSERT_TRUE(pool.Enqueue(MakeFunctorThreadPoolTask(
+      [&pool, &latch, &executed_by_busy_worker, &completed_while_busy, &busy_done] {
+    auto busy_thread = std::this_thread::get_id();
+    for (size_t i = 0; i != kTasks; ++i) {
+      pool.Enqueue(MakeFunctorThreadPoolTask(
+          [&latch, &executed_by_busy_worker, busy_thread] {
+        if (std::this_thread::get_id() == busy_thread) {
+          ++executed_by_busy_worker;
+        }
+        latch.CountDown();
+      }));
+    }
+    // Keep this worker busy until all tasks from its queue are executed.
+    completed_while_busy = latch.WaitFor(10s * kTimeMultiplier);
+    busy_done.CountDown();
+  })));
+
+  busy_done.Wait();
+  ASSERT_TRUE(completed_while_busy.load());
+  ASSERT_EQ(executed_by_busy_worker.load(), 0);
+  latch.Wait();
+}
+
+// Compares throughput of small tasks with the shared queue and with work stealing, when tasks are
+// enqueued both by external producers (like reactor threads) and by workers themselves.
+// Disabled by default, since it is a benchmark.
+TEST_F(ThreadPoolTest, YB_DISABLE_TEST(Throughput)) {
+  constexpr size_t kProducers = 4;
+  constexpr size_t kChainsPerProducer = 256;
+  constexpr size_t kChainLength = 64;
+  constexpr size_t kTotalChains = kProducers * kChainsPerProducer;
+
+  for (auto work_stealing : {false, true}) {
+    FLAGS_rpc_thread_pool_work_stealing = work_stealing;
+    for (size_t workers = 8; workers <= 128; workers *= 2) {
+      CountDownLatch latch(kTotalChains);
+      std::vector<std::unique_ptr<ChainTask>> tasks;
+      ThreadPool pool(ThreadPoolOptions {
+        .name = "test",
+        .max_workers = workers,
+      });
+      for (size_t i = 0; i != kTotalChains; ++i) {
+        tasks.push_back(std::make_unique<ChainTask>(&pool, kChainLength, &latch));
+      }
+
+      auto start = MonoTime::Now();
+      TestThreadHolder thread_holder;
+      for (size_t i = 0; i != kProducers; ++i) {
+        thread_holder.AddThreadFunctor([&pool, &tasks, i] {
+          CDSAttacher attacher;
+          for (size_t j = i * kChainsPerProducer; j != (i + 1) * kChainsPerProducer; ++j) {
+            ASSERT_TRUE(pool.Enqueue(tasks[j].get()));
+          }
+        });
+      }
+      latch.Wait();
+      auto passed = MonoTime::Now() - start;
+      thread_holder.JoinAll();
+
+      LOG(INFO) << "Work stealing: " << work_stealing << ", workers: " << workers
+                << ", tasks/sec: " << kTotalChains * kChainLength / passed.ToSeconds();
+    }
+  }
+}
+
 namespace strand {
 
 constexpr size_t kPoolMaxTasks = 100;
@@ -15,16 +15,42 @@
 
 #include "yb/rpc/thread_pool.h"
 
+#include <algorithm>
+#include <array>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 
 #include <cds/container/basket_queue.h>
 #include <cds/gc/dhp.h>
 
+#include "yb/gutil/port.h"
+#include "yb/gutil/thread_annotations.h"
+
+#include "yb/util/flags.h"
+#include "yb/util/locks.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status_format.h"
 #include "yb/util/thread.h"
 
+DEFINE_RUNTIME_uint32(rpc_high_priority_task_weight, 8,
+    "Relative share of rpc thread pool workers picking high priority tasks, when tasks of "
+    "different priorities are queued.");
+TAG_FLAG(rpc_high_priority_task_weight, advanced);
+DEFINE_RUNTIME_uint32(rpc_normal_priority_task_weight, 4,
+    "Relative share of rpc thread pool workers picking normal priority tasks, when tasks of "
+    "different priorities are queued.");
+TAG_FLAG(rpc_normal_priority_task_weight, advanced);
+DEFINE_RUNTIME_uint32(rpc_low_priority_task_weight, 1,
+    "Relative share of rpc thread pool workers picking low priority tasks, when tasks of "
+    "different priorities are queued.");
+TAG_FLAG(rpc_low_priority_task_weight, advanced);
+
+DEFINE_NON_RUNTIME_bool(rpc_thread_pool_work_stealing, false,
+    "Keep normal priority tasks of rpc thread pools in per worker queues, with idle workers "
+    "stealing tasks from queues of other workers, instead of a single shared queue.");
+TAG_FLAG(rpc_thread_pool_work_stealing, advanced);
+
 namespace yb {
 namespace rpc {
 
@@ -35,13 +61,175 @@ class Worker;
 typedef cds::container::BasketQueue<cds::gc::DHP, ThreadPoolTask*> TaskQueue;
 typedef cds::container::BasketQueue<cds::gc::DHP, Worker*> WaitingWorkers;
 
+// Queue of normal priority tasks owned by a single worker in work stealing mode.
+// Both the owner and stealing workers pop from the front, so tasks are executed in FIFO order.
+class alignas(CACHELINE_SIZE) LocalTaskQueue {
+ public:
+  void Push(ThreadPoolTask* task) {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(task);
+    size_ = tasks_.size();
+  }
+
+  bool Pop(ThreadPoolTask** task) {
+    // Sequentially consistent accesses to size_ pair with pushing to the waiting workers queue,
+    // so a worker that is going to wait either sees the task or gets notified about it.
+    if (size_ == 0) {
+      return false;
+    }
+    std::lock_guard lock(mutex_);
+    if (tasks_.empty()) {
+      return false;
+    }
+    *task = tasks_.front();
+    tasks_.pop_front();
+    size_ = tasks_.size();
+    return true;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  simple_spinlock mutex_;
+  std::deque<ThreadPoolTask*> tasks_ GUARDED_BY(mutex_);
+  std::atomic<size_t> size_{0};
+};
+
+struct ThreadPoolShare;
+
+// Pool and index of the worker running in the current thread.
+thread_local ThreadPoolShare* current_share = nullptr;
+thread_local size_t current_worker_index = 0;
+
+// Index of the local queue that tasks enqueued by the current non worker thread are pushed to.
+// Assigned once per thread, so a reactor thread keeps feeding the same worker.
+size_t ProducerQueueHint() {
+  static std::atomic<size_t> next_hint{0};
+  thread_local size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+  return hint;
+}
+
 struct ThreadPoolShare {
   ThreadPoolOptions options;
-  TaskQueue task_queue;
+  const bool work_stealing;
+  // Per worker queues of normal priority tasks, used in work stealing mode.
+  std::unique_ptr<LocalTaskQueue[]> local_queues;
+  // Number of started workers, i.e. local queues that are served.
+  std::atomic<size_t> started_workers{0};
+  // Task queue for each priority.
+  std::array<TaskQueue, kTaskPriorityMapSize> task_queues;
+  // Number of queued tasks with priority other than normal. While it is zero, workers just pop
+  // from the normal priority queue.
+  std::atomic<int64_t> prioritized_tasks{0};
+  std::atomic<uint64_t> pop_ticks{0};
   WaitingWorkers waiting_workers;
 
   explicit ThreadPoolShare(ThreadPoolOptions o)
-      : options(std::move(o)) {}
+      : options(std::move(o)), work_stealing(FLAGS_rpc_thread_pool_work_stealing) {
+    if (work_stealing) {
+      local_queues.reset(new LocalTaskQueue[options.max_workers]);
+    }
+  }
+
+  TaskQueue& queue(TaskPriority priority) {
+    return task_queues[to_underlying(priority)];
+  }
+
+  void PushTask(ThreadPoolTask* task, TaskPriority priority) {
+    if (priority != TaskPriority::kNormal) {
+      prioritized_tasks.fetch_add(1, std::memory_order_acq_rel);
+    } else if (work_stealing) {
+      // Task enqueued by a worker stays in its own queue, so it is likely to be executed on the
+      // same CPU.
+      size_t index = current_share == this
+          ? current_worker_index
+          : ProducerQueueHint() % std::max<size_t>(
+                started_workers.load(std::memory_order_acquire), 1);
+      local_queues[index].Push(task);
+      return;
+    }
+    bool added = queue(priority).push(task);
+    DCHECK(added); // BasketQueue always succeed.
+  }
+
+  bool PopTask(ThreadPoolTask** task) {
+    if (prioritized_tasks.load(std::memory_order_acquire) == 0) {
+      return PopNormalTask(task);
+    }
+    auto preferred = PreferredPriority();
+    if (PopTask(preferred, task)) {
+      return true;
+    }
+    for (auto priority : TaskPriorityList()) {
+      if (priority != preferred && PopTask(priority, task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool PopTask(TaskPriority priority, ThreadPoolTask** task) {
+    if (priority == TaskPriority::kNormal) {
+      return PopNormalTask(task);
+    }
+    if (!queue(priority).pop(*task)) {
+      return false;
+    }
+    prioritized_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+  }
+
+  bool PopNormalTask(ThreadPoolTask** task) {
+    if (!work_stealing) {
+      return queue(TaskPriority::kNormal).pop(*task);
+    }
+    // Worker checks its own queue first, then tries to steal from the following ones.
+    auto num_queues = started_workers.load(std::memory_order_acquire);
+    size_t start = current_share == this ? current_worker_index : 0;
+    // Worker could start running before it is accounted in started_workers.
+    num_queues = std::max(num_queues, start + 1);
+    for (size_t i = 0; i != num_queues; ++i) {
+      auto index = start + i;
+      if (index >= num_queues) {
+        index -= num_queues;
+      }
+      if (local_queues[index].Pop(task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Picks priority of the queue that should be checked first, so that when all queues are not
+  // empty, tasks are taken proportionally to priority weights.
+  TaskPriority PreferredPriority() {
+    uint64_t high = std::max<uint32_t>(FLAGS_rpc_high_priority_task_weight, 1);
+    uint64_t normal = std::max<uint32_t>(FLAGS_rpc_normal_priority_task_weight, 1);
+    uint64_t low = std::max<uint32_t>(FLAGS_rpc_low_priority_task_weight, 1);
+    auto tick = pop_ticks.fetch_add(1, std::memory_order_relaxed) % (high + normal + low);
+    if (tick < high) {
+      return TaskPriority::kHigh;
+    }
+    return tick < high + normal ? TaskPriority::kNormal : TaskPriority::kLow;
+  }
+
+  bool Empty() {
+    for (auto& task_queue : task_queues) {
+      if (!task_queue.empty()) {
+        return false;
+      }
+    }
+    if (work_stealing) {
+      for (size_t i = 0; i != options.max_workers; ++i) {
+        if (!local_queues[i].Empty()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
 };
 
 namespace {
@@ -57,6 +245,7 @@ class Worker {
   }
 
   Status Start(size_t index) {
+    index_ = index;
     auto name = strings::Substitute("rpc_tp_$0_$1", share_->options.name, index);
     return yb::Thread::Create(kRpcThreadCategory, name, &Worker::Execute, this, &thread_);
   }
@@ -98,6 +287,8 @@ class Worker {
   // does not have free hands (worker queue empty)
   void Execute() {
     Thread::current_thread()->SetUserData(share_);
+    current_share = share_;
+    current_worker_index = index_;
     while (!stop_requested_) {
       ThreadPoolTask* task = nullptr;
       if (PopTask(&task)) {
@@ -110,7 +301,7 @@ class Worker {
   bool PopTask(ThreadPoolTask** task) {
     // First of all we try to get already queued task, w/o locking.
     // If there is no task, so we could go to waiting state.
-    if (share_->task_queue.pop(*task)) {
+    if (share_->PopTask(task)) {
       return true;
     }
     std::unique_lock<std::mutex> lock(mutex_);
@@ -126,7 +317,7 @@ class Worker {
       // the worker queue. So worker queue could be empty in this case, and nobody was notified
       // about new task. So we check there for this case. This technique is similar to
       // double check.
-      if (share_->task_queue.pop(*task)) {
+      if (share_->PopTask(task)) {
         return true;
       }
 
@@ -134,7 +325,7 @@ class Worker {
 
       // Sometimes another worker could steal task before we wake up. In this case we will
       // just enqueue ourselves back.
-      if (share_->task_queue.pop(*task)) {
+      if (share_->PopTask(task)) {
         return true;
       }
     }
@@ -150,6 +341,7 @@ class Worker {
   }
 
   ThreadPoolShare* share_;
+  size_t index_ = 0;
   scoped_refptr<yb::Thread> thread_;
   std::mutex mutex_;
   std::condition_variable cond_;
@@ -172,15 +364,14 @@ class ThreadPool::Impl {
     return share_.options;
   }
 
-  bool Enqueue(ThreadPoolTask* task) {
+  bool Enqueue(ThreadPoolTask* task, TaskPriority priority) {
     ++adding_;
     if (closing_) {
       --adding_;
       task->Done(shutdown_status_);
       return false;
     }
-    bool added = share_.task_queue.push(task);
-    DCHECK(added); // BasketQueue always succeed.
+    share_.PushTask(task, priority);
     Worker* worker = nullptr;
     while (share_.waiting_workers.pop(worker)) {
       if (worker->Notify()) {
@@ -201,6 +392,7 @@ class ThreadPool::Impl {
         auto status = new_worker->Start(workers_.size());
         if (status.ok()) {
           workers_.push_back(std::move(new_worker));
+          share_.started_workers.store(workers_.size(), std::memory_order_release);
         } else if (workers_.empty()) {
           LOG(FATAL) << "Unable to start first worker: " << status;
         } else {
@@ -219,7 +411,7 @@ class ThreadPool::Impl {
     {
       std::lock_guard<std::mutex> lock(mutex_);
       if (closing_) {
-        CHECK(share_.task_queue.empty());
+        CHECK(share_.Empty());
         CHECK(workers_.empty());
         return;
       }
@@ -238,7 +430,7 @@ class ThreadPool::Impl {
     }
     workers_.clear();
     ThreadPoolTask* task = nullptr;
-    while (share_.task_queue.pop(task)) {
+    while (share_.PopTask(&task)) {
       task->Done(shutdown_status_);
     }
   }
@@ -281,8 +473,8 @@ bool ThreadPool::IsCurrentThreadRpcWorker() {
   return thread != nullptr && thread->category() == kRpcThreadCategory;
 }
 
-bool ThreadPool::Enqueue(ThreadPoolTask* task) {
-  return impl_->Enqueue(task);
+bool ThreadPool::Enqueue(ThreadPoolTask* task, TaskPriority priority) {
+  return impl_->Enqueue(task, priority);
 }
 
 void ThreadPool::Shutdown() {
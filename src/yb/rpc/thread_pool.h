@@ -20,6 +20,7 @@
 
 #include "yb/gutil/port.h"
 
+#include "yb/util/enums.h"
 #include "yb/util/tostring.h"
 
 namespace yb {
@@ -29,6 +30,10 @@ class Thread;
 
 namespace rpc {
 
+// Priority of task in thread pool queue. When tasks of different priorities are queued, workers
+// pick them proportionally to the weights specified by rpc_*_priority_task_weight flags.
+YB_DEFINE_ENUM(TaskPriority, (kHigh)(kNormal)(kLow));
+
 class ThreadPoolTask {
  public:
   // Invoked in thread pool
@@ -97,7 +102,7 @@ class ThreadPool {
 
   const ThreadPoolOptions& options() const;
 
-  bool Enqueue(ThreadPoolTask* task);
+  bool Enqueue(ThreadPoolTask* task, TaskPriority priority = TaskPriority::kNormal);
 
   template <class F>
   void EnqueueFunctor(const F& f) {
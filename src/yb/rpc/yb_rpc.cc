@@ -321,6 +321,10 @@ bool YBInboundCall::DumpPB(const DumpRunningRpcsRequestPB& req,
   }
   resp->set_elapsed_millis(MonoTime::Now().GetDeltaSince(timing_.time_received)
       .ToMilliseconds());
+  auto cpu_time_us = handler_cpu_time().ToMicroseconds();
+  if (cpu_time_us) {
+    resp->set_handler_cpu_time_us(cpu_time_us);
+  }
   return true;
 }
 
@@ -397,6 +401,18 @@ void YBInboundCall::RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code,
   Respond(AnyMessageConstPtr(&err), false);
 }
 
+void YBInboundCall::RespondTooBusy(const Status& status, MonoDelta retry_after) {
+  TRACE_EVENT0("rpc", "InboundCall::RespondTooBusy");
+  ErrorStatusPB err;
+  err.set_message(status.ToString());
+  err.set_code(ErrorStatusPB::ERROR_SERVER_TOO_BUSY);
+  if (retry_after) {
+    err.set_retry_after_ms(static_cast<uint32_t>(retry_after.ToMilliseconds()));
+  }
+
+  Respond(AnyMessageConstPtr(&err), false);
+}
+
 void YBInboundCall::RespondApplicationError(int error_ext_id, const std::string& message,
                                             const MessageLite& app_error_pb) {
   ErrorStatusPB err;
@@ -161,6 +161,9 @@ class YBInboundCall : public InboundCall {
   void RespondFailure(ErrorStatusPB::RpcErrorCodePB error_code,
                       const Status &status) override;
 
+  // Same as RespondFailure with ERROR_SERVER_TOO_BUSY, but also passes retry_after to the client.
+  void RespondTooBusy(const Status& status, MonoDelta retry_after) override;
+
   void RespondApplicationError(int error_ext_id, const std::string& message,
                                const google::protobuf::MessageLite& app_error_pb);
 
@@ -200,12 +203,12 @@ class YBInboundCall : public InboundCall {
   // Serialize and queue the response.
   virtual void Respond(AnyMessageConstPtr response, bool is_success);
 
- private:
   // Serialize a response message for either success or failure. If it is a success,
   // 'response' should be the user-defined response type for the call. If it is a
   // failure, 'response' should be an ErrorStatusPB instance.
   Status SerializeResponseBuffer(AnyMessageConstPtr response, bool is_success);
 
+ private:
   // Returns number of bytes copied.
   size_t CopyToLastSidecarBuffer(const Slice& slice);
   void AllocateSidecarBuffer(size_t size);
@@ -42,6 +42,7 @@
 
 #include "yb/util/atomic.h"
 #include "yb/util/enums.h"
+#include "yb/util/metrics.h"
 #include "yb/util/random_util.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status.h"
@@ -52,6 +53,10 @@ using std::vector;
 
 using yb::server::LogicalClock;
 
+METRIC_DEFINE_entity(test);
+METRIC_DEFINE_coarse_histogram(test, mvcc_in_flight_wait, "MVCC In-Flight Wait",
+                               yb::MetricUnit::kMicroseconds, "");
+
 namespace yb {
 namespace tablet {
 
@@ -367,5 +372,27 @@ TEST_F(MvccTest, WaitForSafeTime) {
   ASSERT_FALSE(manager_.SafeTime(ht3, CoarseMonoClock::now() + 100ms, FixedHybridTimeLease()));
 }
 
+TEST_F(MvccTest, InFlightWaitHistogram) {
+  MetricRegistry registry;
+  auto entity = METRIC_ENTITY_test.Instantiate(&registry, "test");
+  auto histogram = METRIC_mvcc_in_flight_wait.Instantiate(entity);
+  manager_.SetInFlightWaitHistogram(histogram);
+
+  // Nothing in flight, so read does not wait.
+  ASSERT_TRUE(manager_.SafeTime(FixedHybridTimeLease()));
+  ASSERT_EQ(histogram->TotalCount(), 1);
+  ASSERT_EQ(histogram->MaxValueForTests(), 0);
+
+  HybridTime ht = manager_.AddLeaderPending(OpId(1, 1));
+  std::thread replicator([this, ht] {
+    std::this_thread::sleep_for(100ms);
+    manager_.Replicated(ht, OpId(1, 1));
+  });
+  ASSERT_GE(manager_.SafeTime(ht, CoarseTimePoint::max(), FixedHybridTimeLease()), ht);
+  replicator.join();
+  ASSERT_EQ(histogram->TotalCount(), 2);
+  ASSERT_GE(histogram->MaxValueForTests(), 50000);
+}
+
 } // namespace tablet
 } // namespace yb
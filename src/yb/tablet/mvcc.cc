@@ -43,6 +43,8 @@
 #include "yb/util/flags.h"
 #include "yb/util/format.h"
 #include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/trace.h"
 
 using std::ostream;
@@ -565,6 +567,36 @@ HybridTime MvccManager::SafeTime(
   return safe_time;
 }
 
+void MvccManager::SetInFlightWaitHistogram(scoped_refptr<Histogram> histogram) {
+  in_flight_wait_histogram_ = std::move(histogram);
+}
+
+template <class Predicate>
+bool MvccManager::WaitForSafeTime(
+    CoarseTimePoint deadline, std::unique_lock<std::mutex>* lock,
+    const Predicate& predicate) const {
+  if (predicate()) {
+    if (in_flight_wait_histogram_) {
+      in_flight_wait_histogram_->Increment(0);
+    }
+    return true;
+  }
+
+  auto start = MonoTime::Now();
+  bool result = true;
+  if (deadline == CoarseTimePoint::max()) {
+    cond_.wait(*lock, predicate);
+  } else {
+    result = cond_.wait_until(*lock, deadline, predicate);
+  }
+  auto wait_time = MonoTime::Now() - start;
+  TRACE("Waited $0 for in-flight operations, queue size: $1", wait_time.ToString(), queue_.size());
+  if (in_flight_wait_histogram_) {
+    in_flight_wait_histogram_->Increment(wait_time.ToMicroseconds());
+  }
+  return result;
+}
+
 HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
                                       const CoarseTimePoint deadline,
                                       const FixedHybridTimeLease& ht_lease,
@@ -615,9 +647,7 @@ HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
 
   // In the case of an empty queue, the safe hybrid time to read at is only limited by hybrid time
   // ht_lease, which is by definition higher than min_allowed, so we would not get blocked.
-  if (deadline == CoarseTimePoint::max()) {
-    cond_.wait(*lock, predicate);
-  } else if (!cond_.wait_until(*lock, deadline, predicate)) {
+  if (!WaitForSafeTime(deadline, lock, predicate)) {
     return HybridTime::kInvalid;
   }
   VLOG_WITH_PREFIX_AND_FUNC(1)
@@ -35,6 +35,7 @@
 #include <deque>
 #include <vector>
 
+#include "yb/gutil/ref_counted.h"
 #include "yb/gutil/thread_annotations.h"
 
 #include "yb/server/clock.h"
@@ -44,6 +45,9 @@
 #include "yb/util/opid.h"
 
 namespace yb {
+
+class Histogram;
+
 namespace tablet {
 
 // Allows us to keep track of how a particular value of safe time was obtained, for sanity
@@ -146,6 +150,11 @@ class MvccManager {
   // Returns time of last replicated operation.
   HybridTime LastReplicatedHybridTime() const EXCLUDES(mutex_);
 
+  // Sets histogram that receives the time SafeTime spent waiting for in-flight operations to be
+  // replicated. Reads that did not have to wait are recorded with zero duration.
+  // Should be called before the first SafeTime call.
+  void SetInFlightWaitHistogram(scoped_refptr<Histogram> histogram);
+
   class MvccOpTrace;
 
   void TEST_DumpTrace(std::ostream* out);
@@ -166,6 +175,13 @@ class MvccManager {
 
   void AddPending(HybridTime ht, const OpId& op_id, bool is_follower_side) REQUIRES(mutex_);
 
+  // Waits on cond_ until predicate is satisfied. Returns false if deadline passed before that.
+  // Time spent waiting is recorded to in_flight_wait_histogram_.
+  template <class Predicate>
+  bool WaitForSafeTime(
+      CoarseTimePoint deadline, std::unique_lock<std::mutex>* lock,
+      const Predicate& predicate) const REQUIRES(mutex_);
+
   std::string prefix_;
   server::ClockPtr clock_;
   mutable std::mutex mutex_;
@@ -212,6 +228,8 @@ class MvccManager {
   mutable SafeTimeWithSource max_safe_time_returned_for_follower_ { HybridTime::kMin };
 
   std::unique_ptr<MvccOpTrace> op_trace_ GUARDED_BY(mutex_);
+
+  scoped_refptr<Histogram> in_flight_wait_histogram_;
 };
 
 }  // namespace tablet
@@ -33,6 +33,8 @@
 #include "yb/util/flags.h"
 #include "yb/util/lockfree.h"
 #include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/threadpool.h"
 
 DEFINE_UNKNOWN_uint64(max_group_replicate_batch_size, 16,
@@ -41,9 +43,27 @@ DEFINE_UNKNOWN_uint64(max_group_replicate_batch_size, 16,
 DEFINE_UNKNOWN_double(estimated_replicate_msg_size_percentage, 0.95,
               "The estimated percentage of replicate message size in a log entry batch.");
 
+DEFINE_RUNTIME_uint64(transaction_status_group_commit_max_delay_us, 0,
+    "Maximum time the preparer of a transaction status tablet waits for more transaction status "
+    "updates to arrive before replicating a batch consisting only of such updates. Coalescing "
+    "commit, abort and heartbeat updates into one replicated batch reduces the Raft overhead per "
+    "transaction on busy status tablets, at the cost of added latency. 0 disables waiting.");
+TAG_FLAG(transaction_status_group_commit_max_delay_us, advanced);
+
+DEFINE_RUNTIME_uint64(transaction_status_group_commit_max_batch_size, 128,
+    "Maximum number of transaction status updates to submit to consensus for replication in a "
+    "batch when transaction_status_group_commit_max_delay_us is non zero.");
+TAG_FLAG(transaction_status_group_commit_max_batch_size, advanced);
+
 DEFINE_test_flag(int32, preparer_batch_inject_latency_ms, 0,
                  "Inject latency before replicating batch.");
 
+METRIC_DEFINE_coarse_histogram(
+    tablet, transaction_status_update_batch_size, "Transaction Status Update Batch Size",
+    yb::MetricUnit::kOperations,
+    "Number of transaction status updates replicated in one batch by a transaction status tablet "
+    "leader.");
+
 DECLARE_int32(protobuf_message_total_bytes_limit);
 DECLARE_uint64(rpc_max_message_size);
 
@@ -61,7 +81,9 @@ namespace tablet {
 
 class PreparerImpl {
  public:
-  explicit PreparerImpl(consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool);
+  PreparerImpl(
+      consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool, TableType table_type,
+      const MetricEntityPtr& metric_entity);
   ~PreparerImpl();
   Status Start();
   void Stop();
@@ -77,6 +99,13 @@ class PreparerImpl {
 
   consensus::Consensus* const consensus_;
 
+  // Transaction status updates are group committed only by transaction status tablets.
+  // UpdateTxnOperations of participant tablets, e.g. APPLYING and cleanup, are replicated
+  // without waiting for more of them.
+  const bool transaction_status_tablet_;
+
+  scoped_refptr<Histogram> status_update_batch_size_;
+
   // We set this to true to tell the Run function to return. No new tasks will be accepted, but
   // existing tasks will still be processed.
   std::atomic<bool> stop_requested_{false};
@@ -111,6 +140,16 @@ class PreparerImpl {
 
   OperationDrivers leader_side_batch_;
   size_t leader_side_batch_size_estimate_ = 0;
+  // True if leader_side_batch_ contains only transaction status updates of a transaction status
+  // tablet.
+  bool leader_side_batch_status_updates_only_ = true;
+  // Until when to wait for more transaction status updates to group with the current batch.
+  MonoTime group_commit_deadline_;
+  // Used by the prepare thread to wait for new operations during group commit. Submitters notify
+  // the condition only when group_commit_waiting_ is set.
+  std::mutex group_commit_mutex_;
+  std::condition_variable group_commit_cond_;
+  std::atomic<bool> group_commit_waiting_{false};
   const size_t leader_side_batch_size_limit_;
   const size_t leader_side_single_op_size_limit_;
 
@@ -124,6 +163,14 @@ class PreparerImpl {
 
   void ProcessAndClearLeaderSideBatch();
 
+  void NotifyGroupCommitWaiter();
+
+  // Returns true if new operations were submitted while waiting to group them with the current
+  // batch of transaction status updates.
+  bool WaitForGroupCommit();
+
+  size_t MaxLeaderSideBatchSize(bool status_updates_only) const;
+
   void ProcessFailedItem(OperationDriver* item, Status status);
 
   // A wrapper around ProcessAndClearLeaderSideBatch that assumes we are currently holding the
@@ -133,8 +180,11 @@ class PreparerImpl {
                          OperationDrivers::iterator end);
 };
 
-PreparerImpl::PreparerImpl(consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool)
+PreparerImpl::PreparerImpl(
+    consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool, TableType table_type,
+    const MetricEntityPtr& metric_entity)
     : consensus_(consensus),
+      transaction_status_tablet_(table_type == TableType::TRANSACTION_STATUS_TABLE_TYPE),
       // Reserve 5% for other LogEntryBatchPB fields in case of big batches.
       leader_side_batch_size_limit_(
           FLAGS_protobuf_message_total_bytes_limit * FLAGS_estimated_replicate_msg_size_percentage),
@@ -142,6 +192,10 @@ PreparerImpl::PreparerImpl(consensus::Consensus* consensus, ThreadPool* tablet_p
           FLAGS_rpc_max_message_size * FLAGS_estimated_replicate_msg_size_percentage),
       tablet_prepare_pool_token_(tablet_prepare_pool
                                      ->NewToken(ThreadPool::ExecutionMode::SERIAL)) {
+  if (transaction_status_tablet_ && metric_entity) {
+    status_update_batch_size_ =
+        METRIC_transaction_status_update_batch_size.Instantiate(metric_entity);
+  }
 }
 
 PreparerImpl::~PreparerImpl() {
@@ -157,6 +211,7 @@ void PreparerImpl::Stop() {
     return;
   }
   stop_requested_ = true;
+  NotifyGroupCommitWaiter();
   {
     std::unique_lock<std::mutex> stop_lock(stop_mtx_);
     stop_cond_.wait(stop_lock, [this] {
@@ -182,8 +237,9 @@ Status PreparerImpl::Submit(OperationDriver* operation_driver) {
   if (leader_side) {
     // Prepare leader-side operations on the "preparer thread" so we can only acquire the
     // ReplicaState lock once and append multiple operations.
-    active_tasks_.fetch_add(1, std::memory_order_release);
+    active_tasks_.fetch_add(1, std::memory_order_seq_cst);
     queue_.Push(operation_driver);
+    NotifyGroupCommitWaiter();
   } else {
     // For follower-side operations, there would be no benefit in preparing them on the preparer
     // thread.
@@ -208,6 +264,9 @@ void PreparerImpl::Run() {
       active_tasks_.fetch_sub(1, std::memory_order_release);
       ProcessItem(item);
     }
+    if (WaitForGroupCommit()) {
+      continue;
+    }
     ProcessAndClearLeaderSideBatch();
     std::unique_lock<std::mutex> stop_lock(stop_mtx_);
     running_.store(false, std::memory_order_release);
@@ -285,7 +344,10 @@ void PreparerImpl::ProcessItem(OperationDriver* item) {
   // Don't add more than the max number of operations to a batch, and also don't add
   // operations bound to different terms, so as not to fail unrelated operations
   // unnecessarily in case of a bound term mismatch.
-  if (leader_side_batch_.size() >= FLAGS_max_group_replicate_batch_size ||
+  const bool status_update =
+      transaction_status_tablet_ && operation_type == OperationType::kUpdateTransaction;
+  if (leader_side_batch_.size() >=
+          MaxLeaderSideBatchSize(leader_side_batch_status_updates_only_ && status_update) ||
       leader_side_batch_size_estimate_ + item_replicate_msg_size > leader_side_batch_size_limit_ ||
       (!leader_side_batch_.empty() &&
           bound_term != leader_side_batch_.back()->consensus_round()->bound_term())) {
@@ -293,6 +355,8 @@ void PreparerImpl::ProcessItem(OperationDriver* item) {
   }
   leader_side_batch_.push_back(item);
   leader_side_batch_size_estimate_ += item_replicate_msg_size;
+  leader_side_batch_status_updates_only_ =
+      leader_side_batch_status_updates_only_ && status_update;
   if (apply_separately) {
     ProcessAndClearLeaderSideBatch();
   }
@@ -317,6 +381,10 @@ void PreparerImpl::ProcessAndClearLeaderSideBatch() {
           << " leader-side operations, estimated size: " << leader_side_batch_size_estimate_
           << " bytes";
 
+  if (status_update_batch_size_ && leader_side_batch_status_updates_only_) {
+    status_update_batch_size_->Increment(leader_side_batch_.size());
+  }
+
   auto iter = leader_side_batch_.begin();
   auto replication_subbatch_begin = iter;
   auto replication_subbatch_end = iter;
@@ -348,6 +416,52 @@ void PreparerImpl::ProcessAndClearLeaderSideBatch() {
 
   leader_side_batch_.clear();
   leader_side_batch_size_estimate_ = 0;
+  leader_side_batch_status_updates_only_ = true;
+  group_commit_deadline_ = MonoTime();
+}
+
+size_t PreparerImpl::MaxLeaderSideBatchSize(bool status_updates_only) const {
+  if (status_updates_only &&
+      GetAtomicFlag(&FLAGS_transaction_status_group_commit_max_delay_us) > 0) {
+    return std::max<size_t>(
+        GetAtomicFlag(&FLAGS_transaction_status_group_commit_max_batch_size), 1);
+  }
+  return FLAGS_max_group_replicate_batch_size;
+}
+
+bool PreparerImpl::WaitForGroupCommit() {
+  const auto max_delay_us = GetAtomicFlag(&FLAGS_transaction_status_group_commit_max_delay_us);
+  if (max_delay_us == 0 || leader_side_batch_.empty() || !leader_side_batch_status_updates_only_ ||
+      leader_side_batch_.size() >= MaxLeaderSideBatchSize(/* status_updates_only= */ true) ||
+      stop_requested_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  if (!group_commit_deadline_) {
+    group_commit_deadline_ = MonoTime::Now() + MonoDelta::FromMicroseconds(max_delay_us);
+  }
+  // The delay is expected to be short, so we don't release the prepare thread while waiting.
+  // Submitter increments active_tasks_ before checking group_commit_waiting_, and we set
+  // group_commit_waiting_ before checking active_tasks_, so a wakeup cannot be lost.
+  std::unique_lock<std::mutex> lock(group_commit_mutex_);
+  group_commit_waiting_.store(true, std::memory_order_seq_cst);
+  auto result = group_commit_cond_.wait_until(
+      lock, group_commit_deadline_.ToSteadyTimePoint(), [this] {
+        return active_tasks_.load(std::memory_order_seq_cst) > 0 ||
+               stop_requested_.load(std::memory_order_acquire);
+      });
+  group_commit_waiting_.store(false, std::memory_order_release);
+  return result && active_tasks_.load(std::memory_order_acquire) > 0;
+}
+
+void PreparerImpl::NotifyGroupCommitWaiter() {
+  if (!group_commit_waiting_.load(std::memory_order_seq_cst)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(group_commit_mutex_);
+  }
+  group_commit_cond_.notify_one();
 }
 
 void PreparerImpl::ReplicateSubBatch(
@@ -391,8 +505,11 @@ void PreparerImpl::ReplicateSubBatch(
 // ------------------------------------------------------------------------------------------------
 // Preparer
 
-Preparer::Preparer(consensus::Consensus* consensus, ThreadPool* tablet_prepare_thread)
-    : impl_(std::make_unique<PreparerImpl>(consensus, tablet_prepare_thread)) {
+Preparer::Preparer(
+    consensus::Consensus* consensus, ThreadPool* tablet_prepare_thread, TableType table_type,
+    const MetricEntityPtr& metric_entity)
+    : impl_(std::make_unique<PreparerImpl>(
+          consensus, tablet_prepare_thread, table_type, metric_entity)) {
 }
 
 Preparer::~Preparer() = default;
@@ -13,7 +13,10 @@
 
 #pragma once
 
+#include "yb/common/common_types.pb.h"
+
 #include "yb/util/flags.h"
+#include "yb/util/metrics_fwd.h"
 
 #include "yb/util/status_fwd.h"
 #include "yb/util/threadpool.h"
@@ -39,7 +42,11 @@ class PreparerImpl;
 // Preparer does not manage a thread but only submits to a token in a thread pool.
 class Preparer {
  public:
-  explicit Preparer(consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool);
+  // Transaction status updates are group committed only when table_type is
+  // TRANSACTION_STATUS_TABLE_TYPE.
+  Preparer(
+      consensus::Consensus* consensus, ThreadPool* tablet_prepare_pool, TableType table_type,
+      const MetricEntityPtr& metric_entity);
   ~Preparer();
 
   Status Start();
@@ -467,6 +467,7 @@ Tablet::Tablet(const TabletInitData& data)
              : rocksdb::CreateDBStatistics(table_metrics_entity_, nullptr, true));
 
     metrics_.reset(new TabletMetrics(table_metrics_entity_, tablet_metrics_entity_));
+    mvcc_.SetInFlightWaitHistogram(metrics_->snapshot_read_inflight_wait_duration);
 
     mem_tracker_->SetMetricEntity(tablet_metrics_entity_);
   }
@@ -3262,7 +3263,11 @@ Result<HybridTime> Tablet::DoGetSafeTime(
   FixedHybridTimeLease ht_lease;
   if (ht_lease_provider_) {
     // This will block until a leader lease reaches the given value or a timeout occurs.
+    auto start = MonoTime::Now();
     auto ht_lease_result = ht_lease_provider_(min_allowed, deadline);
+    if (metrics_) {
+      metrics_->ht_lease_wait_duration->Increment((MonoTime::Now() - start).ToMicroseconds());
+    }
     if (!ht_lease_result.ok()) {
       if (require_lease == RequireLease::kFallbackToFollower &&
           ht_lease_result.status().IsIllegalState()) {
@@ -55,6 +55,7 @@
 #include "yb/util/tostring.h"
 #include "yb/util/tsan_util.h"
 
+DECLARE_bool(TEST_drop_log_read_ahead);
 DECLARE_bool(skip_flushed_entries);
 DECLARE_int32(retryable_request_timeout_secs);
 
@@ -235,6 +236,7 @@ class BootstrapTest : public LogTestBase {
       .append_pool = log_thread_pool_.get(),
       .allocation_pool = log_thread_pool_.get(),
       .log_sync_pool = log_thread_pool_.get(),
+      .log_read_pool = log_thread_pool_.get(),
       .retryable_requests = nullptr,
       .test_hooks = test_hooks_
     };
@@ -517,6 +519,52 @@ TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   ASSERT_OPID_EQ(last_opid, boot_info.last_committed_id);
 }
 
+// Tests bootstrap of a log with multiple segments, that are read ahead of the replay.
+TEST_F(BootstrapTest, TestBootstrapMultipleSegments) {
+  const int kNumSegments = 5;
+  const int kEntriesPerSegment = 4;
+  BuildLog();
+  for (int i = 0; i < kNumSegments; i++) {
+    for (int j = 0; j < kEntriesPerSegment; j++) {
+      AppendReplicateBatchToLog(1);
+    }
+    ASSERT_OK(RollLog());
+  }
+
+  TabletPtr tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+  OpIdPB last_opid;
+  last_opid.set_term(1);
+  last_opid.set_index(current_index_ - 1);
+  ASSERT_OPID_EQ(last_opid, boot_info.last_id);
+  ASSERT_OPID_EQ(last_opid, boot_info.last_committed_id);
+}
+
+// Tests that bootstrap reads log segments itself when their read ahead tasks are dropped, as it
+// happens when the read ahead pool is shut down.
+TEST_F(BootstrapTest, TestBootstrapDroppedReadAhead) {
+  const int kNumSegments = 3;
+  const int kEntriesPerSegment = 4;
+  BuildLog();
+  for (int i = 0; i < kNumSegments; i++) {
+    for (int j = 0; j < kEntriesPerSegment; j++) {
+      AppendReplicateBatchToLog(1);
+    }
+    ASSERT_OK(RollLog());
+  }
+
+  FLAGS_TEST_drop_log_read_ahead = true;
+  TabletPtr tablet;
+  ConsensusBootstrapInfo boot_info;
+  ASSERT_OK(BootstrapTestTablet(&tablet, &boot_info));
+  OpIdPB last_opid;
+  last_opid.set_term(1);
+  last_opid.set_index(current_index_ - 1);
+  ASSERT_OPID_EQ(last_opid, boot_info.last_id);
+  ASSERT_OPID_EQ(last_opid, boot_info.last_committed_id);
+}
+
 struct BootstrapInputEntry {
   const OpId& op_id() const { return batch_data.op_id; }
 
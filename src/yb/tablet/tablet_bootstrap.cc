@@ -32,6 +32,7 @@
 
 #include "yb/tablet/tablet_bootstrap.h"
 
+#include <future>
 #include <map>
 #include <set>
 
@@ -94,12 +95,14 @@
 #include "yb/util/format.h"
 #include "yb/util/logging.h"
 #include "yb/util/metric_entity.h"
+#include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 #include "yb/util/opid.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status.h"
 #include "yb/util/status_format.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_UNKNOWN_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
@@ -144,6 +147,28 @@ DEFINE_test_flag(bool, dump_docdb_after_tablet_bootstrap, false,
 DEFINE_test_flag(bool, play_pending_uncommitted_entries, false,
                  "Play all the pending entries present in the log even if they are uncommitted.");
 
+DEFINE_test_flag(bool, drop_log_read_ahead, false,
+                 "Drop log segment read ahead tasks without reading, as if their pool was shut "
+                 "down.");
+
+DEFINE_RUNTIME_bool(tablet_bootstrap_read_ahead_log_segments, true,
+                    "Read and verify the next log segment in the background while entries of the "
+                    "current segment are replayed during tablet bootstrap.");
+TAG_FLAG(tablet_bootstrap_read_ahead_log_segments, advanced);
+
+METRIC_DEFINE_gauge_uint64(tablet, log_replay_total_segments,
+                           "Log Replay Total Segments",
+                           yb::MetricUnit::kFiles,
+                           "Number of log segments to be replayed by tablet bootstrap.");
+METRIC_DEFINE_gauge_uint64(tablet, log_replay_replayed_segments,
+                           "Log Replay Replayed Segments",
+                           yb::MetricUnit::kFiles,
+                           "Number of log segments already replayed by tablet bootstrap.");
+METRIC_DEFINE_counter(tablet, log_replay_entries,
+                      "Log Replay Entries",
+                      yb::MetricUnit::kEntries,
+                      "Number of log entries read during log replay by tablet bootstrap.");
+
 namespace yb {
 namespace tablet {
 
@@ -485,6 +510,72 @@ bool WriteOpHasTransaction(const consensus::LWReplicateMsg& replicate) {
   return false;
 }
 
+// Result of reading a log segment ahead. Empty when the read task was dropped without running,
+// e.g. because the pool was shut down.
+using ReadAheadResult = boost::optional<log::ReadEntriesResult>;
+
+class ReadAheadPromise {
+ public:
+  ReadAheadPromise() = default;
+
+  ReadAheadPromise(const ReadAheadPromise&) = delete;
+  void operator=(const ReadAheadPromise&) = delete;
+
+  ~ReadAheadPromise() {
+    if (!set_) {
+      promise_.set_value(boost::none);
+    }
+  }
+
+  std::future<ReadAheadResult> get_future() {
+    return promise_.get_future();
+  }
+
+  void set_value(log::ReadEntriesResult&& result) {
+    promise_.set_value(std::move(result));
+    set_ = true;
+  }
+
+ private:
+  std::promise<ReadAheadResult> promise_;
+  bool set_ = false;
+};
+
+// Reads entries of the log segment. When pool is specified, the segment is read there, so decoding
+// and checksum verification of the segment are done in parallel with replay of the previous one.
+std::future<ReadAheadResult> StartReadingSegment(
+    ThreadPool* pool, const scoped_refptr<ReadableLogSegment>& segment) {
+  auto promise = std::make_shared<ReadAheadPromise>();
+  auto result = promise->get_future();
+  if (pool) {
+    auto status = pool->SubmitFunc([segment, promise] {
+      if (FLAGS_TEST_drop_log_read_ahead) {
+        return;
+      }
+      promise->set_value(segment->ReadEntries());
+    });
+    if (status.ok()) {
+      return result;
+    }
+    LOG(WARNING) << "Failed to read log segment " << segment->path() << " in background: "
+                 << status;
+  }
+  promise->set_value(segment->ReadEntries());
+  return result;
+}
+
+// Waits for the segment read started by StartReadingSegment. Reads the segment in the current
+// thread if the background read was dropped.
+log::ReadEntriesResult WaitSegmentRead(
+    std::future<ReadAheadResult>* future, const scoped_refptr<ReadableLogSegment>& segment) {
+  auto result = future->get();
+  if (result) {
+    return std::move(*result);
+  }
+  LOG(INFO) << "Read ahead of log segment " << segment->path() << " was dropped, reading it now";
+  return segment->ReadEntries();
+}
+
 }  // anonymous namespace
 
 YB_STRONGLY_TYPED_BOOL(NeedsRecovery);
@@ -511,6 +602,7 @@ class TabletBootstrap {
         append_pool_(data.append_pool),
         allocation_pool_(data.allocation_pool),
         log_sync_pool_(data.log_sync_pool),
+        log_read_pool_(data.log_read_pool),
         skip_wal_rewrite_(GetAtomicFlag(&FLAGS_skip_wal_rewrite)),
         test_hooks_(data.test_hooks) {
   }
@@ -1326,13 +1418,33 @@ class TabletBootstrap {
     // Find the earliest log segment we need to read, so the rest can be ignored.
     auto iter = should_skip_flushed_entries ? SkipFlushedEntries(&segments) : segments.begin();
 
+    const auto& metric_entity = tablet_->GetTabletMetricsEntity();
+    scoped_refptr<AtomicGauge<uint64_t>> replayed_segments_metric;
+    scoped_refptr<Counter> replayed_entries_metric;
+    if (metric_entity) {
+      METRIC_log_replay_total_segments.Instantiate(metric_entity, 0)->set_value(
+          segments.end() - iter);
+      replayed_segments_metric = METRIC_log_replay_replayed_segments.Instantiate(metric_entity, 0);
+      replayed_entries_metric = METRIC_log_replay_entries.Instantiate(metric_entity);
+    }
+
+    ThreadPool* read_pool = GetAtomicFlag(&FLAGS_tablet_bootstrap_read_ahead_log_segments)
+        ? log_read_pool_ : nullptr;
+    std::future<ReadAheadResult> next_read_result;
+    if (iter != segments.end()) {
+      next_read_result = StartReadingSegment(read_pool, *iter);
+    }
+
     yb::OpId last_committed_op_id;
     yb::OpId last_read_entry_op_id;
     RestartSafeCoarseTimePoint last_entry_time;
     for (; iter != segments.end(); ++iter) {
       const scoped_refptr<ReadableLogSegment>& segment = *iter;
 
-      auto read_result = segment->ReadEntries();
+      auto read_result = WaitSegmentRead(&next_read_result, segment);
+      if (std::next(iter) != segments.end()) {
+        next_read_result = StartReadingSegment(read_pool, *std::next(iter));
+      }
       last_committed_op_id = std::max(last_committed_op_id, read_result.committed_op_id);
       if (!read_result.entries.empty()) {
         last_read_entry_op_id = yb::OpId::FromPB(read_result.entries.back()->replicate().id());
@@ -1352,6 +1464,9 @@ class TabletBootstrap {
       if (!read_result.entry_metadata.empty()) {
         last_entry_time = read_result.entry_metadata.back().entry_time;
       }
+      if (replayed_entries_metric) {
+        replayed_entries_metric->IncrementBy(read_result.entries.size());
+      }
 
       // If the LogReader failed to read for some reason, we'll still try to replay as many entries
       // as possible, and then fail with Corruption.
@@ -1380,6 +1495,9 @@ class TabletBootstrap {
                   ", last read entry op id: " + last_read_entry_op_id.ToString();
       }
       listener_->StatusMessage(status);
+      if (replayed_segments_metric) {
+        replayed_segments_metric->Increment();
+      }
     }
 
     replay_state_->UpdateCommittedFromStored();
@@ -1706,6 +1824,9 @@ class TabletBootstrap {
   // Thread pool for executing log fsync tasks.
   ThreadPool* log_sync_pool_;
 
+  // Thread pool for reading log segments ahead of the replay.
+  ThreadPool* log_read_pool_;
+
   // Statistics on the replay of entries in the log.
   struct Stats {
     std::string ToString() const;
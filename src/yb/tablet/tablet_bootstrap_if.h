@@ -161,6 +161,9 @@ struct BootstrapTabletData {
   ThreadPool* append_pool = nullptr;
   ThreadPool* allocation_pool = nullptr;
   ThreadPool* log_sync_pool = nullptr;
+  // Pool used to read log segments ahead of the replay. Segments are read by the bootstrapping
+  // thread when it is not specified.
+  ThreadPool* log_read_pool = nullptr;
   consensus::RetryableRequests* retryable_requests = nullptr;
   std::shared_ptr<TabletBootstrapTestHooksIf> test_hooks = nullptr;
   bool bootstrap_retryable_requests = true;
@@ -55,7 +55,14 @@ METRIC_DEFINE_coarse_histogram(table, ql_write_latency, "Write latency at tserve
 METRIC_DEFINE_coarse_histogram(table, snapshot_read_inflight_wait_duration,
   "Time Waiting For Snapshot Reads",
   yb::MetricUnit::kMicroseconds,
-  "Time spent waiting for in-flight writes to complete for READ_AT_SNAPSHOT scans.");
+  "Time spent by reads waiting for in-flight writes to be replicated before the requested "
+  "read time becomes safe.");
+
+METRIC_DEFINE_coarse_histogram(table, ht_lease_wait_duration,
+  "Time Waiting For Hybrid Time Lease",
+  yb::MetricUnit::kMicroseconds,
+  "Time spent by leader reads waiting for the hybrid time leader lease to cover the requested "
+  "read time.");
 
 METRIC_DEFINE_coarse_histogram(
     table, ql_read_latency, "Handle ReadRequest latency at tserver layer",
@@ -135,6 +142,7 @@ namespace tablet {
 TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& table_entity,
                              const scoped_refptr<MetricEntity>& tablet_entity)
   : MINIT(table_entity, snapshot_read_inflight_wait_duration),
+    MINIT(table_entity, ht_lease_wait_duration),
     MINIT(table_entity, ql_read_latency),
     MINIT(table_entity, write_lock_latency),
     MINIT(table_entity, ql_write_latency),
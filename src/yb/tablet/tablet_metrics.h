@@ -54,6 +54,7 @@ struct TabletMetrics {
   // Probe stats
   scoped_refptr<Histogram> commit_wait_duration;
   scoped_refptr<Histogram> snapshot_read_inflight_wait_duration;
+  scoped_refptr<Histogram> ht_lease_wait_duration;
   scoped_refptr<Histogram> ql_read_latency;
   scoped_refptr<Histogram> write_lock_latency;
   scoped_refptr<Histogram> ql_write_latency;
@@ -13,12 +13,17 @@
 
 #include "yb/tablet/transaction_status_resolver.h"
 
+#include <mutex>
+#include <unordered_set>
+
 #include "yb/client/client.h"
 #include "yb/client/meta_cache.h"
 #include "yb/client/transaction_rpc.h"
 
 #include "yb/common/wire_protocol.h"
 
+#include "yb/gutil/thread_annotations.h"
+
 #include "yb/rpc/rpc.h"
 
 #include "yb/tablet/transaction_participant_context.h"
@@ -32,6 +37,11 @@
 #include "yb/util/result.h"
 #include "yb/util/status_format.h"
 
+DEFINE_RUNTIME_uint32(transaction_status_resolver_max_concurrent_requests, 4,
+    "Maximum number of transaction status tablets that a single transaction status resolver "
+    "queries concurrently. Requests to the same status tablet are always sent one at a time.");
+TAG_FLAG(transaction_status_resolver_max_concurrent_requests, advanced);
+
 DEFINE_test_flag(int32, inject_status_resolver_delay_ms, 0,
                  "Inject delay before launching transaction status resolver RPC.");
 
@@ -39,6 +49,10 @@ DEFINE_test_flag(int32, inject_status_resolver_complete_delay_ms, 0,
                  "Inject delay before counting down latch in transaction status resolver "
                  "complete.");
 
+DEFINE_test_flag(int32, status_resolver_fail_responses, 0,
+                 "Number of first transaction status responses received by each transaction "
+                 "status resolver, that should be handled as failures.");
+
 using namespace std::literals;
 using namespace std::placeholders;
 
@@ -51,7 +65,7 @@ class TransactionStatusResolver::Impl {
        int max_transactions_per_request, TransactionStatusResolverCallback callback)
       : participant_context_(*participant_context), rpcs_(*rpcs),
         max_transactions_per_request_(max_transactions_per_request), callback_(std::move(callback)),
-        log_prefix_(participant_context->LogPrefix()), handle_(rpcs_.InvalidHandle()) {}
+        log_prefix_(participant_context->LogPrefix()) {}
 
   ~Impl() {
     LOG_IF_WITH_PREFIX(DFATAL, !closing_.load(std::memory_order_acquire))
@@ -73,7 +87,23 @@ class TransactionStatusResolver::Impl {
 
     deadline_ = deadline;
     run_latch_.Reset(1);
-    Execute();
+
+    // Status tablets are independent, so we resolve up to
+    // FLAGS_transaction_status_resolver_max_concurrent_requests of them in parallel, while still
+    // sending one request at a time to each of them.
+    size_t num_lanes = std::max<size_t>(
+        1, std::min<size_t>(
+               queues_.size(),
+               GetAtomicFlag(&FLAGS_transaction_status_resolver_max_concurrent_requests)));
+    lanes_.clear();
+    lanes_.reserve(num_lanes);
+    for (size_t i = 0; i != num_lanes; ++i) {
+      lanes_.emplace_back(rpcs_.InvalidHandle());
+    }
+    active_lanes_.store(num_lanes, std::memory_order_release);
+    for (auto& lane : lanes_) {
+      Execute(&lane);
+    }
   }
 
   std::future<Status> ResultFuture() {
@@ -90,64 +120,105 @@ class TransactionStatusResolver::Impl {
   }
 
  private:
+  using Queues = std::unordered_map<TabletId, std::deque<TransactionId>>;
+
+  // State of a single sequence of requests. Each lane processes one status tablet at a time.
+  struct Lane {
+    explicit Lane(rpc::Rpcs::Handle handle) : handle(handle) {}
+
+    rpc::Rpcs::Handle handle;
+    Queues::iterator queue;
+    std::vector<TransactionStatusInfo> status_infos;
+  };
+
   const std::string& LogPrefix() const {
     return log_prefix_;
   }
 
-  void Execute() {
+  void Execute(Lane* lane) {
     LOG_IF(DFATAL, !run_latch_.count()) << "Execute while running is false";
 
     if (CoarseMonoClock::now() >= deadline_) {
-      Complete(STATUS(TimedOut, "Timed out to resolve transaction statuses"));
+      Complete(lane, STATUS(TimedOut, "Timed out to resolve transaction statuses"));
       return;
     }
     if (closing_.load(std::memory_order_acquire)) {
-      Complete(STATUS(Aborted, "Aborted because of shutdown"));
+      Complete(lane, STATUS(Aborted, "Aborted because of shutdown"));
       return;
     }
-    if (queues_.empty() || max_transactions_per_request_ <= 0) {
-      Complete(Status::OK());
+    if (max_transactions_per_request_ <= 0) {
+      Complete(lane, Status::OK());
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!failure_.ok()) {
+        lane->queue = queues_.end();
+      } else {
+        lane->queue = std::find_if(queues_.begin(), queues_.end(), [this](const auto& entry) {
+          return !busy_tablets_.contains(entry.first);
+        });
+        if (lane->queue != queues_.end()) {
+          busy_tablets_.insert(lane->queue->first);
+        }
+      }
+    }
+    if (lane->queue == queues_.end()) {
+      // Either there are no more status tablets to process, or each remaining one is being
+      // processed by another lane.
+      Complete(lane, Status::OK());
       return;
     }
 
-    // We access queues_ only while adding transaction and after that while resolving
-    // transaction statuses, which is NOT concurrent.
-    // So we could avoid doing synchronization here.
-    auto& tablet_id_and_queue = *queues_.begin();
     auto client = participant_context_.client_future().get();
     if (!client) {
-      Complete(STATUS(Aborted, "Aborted because cannot start RPC"));
+      ReleaseQueue(lane);
+      Complete(lane, STATUS(Aborted, "Aborted because cannot start RPC"));
+      return;
     }
     client->LookupTabletById(
-        tablet_id_and_queue.first,
+        lane->queue->first,
         nullptr /* table */,
         master::IncludeInactive::kFalse,
         master::IncludeDeleted::kTrue,
         std::min(deadline_, TransactionRpcDeadline()),
-        std::bind(&Impl::LookupTabletDone, this, _1),
+        std::bind(&Impl::LookupTabletDone, this, lane, _1),
         client::UseCache::kTrue);
   }
 
-  void LookupTabletDone(const Result<client::internal::RemoteTabletPtr>& result) {
-    auto& tablet_id_and_queue = *queues_.begin();
-    const auto& tablet_id = tablet_id_and_queue.first;
-    const auto& tablet_queue = tablet_id_and_queue.second;
+  // Returns the status tablet processed by lane to the set of tablets available for processing,
+  // removing it if its queue was fully processed.
+  void ReleaseQueue(Lane* lane) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    busy_tablets_.erase(lane->queue->first);
+    if (lane->queue->second.empty()) {
+      VLOG_WITH_PREFIX(2) << "Processed queue for: " << lane->queue->first;
+      queues_.erase(lane->queue);
+    }
+    lane->queue = queues_.end();
+  }
+
+  void LookupTabletDone(Lane* lane, const Result<client::internal::RemoteTabletPtr>& result) {
+    const auto& tablet_id = lane->queue->first;
+    const auto& tablet_queue = lane->queue->second;
     auto request_size = std::min<size_t>(max_transactions_per_request_, tablet_queue.size());
 
     if (!result.ok()) {
       const auto& status = result.status();
       LOG_WITH_PREFIX(WARNING) << "Failed to request transaction statuses: " << status;
+      ReleaseQueue(lane);
       if (status.IsAborted()) {
-        Complete(status);
+        Complete(lane, status);
       } else {
-        Execute();
+        Execute(lane);
       }
       return;
     }
 
     auto tablet = *result;
     if (!tablet) {
-      HandleTabletDeleted(request_size);
+      HandleTabletDeleted(lane, request_size);
       return;
     }
 
@@ -170,23 +241,24 @@ class TransactionStatusResolver::Impl {
             nullptr /* tablet */,
             client,
             &req,
-            std::bind(&Impl::StatusReceived, this, _1, _2, request_size)),
-        &handle_)) {
-      Complete(STATUS(Aborted, "Aborted because cannot start RPC"));
+            std::bind(&Impl::StatusReceived, this, lane, _1, _2, request_size)),
+        &lane->handle)) {
+      ReleaseQueue(lane);
+      Complete(lane, STATUS(Aborted, "Aborted because cannot start RPC"));
     }
   }
 
-  void HandleTabletDeleted(size_t request_size) {
+  void HandleTabletDeleted(Lane* lane, size_t request_size) {
     VLOG_WITH_PREFIX(2) << "Transaction tablet is deleted";
 
-    auto it = queues_.begin();
-    auto& queue = it->second;
+    auto& queue = lane->queue->second;
     // If the transaction status tablet has been deleted, all unapplied intents referring to it
     // are assumed to be aborted transactions.
-    status_infos_.clear();
-    status_infos_.resize(request_size);
+    auto& status_infos = lane->status_infos;
+    status_infos.clear();
+    status_infos.resize(request_size);
     for (size_t i = 0; i != request_size; ++i) {
-      auto& status_info = status_infos_[i];
+      auto& status_info = status_infos[i];
       status_info.transaction_id = queue.front();
       status_info.status = TransactionStatus::ABORTED;
       status_info.status_ht = HybridTime::kMax;
@@ -195,22 +267,19 @@ class TransactionStatusResolver::Impl {
       queue.pop_front();
     }
 
-    if (queue.empty()) {
-      VLOG_WITH_PREFIX(2) << "Processed queue for: " << it->first;
-      queues_.erase(it);
-    }
-
-    callback_(status_infos_);
+    ReleaseQueue(lane);
+    InvokeCallback(status_infos);
 
-    Execute();
+    Execute(lane);
   }
 
-  void StatusReceived(Status status,
+  void StatusReceived(Lane* lane,
+                      Status status,
                       const tserver::GetTransactionStatusResponsePB& response,
                       int request_size) {
     VLOG_WITH_PREFIX(2) << "Received statuses: " << status << ", " << response.ShortDebugString();
 
-    rpcs_.Unregister(&handle_);
+    rpcs_.Unregister(&lane->handle);
 
     if (status.ok() && response.has_error()) {
       status = StatusFromPB(response.error().status());
@@ -218,35 +287,44 @@ class TransactionStatusResolver::Impl {
 
     if (!status.ok()) {
       LOG_WITH_PREFIX(WARNING) << "Failed to request transaction statuses: " << status;
+      ReleaseQueue(lane);
       if (status.IsAborted()) {
-        Complete(status);
+        Complete(lane, status);
       } else {
-        Execute();
+        Execute(lane);
       }
       return;
     }
 
+    if (num_responses_.fetch_add(1, std::memory_order_acq_rel) <
+            FLAGS_TEST_status_resolver_fail_responses) {
+      ReleaseQueue(lane);
+      Complete(lane, STATUS(IllegalState, "TEST: Injected status resolver failure"));
+      return;
+    }
+
     if (response.has_propagated_hybrid_time()) {
       participant_context_.UpdateClock(HybridTime(response.propagated_hybrid_time()));
     }
 
-    auto it = queues_.begin();
-    auto& queue = it->second;
+    auto& queue = lane->queue->second;
     if ((response.status().size() != 1 && response.status().size() != request_size) ||
         (response.aborted_subtxn_set().size() != 0 && // Old node may not populate these.
             response.aborted_subtxn_set().size() != request_size)) {
       // Node with old software version would always return 1 status.
       LOG_WITH_PREFIX(DFATAL)
           << "Bad response size, expected " << request_size << " entries, but found: "
-          << response.ShortDebugString() << ", queue: " << AsString(queues_);
-      Execute();
+          << response.ShortDebugString() << ", queue: " << AsString(queue);
+      ReleaseQueue(lane);
+      Execute(lane);
       return;
     }
 
-    status_infos_.clear();
-    status_infos_.resize(response.status().size());
+    auto& status_infos = lane->status_infos;
+    status_infos.clear();
+    status_infos.resize(response.status().size());
     for (int i = 0; i != response.status().size(); ++i) {
-      auto& status_info = status_infos_[i];
+      auto& status_info = status_infos[i];
       status_info.transaction_id = queue.front();
       status_info.status = response.status(i);
 
@@ -259,7 +337,8 @@ class TransactionStatusResolver::Impl {
         auto aborted_subtxn_set_or_status = AbortedSubTransactionSet::FromPB(
           response.aborted_subtxn_set(i).set());
         if (!aborted_subtxn_set_or_status.ok()) {
-          Complete(STATUS_FORMAT(
+          ReleaseQueue(lane);
+          Complete(lane, STATUS_FORMAT(
               IllegalState, "Cannot deserialize AbortedSubTransactionSet: $0",
               response.aborted_subtxn_set(i).DebugString()));
           return;
@@ -273,7 +352,8 @@ class TransactionStatusResolver::Impl {
       } else if (status_info.status == TransactionStatus::ABORTED) {
         status_info.status_ht = HybridTime::kMax;
       } else {
-        Complete(STATUS_FORMAT(
+        ReleaseQueue(lane);
+        Complete(lane, STATUS_FORMAT(
             IllegalState, "Missing status hybrid time for transaction status: $0",
             TransactionStatus_Name(status_info.status)));
         return;
@@ -284,19 +364,35 @@ class TransactionStatusResolver::Impl {
       queue.pop_front();
     }
 
-    if (queue.empty()) {
-      VLOG_WITH_PREFIX(2) << "Processed queue for: " << it->first;
-      queues_.erase(it);
-    }
+    ReleaseQueue(lane);
+    InvokeCallback(status_infos);
 
-    callback_(status_infos_);
+    Execute(lane);
+  }
 
-    Execute();
+  // Callback is invoked from multiple lanes, so we serialize calls to it.
+  void InvokeCallback(const std::vector<TransactionStatusInfo>& status_infos) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback_(status_infos);
   }
 
-  void Complete(const Status& status) {
-    VLOG_WITH_PREFIX(2) << "Complete: " << status;
-    result_promise_.set_value(status);
+  // Invoked when lane has finished its work. Resolution is complete when all lanes are done, and
+  // its result is the first failure reported by any lane.
+  void Complete(Lane* lane, const Status& status) {
+    VLOG_WITH_PREFIX(2) << "Complete lane " << lane - lanes_.data() << ": " << status;
+    Status result;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!status.ok() && failure_.ok()) {
+        failure_ = status;
+      }
+      if (active_lanes_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+      }
+      result = failure_;
+    }
+    VLOG_WITH_PREFIX(2) << "Complete: " << result;
+    result_promise_.set_value(result);
     AtomicFlagSleepMs(&FLAGS_TEST_inject_status_resolver_complete_delay_ms);
     run_latch_.CountDown();
   }
@@ -307,13 +403,23 @@ class TransactionStatusResolver::Impl {
   TransactionStatusResolverCallback callback_;
 
   const std::string log_prefix_;
-  rpc::Rpcs::Handle handle_;
 
   std::atomic<bool> closing_{false};
   CountDownLatch run_latch_{0};
   CoarseTimePoint deadline_;
-  std::unordered_map<TabletId, std::deque<TransactionId>> queues_;
-  std::vector<TransactionStatusInfo> status_infos_;
+
+  // queues_ itself is only modified under mutex_ after Start, while the queue of each status
+  // tablet is only accessed by the lane that is processing it.
+  std::mutex mutex_;
+  Queues queues_;
+  std::unordered_set<TabletId> busy_tablets_ GUARDED_BY(mutex_);
+  Status failure_ GUARDED_BY(mutex_);
+
+  std::vector<Lane> lanes_;
+  std::atomic<size_t> active_lanes_{0};
+  std::atomic<int> num_responses_{0};
+
+  std::mutex callback_mutex_;
   std::promise<Status> result_promise_;
 };
 
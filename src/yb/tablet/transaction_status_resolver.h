@@ -43,8 +43,10 @@ using TransactionStatusResolverCallback =
     std::function<void(const std::vector<TransactionStatusInfo>&)>;
 
 // Utility class to resolve status of multiple transactions.
-// It sends one request at a time to avoid generating too much load for transaction status
-// resolution.
+// It sends at most one request at a time to each status tablet, and queries at most
+// FLAGS_transaction_status_resolver_max_concurrent_requests status tablets concurrently, to avoid
+// generating too much load for transaction status resolution.
+// The callback could be invoked from different threads, but invocations never overlap.
 class TransactionStatusResolver {
  public:
   // If max_transactions_per_request is zero then resolution is skipped.
@@ -13,9 +13,12 @@
 
 #include "yb/tserver/pg_client_service.h"
 
+#include <atomic>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 
+#include <boost/container/small_vector.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -34,9 +37,12 @@
 
 #include "yb/master/master_admin.proxy.h"
 
+#include "yb/rpc/constants.h"
 #include "yb/rpc/rpc_context.h"
 #include "yb/rpc/rpc_controller.h"
+#include "yb/rpc/rpc_metrics.h"
 #include "yb/rpc/scheduler.h"
+#include "yb/rpc/yb_rpc.h"
 
 #include "yb/tserver/pg_client_session.h"
 #include "yb/tserver/pg_create_table.h"
@@ -44,20 +50,45 @@
 #include "yb/tserver/pg_table_cache.h"
 #include "yb/tserver/tablet_server_interface.h"
 #include "yb/tserver/tserver_service.pb.h"
+#include "yb/tserver/tserver_shared_mem.h"
 
+#include "yb/util/metrics.h"
 #include "yb/util/net/net_util.h"
 #include "yb/util/result.h"
 #include "yb/util/shared_lock.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/status_format.h"
 #include "yb/util/status_log.h"
 #include "yb/util/status.h"
 #include "yb/util/flags.h"
+#include "yb/util/thread.h"
 
 using namespace std::literals;
+using namespace yb::size_literals;
 
 DEFINE_UNKNOWN_uint64(pg_client_session_expiration_ms, 60000,
               "Pg client session expiration time in milliseconds.");
 
+DEFINE_NON_RUNTIME_bool(pg_client_use_shared_memory, false,
+    "Pass Perform requests of local postgres backends through shared memory instead of TCP.");
+TAG_FLAG(pg_client_use_shared_memory, advanced);
+
+DEFINE_NON_RUNTIME_uint64(pg_client_shared_memory_size, 1_MB,
+    "Size of the shared memory segment created for each postgres backend, when "
+    "pg_client_use_shared_memory is enabled. Bigger requests are sent over TCP, bigger responses "
+    "are passed in chunks.");
+TAG_FLAG(pg_client_shared_memory_size, advanced);
+
+DEFINE_RUNTIME_uint32(pg_client_shared_memory_max_sessions, 256,
+    "Max number of sessions with shared memory exchange, each of them is served by a dedicated "
+    "thread. Other sessions send Perform requests over TCP.");
+TAG_FLAG(pg_client_shared_memory_max_sessions, advanced);
+
+METRIC_DEFINE_counter(server, pg_client_shared_memory_performs,
+                      "PgClientService Shared Memory Performs",
+                      yb::MetricUnit::kRequests,
+                      "Number of Perform requests received through shared memory exchange");
+
 namespace yb {
 namespace tserver {
 
@@ -109,6 +140,120 @@ using LockablePgClientSession = Lockable<PgClientSession>;
 using PgClientSessionLocker = Locker<PgClientSession>;
 using LockablePgClientSessionPtr = std::shared_ptr<LockablePgClientSession>;
 
+std::atomic<uint64_t> next_instance_id{0};
+
+const rpc::RemoteMethod& PerformMethod() {
+  static const rpc::RemoteMethod result("yb.tserver.PgClientService", "Perform");
+  return result;
+}
+
+// Perform call received through the shared exchange. The response is serialized in the same
+// format as for TCP connection, and passed back through the exchange.
+class SharedExchangeInboundCall : public rpc::YBInboundCall {
+ public:
+  SharedExchangeInboundCall(
+      rpc::RpcMetrics* rpc_metrics, std::shared_ptr<SharedExchange> exchange, Slice request)
+      : YBInboundCall(rpc_metrics, PerformMethod()),
+        exchange_(std::move(exchange)),
+        // Request has to be copied, since the exchange buffer is reused for the response.
+        request_(request),
+        deadline_(exchange_->request_timeout()
+            ? CoarseMonoClock::now() + exchange_->request_timeout() : CoarseTimePoint::max()) {
+  }
+
+  const Endpoint& remote_address() const override {
+    static const Endpoint endpoint;
+    return endpoint;
+  }
+
+  const Endpoint& local_address() const override {
+    static const Endpoint endpoint;
+    return endpoint;
+  }
+
+  CoarseTimePoint GetClientDeadline() const override {
+    return deadline_;
+  }
+
+  Status ParseParam(rpc::RpcCallParams* params) override {
+    return ResultToStatus(params->ParseRequest(request_.AsSlice(), request_));
+  }
+
+  size_t ObjectSize() const override { return sizeof(*this); }
+
+ protected:
+  void Respond(AnyMessageConstPtr response, bool is_success) override {
+    auto status = SerializeResponseBuffer(response, is_success);
+    if (PREDICT_FALSE(!status.ok())) {
+      if (is_success) {
+        RespondFailure(rpc::ErrorStatusPB::ERROR_APPLICATION, status);
+      } else {
+        LOG(DFATAL) << "Failed to serialize failure: " << status;
+      }
+      return;
+    }
+
+    boost::container::small_vector<RefCntSlice, 4> blocks;
+    DoSerialize(&blocks);
+    std::vector<Slice> parts;
+    parts.reserve(blocks.size());
+    for (const auto& block : blocks) {
+      parts.push_back(block.AsSlice());
+    }
+    // Total length prefix is only required to split TCP stream into calls.
+    parts.front().remove_prefix(rpc::kMsgLengthPrefixLength);
+    exchange_->Respond(parts);
+  }
+
+ private:
+  std::shared_ptr<SharedExchange> exchange_;
+  RefCntBuffer request_;
+  const CoarseTimePoint deadline_;
+};
+
+// Thread serving requests received through the shared exchange of a particular session.
+class SharedExchangeRunner {
+ public:
+  using Handler = std::function<void(const std::shared_ptr<SharedExchange>&, Slice)>;
+
+  SharedExchangeRunner(std::shared_ptr<SharedExchange> exchange, Handler handler)
+      : exchange_(std::move(exchange)), handler_(std::move(handler)) {
+  }
+
+  ~SharedExchangeRunner() {
+    exchange_->SignalStop();
+    if (thread_) {
+      WARN_NOT_OK(ThreadJoiner(thread_.get()).Join(), "Join shared exchange thread");
+    }
+  }
+
+  Status Start(uint64_t session_id) {
+    return Thread::Create(
+        "pg_client", Format("shmem_$0", session_id), &SharedExchangeRunner::Run, this, &thread_);
+  }
+
+  const std::string& name() const {
+    return exchange_->name();
+  }
+
+ private:
+  void Run() {
+    for (;;) {
+      auto request = exchange_->Poll();
+      if (!request.ok()) {
+        LOG_IF(DFATAL, !request.status().IsShutdownInProgress())
+            << "Poll shared exchange failed: " << request.status();
+        return;
+      }
+      handler_(exchange_, *request);
+    }
+  }
+
+  std::shared_ptr<SharedExchange> exchange_;
+  Handler handler_;
+  scoped_refptr<Thread> thread_;
+};
+
 } // namespace
 
 template <class T>
@@ -180,12 +325,28 @@ class PgClientServiceImpl::Impl {
         table_cache_(client_future),
         check_expired_sessions_(scheduler),
         xcluster_safe_time_map_(xcluster_safe_time_map),
-        response_cache_(metric_entity) {
+        response_cache_(metric_entity),
+        rpc_metrics_(std::make_shared<rpc::RpcMetrics>(metric_entity)),
+        shared_memory_performs_(METRIC_pg_client_shared_memory_performs.Instantiate(metric_entity)),
+        instance_id_(++next_instance_id) {
+    if (FLAGS_pg_client_use_shared_memory) {
+      auto removed = SharedExchange::RemoveStale();
+      if (!removed.ok()) {
+        LOG(WARNING) << "Failed to remove stale shared exchanges: " << removed.status();
+      } else if (*removed) {
+        LOG(INFO) << "Removed " << *removed << " stale shared exchanges";
+      }
+    }
     ScheduleCheckExpiredSessions(CoarseMonoClock::now());
   }
 
   ~Impl() {
     check_expired_sessions_.Shutdown();
+    decltype(exchanges_) exchanges;
+    {
+      std::lock_guard<rw_spinlock> lock(mutex_);
+      exchanges.swap(exchanges_);
+    }
   }
 
   Status Heartbeat(
@@ -200,13 +361,40 @@ class PgClientServiceImpl::Impl {
         xcluster_safe_time_map_, &response_cache_);
     resp->set_session_id(session_id);
 
+    // Declared before the lock, so a rejected exchange is stopped after the lock is released.
+    std::unique_ptr<SharedExchangeRunner> exchange;
+    if (req.use_shared_memory() && FLAGS_pg_client_use_shared_memory &&
+        NumExchanges() < FLAGS_pg_client_shared_memory_max_sessions) {
+      auto exchange_result = StartSharedExchange(session_id);
+      if (exchange_result.ok()) {
+        exchange = std::move(*exchange_result);
+        resp->set_exchange_name(exchange->name());
+      } else {
+        LOG(WARNING) << "Failed to start shared exchange for session " << session_id << ": "
+                     << exchange_result.status();
+      }
+    }
+
     std::lock_guard<rw_spinlock> lock(mutex_);
     auto it = sessions_.emplace(
         FLAGS_pg_client_session_expiration_ms * 1ms, std::move(session)).first;
     session_expiration_queue_.push({it->expiration(), session_id});
+    if (exchange) {
+      // Concurrent heartbeats could start more exchanges than allowed.
+      if (exchanges_.size() < FLAGS_pg_client_shared_memory_max_sessions) {
+        exchanges_.emplace(session_id, std::move(exchange));
+      } else {
+        resp->clear_exchange_name();
+      }
+    }
     return Status::OK();
   }
 
+  size_t NumExchanges() {
+    SharedLock<rw_spinlock> lock(mutex_);
+    return exchanges_.size();
+  }
+
   Status OpenTable(
       const PgOpenTableRequestPB& req, PgOpenTableResponsePB* resp, rpc::RpcContext* context) {
     if (req.invalidate_cache_time_us()) {
@@ -450,6 +638,9 @@ class PgClientServiceImpl::Impl {
 
   void CheckExpiredSessions() {
     auto now = CoarseMonoClock::now();
+    // Exchange threads should be stopped after the mutex is released, since they could wait for
+    // it while performing a request.
+    std::vector<std::unique_ptr<SharedExchangeRunner>> expired_exchanges;
     std::lock_guard<rw_spinlock> lock(mutex_);
     while (!session_expiration_queue_.empty()) {
       auto& top = session_expiration_queue_.top();
@@ -465,6 +656,11 @@ class PgClientServiceImpl::Impl {
           session_expiration_queue_.push({current_expiration, id});
         } else {
           sessions_.erase(it);
+          auto exchange_it = exchanges_.find(id);
+          if (exchange_it != exchanges_.end()) {
+            expired_exchanges.push_back(std::move(exchange_it->second));
+            exchanges_.erase(exchange_it);
+          }
         }
       }
     }
@@ -475,6 +671,32 @@ class PgClientServiceImpl::Impl {
     return VERIFY_RESULT(GetSession(*req))->Perform(req, resp, context);
   }
 
+  Result<std::unique_ptr<SharedExchangeRunner>> StartSharedExchange(uint64_t session_id) {
+    auto exchange = VERIFY_RESULT(SharedExchange::Make(
+        SharedExchange::MakeName(instance_id_, session_id),
+        FLAGS_pg_client_shared_memory_size, Create::kTrue));
+    auto runner = std::make_unique<SharedExchangeRunner>(
+        std::move(exchange),
+        [this](const std::shared_ptr<SharedExchange>& exchange, Slice request) {
+          PerformShared(exchange, request);
+        });
+    RETURN_NOT_OK(runner->Start(session_id));
+    return runner;
+  }
+
+  void PerformShared(const std::shared_ptr<SharedExchange>& exchange, Slice request) {
+    shared_memory_performs_->Increment();
+    auto call = rpc::InboundCall::Create<SharedExchangeInboundCall>(
+        rpc_metrics_.get(), exchange, request);
+    auto params = std::make_shared<
+        rpc::RpcCallPBParamsImpl<PgPerformRequestPB, PgPerformResponsePB>>();
+    rpc::RpcContext context(call, params);
+    if (context.responded()) {
+      return;
+    }
+    Perform(&params->request(), &params->response(), &context);
+  }
+
   const TabletServerIf& tablet_server_;
   std::shared_future<client::YBClient*> client_future_;
   scoped_refptr<ClockBase> clock_;
@@ -515,6 +737,13 @@ class PgClientServiceImpl::Impl {
   const XClusterSafeTimeMap* xcluster_safe_time_map_;
 
   PgResponseCache response_cache_;
+
+  std::shared_ptr<rpc::RpcMetrics> rpc_metrics_;
+  scoped_refptr<Counter> shared_memory_performs_;
+  const uint64_t instance_id_;
+
+  std::unordered_map<uint64_t, std::unique_ptr<SharedExchangeRunner>> exchanges_
+      GUARDED_BY(mutex_);
 };
 
 PgClientServiceImpl::PgClientServiceImpl(
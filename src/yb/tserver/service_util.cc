@@ -205,13 +205,14 @@ Status LeaderTabletPeer::FillTerm() {
 
 Result<LeaderTabletPeer> LookupLeaderTablet(
     TabletPeerLookupIf* tablet_manager,
-    const std::string& tablet_id,
+    const Slice& tablet_id,
     TabletPeerTablet peer) {
   if (peer.tablet_peer) {
-    LOG_IF(DFATAL, peer.tablet_peer->tablet_id() != tablet_id)
+    LOG_IF(DFATAL, tablet_id != peer.tablet_peer->tablet_id())
         << "Mismatching table ids: peer " << peer.tablet_peer->tablet_id()
-        << " vs " << tablet_id;
-    LOG_IF(DFATAL, !peer.tablet) << "Empty tablet pointer for tablet id : " << tablet_id;
+        << " vs " << tablet_id.ToBuffer();
+    LOG_IF(DFATAL, !peer.tablet)
+        << "Empty tablet pointer for tablet id : " << tablet_id.ToBuffer();
   } else {
     peer = VERIFY_RESULT(LookupTabletPeer(tablet_manager, tablet_id));
   }
@@ -204,7 +204,7 @@ struct LeaderTabletPeer {
 
 Result<LeaderTabletPeer> LookupLeaderTablet(
     TabletPeerLookupIf* tablet_manager,
-    const std::string& tablet_id,
+    const Slice& tablet_id,
     TabletPeerTablet peer = TabletPeerTablet());
 
 // The "peer" argument could be provided by the caller in case the caller has already performed
@@ -212,7 +212,7 @@ Result<LeaderTabletPeer> LookupLeaderTablet(
 template<class RespClass>
 LeaderTabletPeer LookupLeaderTabletOrRespond(
     TabletPeerLookupIf* tablet_manager,
-    const std::string& tablet_id,
+    const Slice& tablet_id,
     RespClass* resp,
     rpc::RpcContext* context,
     TabletPeerTablet peer = TabletPeerTablet()) {
@@ -409,7 +409,8 @@ void TabletServer::AutoInitServiceFlags() {
 }
 
 Status TabletServer::RegisterServices() {
-  auto tablet_server_service = std::make_shared<TabletServiceImpl>(this);
+  auto tablet_server_service = std::make_shared<TabletServiceImpl>(
+      this, std::make_shared<TabletServerServiceProxy>(&proxy_cache(), HostPort()));
   tablet_server_service_ = tablet_server_service;
   LOG(INFO) << "yb::tserver::TabletServiceImpl created at " << tablet_server_service.get();
   RETURN_NOT_OK(RpcAndWebServerBase::RegisterService(FLAGS_tablet_server_svc_queue_length,
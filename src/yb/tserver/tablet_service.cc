@@ -62,6 +62,7 @@
 #include "yb/gutil/stringprintf.h"
 #include "yb/gutil/strings/escaping.h"
 
+#include "yb/rpc/rpc_controller.h"
 #include "yb/rpc/sidecars.h"
 #include "yb/rpc/thread_pool.h"
 
@@ -87,6 +88,8 @@
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tserver_error.h"
+#include "yb/tserver/tserver_service.messages.h"
+#include "yb/tserver/tserver_service.proxy.h"
 
 #include "yb/tserver/xcluster_safe_time_map.h"
 #include "yb/util/crc.h"
@@ -163,6 +166,9 @@ TAG_FLAG(index_backfill_wait_for_old_txns_ms, evolving);
 DEFINE_test_flag(double, respond_write_failed_probability, 0.0,
                  "Probability to respond that write request is failed");
 
+DEFINE_test_flag(double, multi_tablet_write_reject_probability, 0.0,
+                 "Probability to not deliver a part of multi tablet write to its tablet.");
+
 DEFINE_test_flag(bool, rpc_delete_tablet_fail, false, "Should delete tablet RPC fail.");
 
 DECLARE_bool(disable_alter_vs_write_mutual_exclusion);
@@ -434,9 +440,11 @@ Result<std::shared_ptr<tablet::AbstractTablet>> TabletServiceImpl::GetTabletForR
                    consistency_level, allow_split_tablet);
 }
 
-TabletServiceImpl::TabletServiceImpl(TabletServerIf* server)
+TabletServiceImpl::TabletServiceImpl(
+    TabletServerIf* server, std::shared_ptr<TabletServerServiceProxy> local_proxy)
     : TabletServerServiceIf(server->MetricEnt()),
-      server_(server) {
+      server_(server),
+      local_proxy_(std::move(local_proxy)) {
 }
 
 TabletServiceAdminImpl::TabletServiceAdminImpl(TabletServer* server)
@@ -1015,8 +1023,8 @@ void TabletServiceImpl::VerifyTableRowRange(
   context.RespondSuccess();
 }
 
-void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
-                                          UpdateTransactionResponsePB* resp,
+void TabletServiceImpl::UpdateTransaction(const LWUpdateTransactionRequestPB* req,
+                                          LWUpdateTransactionResponsePB* resp,
                                           rpc::RpcContext context) {
   TRACE("UpdateTransaction");
 
@@ -1051,7 +1059,15 @@ void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
   }
 
   auto state = std::make_unique<tablet::UpdateTxnOperation>(tablet.tablet);
-  state->AllocateRequest()->CopyFrom(req->state());
+  // The request is parsed into the call arena and refers to the received buffer, so the operation
+  // could use it directly instead of copying. Local calls pass the request of the caller, which
+  // does not outlive the call, so it is copied.
+  if (context.shared_params()) {
+    state->TakeRequest(rpc::SharedField(
+        context.shared_params(), const_cast<tablet::LWTransactionStatePB*>(&req->state())));
+  } else {
+    state->AllocateRequest()->CopyFrom(req->state());
+  }
   state->set_completion_callback(MakeRpcOperationCompletionCallback(
       std::move(context), resp, server_->Clock()));
 
@@ -1842,6 +1858,102 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
   PerformRead(server_, this, req, resp, std::move(context));
 }
 
+namespace {
+
+// State of a MultiTabletWrite call, shared by callbacks of its per tablet writes.
+class MultiTabletWriteState {
+ public:
+  MultiTabletWriteState(MultiTabletWriteResponsePB* resp, rpc::RpcContext context, size_t size)
+      : resp_(resp), context_(std::move(context)), controllers_(size), rejections_(size),
+        pending_(size) {}
+
+  rpc::RpcController* controller(size_t idx) {
+    return &controllers_[idx];
+  }
+
+  // Completes write with specified index without delivering it to the tablet.
+  void Reject(size_t idx, Status status) {
+    rejections_[idx] = std::move(status);
+    WriteDone();
+  }
+
+  void WriteDone() {
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Complete();
+    }
+  }
+
+ private:
+  void Complete() {
+    auto& sidecars = context_.sidecars();
+    for (size_t i = 0; i != controllers_.size(); ++i) {
+      auto idx = narrow_cast<int>(i);
+      auto& controller = controllers_[i];
+      auto status = rejections_[i].ok() ? controller.status() : rejections_[i];
+      if (status.ok()) {
+        // Sidecars are transferred in request order, so sidecars of each response end where
+        // sidecars of the next one start.
+        resp_->set_first_sidecar(
+            idx, narrow_cast<uint32_t>(controller.TransferSidecars(&sidecars)));
+        continue;
+      }
+      // The write was not delivered to the tablet, e.g. because the service queue is full.
+      // Return the original error, so the client sends this write separately and handles the
+      // error as for a regular write.
+      resp_->mutable_responses(idx)->Clear();
+      resp_->set_first_sidecar(idx, narrow_cast<uint32_t>(sidecars.num_sidecars()));
+      auto* failure = resp_->add_failed_requests();
+      failure->set_index(narrow_cast<uint32_t>(i));
+      StatusToPB(status, failure->mutable_status());
+    }
+    resp_->add_first_sidecar(narrow_cast<uint32_t>(sidecars.num_sidecars()));
+    context_.RespondSuccess();
+  }
+
+  MultiTabletWriteResponsePB* const resp_;
+  rpc::RpcContext context_;
+  std::vector<rpc::RpcController> controllers_;
+  std::vector<Status> rejections_;
+  std::atomic<size_t> pending_;
+};
+
+} // namespace
+
+void TabletServiceImpl::MultiTabletWrite(
+    const MultiTabletWriteRequestPB* req, MultiTabletWriteResponsePB* resp,
+    rpc::RpcContext context) {
+  if (!local_proxy_) {
+    context.RespondFailure(STATUS(NotSupported, "Multi tablet write is not supported"));
+    return;
+  }
+  const auto num_requests = req->requests_size();
+  if (num_requests == 0) {
+    context.RespondSuccess();
+    return;
+  }
+
+  // Each write is dispatched through the local service, so it is handled exactly as a separate
+  // Write call, including queueing, tracing and retryable request tracking.
+  const auto deadline = context.GetClientDeadline();
+  for (int i = 0; i != num_requests; ++i) {
+    resp->add_responses();
+    resp->add_first_sidecar(0);
+  }
+  auto state = std::make_shared<MultiTabletWriteState>(resp, std::move(context), num_requests);
+  for (int i = 0; i != num_requests; ++i) {
+    if (RandomActWithProbability(FLAGS_TEST_multi_tablet_write_reject_probability)) {
+      state->Reject(i, STATUS(ServiceUnavailable, "TEST: Multi tablet write part rejected"));
+      continue;
+    }
+    auto* controller = state->controller(i);
+    controller->set_deadline(deadline);
+    local_proxy_->WriteAsync(
+        req->requests(i), resp->mutable_responses(i), controller, [state] {
+      state->WriteDone();
+    });
+  }
+}
+
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
                                            TabletPeerLookupIf* tablet_manager)
     : ConsensusServiceIf(metric_entity),
@@ -71,12 +71,18 @@ class TabletServiceImpl : public TabletServerServiceIf, public ReadTabletProvide
  public:
   typedef std::vector<tablet::TabletPeerPtr> TabletPeers;
 
-  explicit TabletServiceImpl(TabletServerIf* server);
+  // local_proxy is used to dispatch parts of MultiTabletWrite, when not set this call is rejected.
+  explicit TabletServiceImpl(
+      TabletServerIf* server, std::shared_ptr<TabletServerServiceProxy> local_proxy = nullptr);
 
   void Write(const WriteRequestPB* req, WriteResponsePB* resp, rpc::RpcContext context) override;
 
   void Read(const ReadRequestPB* req, ReadResponsePB* resp, rpc::RpcContext context) override;
 
+  void MultiTabletWrite(
+      const MultiTabletWriteRequestPB* req, MultiTabletWriteResponsePB* resp,
+      rpc::RpcContext context) override;
+
   void VerifyTableRowRange(
       const VerifyTableRowRangeRequestPB* req, VerifyTableRowRangeResponsePB* resp,
       rpc::RpcContext context) override;
@@ -111,8 +117,8 @@ class TabletServiceImpl : public TabletServerServiceIf, public ReadTabletProvide
                   ImportDataResponsePB* resp,
                   rpc::RpcContext context) override;
 
-  void UpdateTransaction(const UpdateTransactionRequestPB* req,
-                         UpdateTransactionResponsePB* resp,
+  void UpdateTransaction(const LWUpdateTransactionRequestPB* req,
+                         LWUpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
 
   void GetTransactionStatus(const GetTransactionStatusRequestPB* req,
@@ -192,6 +198,7 @@ class TabletServiceImpl : public TabletServerServiceIf, public ReadTabletProvide
                                                std::shared_ptr<rpc::RpcContext> context);
 
   TabletServerIf *const server_;
+  const std::shared_ptr<TabletServerServiceProxy> local_proxy_;
 };
 
 class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
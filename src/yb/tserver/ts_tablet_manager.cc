@@ -124,6 +124,11 @@ DEFINE_UNKNOWN_int32(num_tablets_to_open_simultaneously, 0,
              "may make sense to manually tune this.");
 TAG_FLAG(num_tablets_to_open_simultaneously, advanced);
 
+DEFINE_NON_RUNTIME_int32(num_tablets_to_open_per_data_dir, 8,
+    "Maximal number of tablets opened simultaneously per data directory, when "
+    "num_tablets_to_open_simultaneously is 0.");
+TAG_FLAG(num_tablets_to_open_per_data_dir, advanced);
+
 DEFINE_UNKNOWN_int32(tablet_start_warn_threshold_ms, 500,
              "If a tablet takes more than this number of millis to start, issue "
              "a warning with a trace.");
@@ -492,7 +497,9 @@ Status TSTabletManager::Init() {
       max_bootstrap_threads = 2;
     } else {
       max_bootstrap_threads = min(
-          num_cpus - 1, narrow_cast<int>(fs_manager_->GetDataRootDirs().size()) * 8);
+          num_cpus - 1,
+          narrow_cast<int>(fs_manager_->GetDataRootDirs().size()) *
+              std::max(FLAGS_num_tablets_to_open_per_data_dir, 1));
     }
     LOG_WITH_PREFIX(INFO) <<  "max_bootstrap_threads=" << max_bootstrap_threads;
   }
@@ -505,6 +512,10 @@ Status TSTabletManager::Init() {
                 .set_max_threads(max_bootstrap_threads)
                 .set_metrics(std::move(bootstrap_metrics))
                 .Build(&open_tablet_pool_));
+  // Each tablet being opened reads at most one log segment ahead of its replay.
+  RETURN_NOT_OK(ThreadPoolBuilder("log-read-ahead")
+                .set_max_threads(max_bootstrap_threads)
+                .Build(&log_read_ahead_pool_));
 
   CleanupCheckpoints();
 
@@ -1558,6 +1569,7 @@ void TSTabletManager::OpenTablet(const RaftGroupMetadataPtr& meta,
       .append_pool = append_pool(),
       .allocation_pool = allocation_pool_.get(),
       .log_sync_pool = log_sync_pool(),
+      .log_read_pool = log_read_ahead_pool_.get(),
       .retryable_requests = &retryable_requests,
       .bootstrap_retryable_requests = bootstrap_retryable_requests,
       .consensus_meta = cmeta.get(),
@@ -1717,6 +1729,9 @@ void TSTabletManager::StartShutdown() {
 
   // Shut down the bootstrap pool, so new tablets are registered after this point.
   open_tablet_pool_->Shutdown();
+  // Tablets opened by remote bootstrap could still be replaying their logs at this point. Read ahead
+  // tasks dropped by the shutdown are handled by bootstrap, that reads such segments itself.
+  log_read_ahead_pool_->Shutdown();
 
   // Take a snapshot of the peers list -- that way we don't have to hold
   // on to the lock while shutting them down, which might cause a lock
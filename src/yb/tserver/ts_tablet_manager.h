@@ -353,6 +353,8 @@ class TSTabletManager : public tserver::TabletPeerLookupIf, public tablet::Table
 
   tablet::TabletOptions* TEST_tablet_options() { return &tablet_options_; }
 
+  consensus::MultiRaftManager* TEST_multi_raft_manager() { return multi_raft_manager_.get(); }
+
   // Trigger asynchronous compactions concurrently on the provided tablets.
   Status TriggerAdminCompactionAndWait(const TabletPtrs& tablets);
 
@@ -584,6 +586,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf, public tablet::Table
   // Thread pool used to open the tablets async, whether bootstrap is required or not.
   std::unique_ptr<ThreadPool> open_tablet_pool_;
 
+  // Thread pool used to read log segments ahead of their replay during tablet bootstrap.
+  std::unique_ptr<ThreadPool> log_read_ahead_pool_;
+
   // Thread pool for preparing transactions, shared between all tablets.
   std::unique_ptr<ThreadPool> tablet_prepare_pool_;
 
@@ -0,0 +1,128 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <thread>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <gtest/gtest.h>
+
+#include "yb/tserver/tserver_shared_mem.h"
+
+#include "yb/util/result.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+
+using namespace std::literals;
+
+namespace yb {
+namespace tserver {
+
+class SharedExchangeTest : public YBTest {
+ protected:
+  std::string ExchangeName() {
+    return Format("yb_test_exchange_$0", getpid());
+  }
+};
+
+TEST_F(SharedExchangeTest, RequestResponse) {
+  constexpr size_t kSize = 4096;
+  auto server = ASSERT_RESULT(SharedExchange::Make(ExchangeName(), kSize, Create::kTrue));
+  auto client = ASSERT_RESULT(SharedExchange::Make(ExchangeName(), 0, Create::kFalse));
+
+  std::thread server_thread([&server] {
+    for (;;) {
+      auto request = server->Poll();
+      if (!request.ok()) {
+        ASSERT_TRUE(request.status().IsShutdownInProgress()) << request.status();
+        break;
+      }
+      // Echo the request, repeated enough times to exceed the segment size.
+      auto repeats = request->ToBuffer() == "big" ? kSize : 1;
+      std::vector<Slice> parts(repeats, *request);
+      server->Respond(parts);
+    }
+  });
+
+  for (const auto& text : {"small"s, "big"s, "another"s}) {
+    auto* out = client->Obtain(text.size());
+    ASSERT_NE(out, nullptr);
+    memcpy(out, text.data(), text.size());
+    client->SendRequest(text.size(), 1s);
+    // Only one request could be in flight.
+    ASSERT_EQ(client->Obtain(text.size()), nullptr);
+
+    auto response = ASSERT_RESULT(client->FetchResponse(CoarseMonoClock::now() + 10s));
+    auto repeats = text == "big" ? kSize : 1;
+    ASSERT_EQ(response.size(), text.size() * repeats);
+    auto left = response.AsSlice();
+    for (size_t i = 0; i != repeats; ++i) {
+      ASSERT_EQ(left.Prefix(text.size()).ToBuffer(), text);
+      left.remove_prefix(text.size());
+    }
+  }
+
+  // Request that does not fit into the segment should go through other channel.
+  ASSERT_EQ(client->Obtain(kSize), nullptr);
+
+  server->SignalStop();
+  server_thread.join();
+}
+
+TEST_F(SharedExchangeTest, Timeout) {
+  auto server = ASSERT_RESULT(SharedExchange::Make(ExchangeName(), 4096, Create::kTrue));
+  auto client = ASSERT_RESULT(SharedExchange::Make(ExchangeName(), 0, Create::kFalse));
+
+  auto* out = client->Obtain(1);
+  ASSERT_NE(out, nullptr);
+  client->SendRequest(1, 100ms);
+  auto response = client->FetchResponse(CoarseMonoClock::now() + 100ms);
+  ASSERT_TRUE(response.status().IsTimedOut()) << response.status();
+  // Exchange in unknown state should not be used anymore.
+  ASSERT_EQ(client->Obtain(1), nullptr);
+}
+
+#if defined(__linux__)
+TEST_F(SharedExchangeTest, RemoveStale) {
+  // Pid of the process that does not exist anymore.
+  auto child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    _exit(0);
+  }
+  ASSERT_EQ(waitpid(child, nullptr, 0), child);
+
+  auto live = ASSERT_RESULT(SharedExchange::Make(
+      SharedExchange::MakeName(1, 1), 4096, Create::kTrue));
+  struct stat st;
+  ASSERT_EQ(stat(("/dev/shm/" + live->name()).c_str(), &st), 0);
+  ASSERT_EQ(st.st_mode & 0777, 0600);
+
+  auto stale_name = Format("yb_pg_exchange_$0_1_1", child);
+  {
+    namespace bi = boost::interprocess;
+    bi::shared_memory_object stale(bi::create_only, stale_name.c_str(), bi::read_write);
+    stale.truncate(4096);
+  }
+
+  ASSERT_GE(ASSERT_RESULT(SharedExchange::RemoveStale()), 1);
+  ASSERT_NOK(SharedExchange::Make(stale_name, 0, Create::kFalse));
+  ASSERT_OK(SharedExchange::Make(live->name(), 0, Create::kFalse));
+}
+#endif
+
+} // namespace tserver
+} // namespace yb
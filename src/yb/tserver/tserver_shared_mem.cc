@@ -0,0 +1,350 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tserver/tserver_shared_mem.h"
+
+#include <signal.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+
+#include "yb/util/cast.h"
+#include "yb/util/env.h"
+#include "yb/util/logging.h"
+#include "yb/util/result.h"
+#include "yb/util/status_format.h"
+
+namespace yb {
+namespace tserver {
+
+namespace bi = boost::interprocess;
+
+namespace {
+
+const std::string kExchangeNamePrefix = "yb_pg_exchange_";
+
+struct SharedExchangeHeader {
+  bi::interprocess_semaphore request_semaphore{0};
+  bi::interprocess_semaphore response_semaphore{0};
+  std::atomic<SharedExchangeState> state{SharedExchangeState::kIdle};
+  uint64_t request_timeout_us = 0;
+  // Size of the request, or of the current response chunk, stored in the data buffer.
+  size_t data_size = 0;
+  // Full size of the response.
+  size_t response_size = 0;
+
+  std::byte* data() {
+    return pointer_cast<std::byte*>(this + 1);
+  }
+};
+
+} // namespace
+
+class SharedExchange::Impl {
+ public:
+  Impl(std::string name, bi::shared_memory_object object, bi::mapped_region region, Create create)
+      : name_(std::move(name)), object_(std::move(object)), region_(std::move(region)),
+        owner_(create), capacity_(region_.get_size() - sizeof(SharedExchangeHeader)) {
+    if (owner_) {
+      new (region_.get_address()) SharedExchangeHeader();
+      LOG_IF(FATAL, !IsAcceptableAtomicImpl(header().state))
+          << "Shared memory atomics must be lock-free";
+    }
+  }
+
+  ~Impl() {
+    if (owner_) {
+      header().~SharedExchangeHeader();
+      bi::shared_memory_object::remove(name_.c_str());
+    }
+  }
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  std::byte* Obtain(size_t required_size) {
+    if (failed_ || required_size > capacity_ ||
+        header().state.load(std::memory_order_acquire) != SharedExchangeState::kIdle) {
+      return nullptr;
+    }
+    return header().data();
+  }
+
+  void SendRequest(size_t size, MonoDelta timeout) {
+    auto& header = this->header();
+    header.data_size = size;
+    header.request_timeout_us = timeout ? timeout.ToMicroseconds() : 0;
+    header.state.store(SharedExchangeState::kRequestSent, std::memory_order_release);
+    header.request_semaphore.post();
+  }
+
+  bool ResponseReady() const {
+    auto state = header().state.load(std::memory_order_acquire);
+    return state == SharedExchangeState::kResponseSent || state == SharedExchangeState::kShutdown;
+  }
+
+  Result<RefCntBuffer> FetchResponse(CoarseTimePoint deadline) {
+    auto& header = this->header();
+    RefCntBuffer result;
+    size_t received = 0;
+    for (;;) {
+      RETURN_NOT_OK(WaitResponse(deadline));
+      if (!result) {
+        result = RefCntBuffer(header.response_size);
+      }
+      auto chunk_size = std::min(header.data_size, result.size() - received);
+      memcpy(result.data() + received, header.data(), chunk_size);
+      received += chunk_size;
+      if (received == result.size()) {
+        break;
+      }
+      header.state.store(SharedExchangeState::kResponseChunkRequested, std::memory_order_release);
+      header.request_semaphore.post();
+    }
+    header.state.store(SharedExchangeState::kIdle, std::memory_order_release);
+    return result;
+  }
+
+  Result<Slice> Poll() {
+    auto& header = this->header();
+    for (;;) {
+      header.request_semaphore.wait();
+      if (stop_.load(std::memory_order_acquire)) {
+        return STATUS_FORMAT(ShutdownInProgress, "Shared exchange $0 stopped", name_);
+      }
+      auto state = header.state.load(std::memory_order_acquire);
+      if (state == SharedExchangeState::kResponseChunkRequested) {
+        SendResponseChunk();
+      } else if (state == SharedExchangeState::kRequestSent) {
+        return Slice(header.data(), std::min(header.data_size, capacity_));
+      } else {
+        LOG(DFATAL) << "Unexpected state of shared exchange " << name_ << ": " << state;
+      }
+    }
+  }
+
+  MonoDelta request_timeout() const {
+    auto timeout_us = header().request_timeout_us;
+    return timeout_us ? MonoDelta::FromMicroseconds(timeout_us) : MonoDelta();
+  }
+
+  void Respond(const std::vector<Slice>& parts) {
+    auto& header = this->header();
+    size_t total_size = 0;
+    for (const auto& part : parts) {
+      total_size += part.size();
+    }
+    header.response_size = total_size;
+
+    if (total_size <= capacity_) {
+      auto* out = header.data();
+      for (const auto& part : parts) {
+        memcpy(out, part.data(), part.size());
+        out += part.size();
+      }
+      header.data_size = total_size;
+      NotifyResponseSent();
+      return;
+    }
+
+    pending_response_ = RefCntBuffer(total_size);
+    pending_response_offset_ = 0;
+    auto* out = pending_response_.data();
+    for (const auto& part : parts) {
+      memcpy(out, part.data(), part.size());
+      out += part.size();
+    }
+    SendResponseChunk();
+  }
+
+  void SignalStop() {
+    stop_.store(true, std::memory_order_release);
+    auto& header = this->header();
+    header.state.store(SharedExchangeState::kShutdown, std::memory_order_release);
+    header.request_semaphore.post();
+    header.response_semaphore.post();
+  }
+
+ private:
+  SharedExchangeHeader& header() const {
+    return *static_cast<SharedExchangeHeader*>(region_.get_address());
+  }
+
+  Status WaitResponse(CoarseTimePoint deadline) {
+    auto& header = this->header();
+    if (deadline == CoarseTimePoint::max()) {
+      header.response_semaphore.wait();
+    } else {
+      auto timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(
+          deadline - CoarseMonoClock::now()).count();
+      auto abs_time = boost::posix_time::microsec_clock::universal_time() +
+                      boost::posix_time::microseconds(std::max<int64_t>(timeout_us, 0));
+      if (!header.response_semaphore.timed_wait(abs_time)) {
+        // The response could still arrive later, so this exchange cannot be used anymore.
+        failed_ = true;
+        return STATUS_FORMAT(TimedOut, "Timed out waiting for response in shared exchange $0",
+                             name_);
+      }
+    }
+    if (header.state.load(std::memory_order_acquire) == SharedExchangeState::kShutdown) {
+      failed_ = true;
+      return STATUS_FORMAT(ShutdownInProgress, "Shared exchange $0 stopped", name_);
+    }
+    return Status::OK();
+  }
+
+  void SendResponseChunk() {
+    auto& header = this->header();
+    auto size = std::min(capacity_, pending_response_.size() - pending_response_offset_);
+    memcpy(header.data(), pending_response_.data() + pending_response_offset_, size);
+    header.data_size = size;
+    pending_response_offset_ += size;
+    if (pending_response_offset_ == pending_response_.size()) {
+      pending_response_.Reset();
+    }
+    NotifyResponseSent();
+  }
+
+  void NotifyResponseSent() {
+    auto& header = this->header();
+    header.state.store(SharedExchangeState::kResponseSent, std::memory_order_release);
+    header.response_semaphore.post();
+  }
+
+  const std::string name_;
+  bi::shared_memory_object object_;
+  bi::mapped_region region_;
+  const bool owner_;
+  const size_t capacity_;
+
+  // Client side, set when the exchange got into an unknown state and should not be used anymore.
+  bool failed_ = false;
+
+  // Tserver side.
+  std::atomic<bool> stop_{false};
+  // Response that did not fit into the segment, and the size of its part already sent.
+  RefCntBuffer pending_response_;
+  size_t pending_response_offset_ = 0;
+};
+
+SharedExchange::SharedExchange(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {
+}
+
+SharedExchange::~SharedExchange() = default;
+
+Result<std::unique_ptr<SharedExchange>> SharedExchange::Make(
+    const std::string& name, size_t size, Create create) {
+  if (create && size <= sizeof(SharedExchangeHeader)) {
+    return STATUS_FORMAT(InvalidArgument, "Too small shared exchange size: $0", size);
+  }
+  try {
+    bi::shared_memory_object object;
+    if (create) {
+      bi::shared_memory_object::remove(name.c_str());
+      // Only backends spawned by the tserver, i.e. running as the same user, should have access.
+      object = bi::shared_memory_object(
+          bi::create_only, name.c_str(), bi::read_write, bi::permissions(0600));
+      object.truncate(size);
+    } else {
+      object = bi::shared_memory_object(bi::open_only, name.c_str(), bi::read_write);
+    }
+    bi::mapped_region region(object, bi::read_write);
+    if (region.get_size() <= sizeof(SharedExchangeHeader)) {
+      return STATUS_FORMAT(Corruption, "Wrong size of shared exchange $0: $1",
+                           name, region.get_size());
+    }
+    return std::unique_ptr<SharedExchange>(new SharedExchange(std::make_unique<Impl>(
+        name, std::move(object), std::move(region), create)));
+  } catch (bi::interprocess_exception& exc) {
+    if (create) {
+      bi::shared_memory_object::remove(name.c_str());
+    }
+    return STATUS_FORMAT(
+        IOError, "Failed to $0 shared exchange $1: $2", create ? "create" : "open", name,
+        exc.what());
+  }
+}
+
+std::string SharedExchange::MakeName(uint64_t instance_id, uint64_t session_id) {
+  return Format("$0$1_$2_$3", kExchangeNamePrefix, getpid(), instance_id, session_id);
+}
+
+Result<size_t> SharedExchange::RemoveStale() {
+#if defined(__linux__)
+  // Named shared memory objects are files in /dev/shm on Linux, while other platforms do not
+  // provide a way to list them.
+  auto names = VERIFY_RESULT(Env::Default()->GetChildren("/dev/shm", ExcludeDots::kTrue));
+  size_t result = 0;
+  for (const auto& name : names) {
+    if (!name.starts_with(kExchangeNamePrefix)) {
+      continue;
+    }
+    char* end = nullptr;
+    auto pid = std::strtoll(name.c_str() + kExchangeNamePrefix.size(), &end, 10);
+    if (pid <= 0 || *end != '_') {
+      continue;
+    }
+    if (kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH) {
+      continue;
+    }
+    if (bi::shared_memory_object::remove(name.c_str())) {
+      ++result;
+    }
+  }
+  return result;
+#else
+  return 0;
+#endif
+}
+
+const std::string& SharedExchange::name() const {
+  return impl_->name();
+}
+
+std::byte* SharedExchange::Obtain(size_t required_size) {
+  return impl_->Obtain(required_size);
+}
+
+void SharedExchange::SendRequest(size_t size, MonoDelta timeout) {
+  impl_->SendRequest(size, timeout);
+}
+
+bool SharedExchange::ResponseReady() const {
+  return impl_->ResponseReady();
+}
+
+Result<RefCntBuffer> SharedExchange::FetchResponse(CoarseTimePoint deadline) {
+  return impl_->FetchResponse(deadline);
+}
+
+Result<Slice> SharedExchange::Poll() {
+  return impl_->Poll();
+}
+
+MonoDelta SharedExchange::request_timeout() const {
+  return impl_->request_timeout();
+}
+
+void SharedExchange::Respond(const std::vector<Slice>& parts) {
+  impl_->Respond(parts);
+}
+
+void SharedExchange::SignalStop() {
+  impl_->SignalStop();
+}
+
+}  // namespace tserver
+}  // namespace yb
@@ -14,14 +14,22 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
 
 #include "yb/tserver/tserver_util_fwd.h"
 
 #include "yb/util/atomic.h"
+#include "yb/util/enums.h"
+#include "yb/util/monotime.h"
 #include "yb/util/net/net_fwd.h"
+#include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/slice.h"
+#include "yb/util/status_fwd.h"
+#include "yb/util/strongly_typed_bool.h"
 
 #include "yb/yql/pggate/ybc_pg_typedefs.h"
 
@@ -96,5 +104,77 @@ class TServerSharedData {
   std::atomic<uint64_t> db_catalog_versions_[kMaxNumDbCatalogVersions] = {0};
 };
 
+YB_STRONGLY_TYPED_BOOL(Create);
+
+YB_DEFINE_ENUM(SharedExchangeState,
+               (kIdle)(kRequestSent)(kResponseSent)(kResponseChunkRequested)(kShutdown));
+
+// Exchange of requests and responses between a postgres backend and the local tserver, through a
+// named shared memory segment. So a local call does not pay for loopback TCP and reactor wakeups.
+//
+// The exchange has a single slot, i.e. at most one request could be in flight. The client writes
+// the request to the buffer returned by Obtain and calls SendRequest, the tserver thread blocked
+// in Poll wakes up, processes the request and passes the response using Respond. Waiting and
+// waking up is done using process shared semaphores, i.e. futexes on Linux.
+//
+// A response that does not fit into the segment is passed in chunks, the client requests the next
+// chunk after copying the previous one.
+class SharedExchange {
+ public:
+  // The tserver creates the segment with the specified name and size, and the client opens it by
+  // name, size is ignored in this case.
+  static Result<std::unique_ptr<SharedExchange>> Make(
+      const std::string& name, size_t size, Create create);
+
+  // Name of the exchange for the specified session, created by the current process.
+  // instance_id distinguishes several tservers running in the same process.
+  static std::string MakeName(uint64_t instance_id, uint64_t session_id);
+
+  // Removes segments of exchanges created by processes that no longer exist, i.e. left by a
+  // crashed tserver. Returns the number of removed segments.
+  static Result<size_t> RemoveStale();
+
+  ~SharedExchange();
+
+  const std::string& name() const;
+
+  // Client side.
+
+  // Returns the buffer for a request of the specified size, or nullptr when the request does not
+  // fit into the segment or another request is in flight.
+  std::byte* Obtain(size_t required_size);
+
+  // Passes the request of the specified size, written to the buffer returned by Obtain, to the
+  // tserver.
+  void SendRequest(size_t size, MonoDelta timeout);
+
+  bool ResponseReady() const;
+
+  // Waits for the response to the sent request and returns its copy.
+  Result<RefCntBuffer> FetchResponse(CoarseTimePoint deadline);
+
+  // Tserver side.
+
+  // Waits for the next request. Returns ShutdownInProgress after SignalStop.
+  // The returned slice is valid until Respond is called.
+  Result<Slice> Poll();
+
+  // Timeout of the request returned by the last Poll.
+  MonoDelta request_timeout() const;
+
+  // Passes the response, consisting of the specified parts, to the client.
+  void Respond(const std::vector<Slice>& parts);
+
+  // Wakes up the thread blocked in Poll and the client waiting for a response.
+  void SignalStop();
+
+ private:
+  class Impl;
+
+  explicit SharedExchange(std::unique_ptr<Impl> impl);
+
+  std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace tserver
 }  // namespace yb
@@ -22,6 +22,7 @@ class SharedMemoryObject;
 
 namespace tserver {
 
+class SharedExchange;
 class TServerSharedData;
 typedef SharedMemoryObject<TServerSharedData> TServerSharedObject;
 
@@ -35,6 +35,10 @@
 #include <netinet/in.h>
 #include <sys/types.h>
 
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
 #include <limits>
 #include <string>
 
@@ -271,6 +275,28 @@ Status Socket::SetReuseAddr(bool flag) {
   return Status::OK();
 }
 
+Status Socket::SetZeroCopy(bool enabled) {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+  int int_flag = enabled ? 1 : 0;
+  if (setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &int_flag, sizeof(int_flag)) == -1) {
+    return STATUS(NetworkError, "Failed to set SO_ZEROCOPY", Errno(errno));
+  }
+  return Status::OK();
+#else
+  return STATUS(NotSupported, "Zero copy send is not supported on this platform");
+#endif
+}
+
+Status Socket::SetLinger(bool enabled, const MonoDelta& timeout) {
+  struct linger value;
+  value.l_onoff = enabled ? 1 : 0;
+  value.l_linger = static_cast<int>(timeout.ToSeconds());
+  if (setsockopt(fd_, SOL_SOCKET, SO_LINGER, &value, sizeof(value)) == -1) {
+    return STATUS(NetworkError, "Failed to set SO_LINGER", Errno(errno));
+  }
+  return Status::OK();
+}
+
 Status Socket::BindAndListen(const Endpoint& sockaddr,
                              int listenQueueSize) {
   RETURN_NOT_OK(SetReuseAddr(true));
@@ -426,7 +452,7 @@ Result<size_t> Socket::Write(const uint8_t *buf, ssize_t amt) {
   return res;
 }
 
-Result<size_t> Socket::Writev(const struct ::iovec *iov, int iov_len) {
+Result<size_t> Socket::Writev(const struct ::iovec *iov, int iov_len, ZeroCopy zero_copy) {
   if (PREDICT_FALSE(iov_len <= 0)) {
     return STATUS(NetworkError,
                   StringPrintf("Writev: invalid io vector length of %d", iov_len),
@@ -438,7 +464,15 @@ Result<size_t> Socket::Writev(const struct ::iovec *iov, int iov_len) {
   memset(&msg, 0, sizeof(struct msghdr));
   msg.msg_iov = const_cast<iovec *>(iov);
   msg.msg_iovlen = iov_len;
-  auto res = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+  int flags = MSG_NOSIGNAL;
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+  if (zero_copy) {
+    flags |= MSG_ZEROCOPY;
+  }
+#else
+  DCHECK(!zero_copy) << "Zero copy send is not supported on this platform";
+#endif
+  auto res = ::sendmsg(fd_, &msg, flags);
   if (PREDICT_FALSE(res < 0)) {
     if (IsTemporarySocketError(errno)) {
       static const Status try_write_again = STATUS(TryAgain, "Write not yet ready");
@@ -450,6 +484,38 @@ Result<size_t> Socket::Writev(const struct ::iovec *iov, int iov_len) {
   return res;
 }
 
+Status Socket::ProcessZeroCopyCompletions(const ZeroCopyCompletionCallback& callback) {
+#if defined(__linux__) && defined(SO_EE_ORIGIN_ZEROCOPY)
+  for (;;) {
+    char control[128];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(struct msghdr));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto res = recvmsg(fd_, &msg, MSG_ERRQUEUE);
+    if (res < 0) {
+      if (IsTemporarySocketError(errno)) {
+        return Status::OK();
+      }
+      return STATUS(NetworkError, "recvmsg error queue error", Errno(errno));
+    }
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      const auto* err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      callback(err->ee_info, err->ee_data, (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+    }
+  }
+#else
+  return Status::OK();
+#endif
+}
+
 // Mostly follows writen() from Stevens (2004) or Kerrisk (2010).
 Status Socket::BlockingWrite(const uint8_t *buf, size_t buflen, const MonoTime& deadline) {
   DCHECK_LE(buflen, std::numeric_limits<int32_t>::max()) << "Writes > INT32_MAX not supported";
@@ -32,6 +32,8 @@
 #pragma once
 
 #include <sys/uio.h>
+
+#include <functional>
 #include <string>
 
 #include <boost/container/small_vector.hpp>
@@ -40,12 +42,19 @@
 
 #include "yb/util/net/sockaddr.h"
 #include "yb/util/status_fwd.h"
+#include "yb/util/strongly_typed_bool.h"
 
 namespace yb {
 
 class MonoDelta;
 class MonoTime;
 
+YB_STRONGLY_TYPED_BOOL(ZeroCopy);
+
+// Called for each range [first, last] of completed zero copy send sequence numbers.
+// `copied` is set when the kernel fell back to copying the data of those sends.
+using ZeroCopyCompletionCallback = std::function<void(uint32_t first, uint32_t last, bool copied)>;
+
 // Vector of io buffers. Could be used with receive, already received data etc.
 typedef boost::container::small_vector<::iovec, 4> IoVecs;
 
@@ -111,6 +120,13 @@ class Socket {
   // Sets SO_REUSEADDR to 'flag'. Should be used prior to Bind().
   Status SetReuseAddr(bool flag);
 
+  // Sets SO_ZEROCOPY, required to call Writev with ZeroCopy::kTrue. Only supported on Linux.
+  Status SetZeroCopy(bool enabled);
+
+  // Sets SO_LINGER. When enabled with zero timeout, Close() resets the connection and drops unsent
+  // data.
+  Status SetLinger(bool enabled, const MonoDelta& timeout);
+
   // Convenience method to invoke the common sequence:
   // 1) SetReuseAddr(true)
   // 2) Bind()
@@ -144,7 +160,14 @@ class Socket {
 
   Result<size_t> Write(const uint8_t *buf, ssize_t amt);
 
-  Result<size_t> Writev(const struct ::iovec *iov, int iov_len);
+  // When zero_copy is set, data is sent with MSG_ZEROCOPY and the caller should keep buffers
+  // alive until the send is reported as completed by ProcessZeroCopyCompletions.
+  // Each successful zero copy send gets the next sequence number, starting from 0.
+  Result<size_t> Writev(
+      const struct ::iovec *iov, int iov_len, ZeroCopy zero_copy = ZeroCopy::kFalse);
+
+  // Reads zero copy send completions from the socket error queue until it is empty.
+  Status ProcessZeroCopyCompletions(const ZeroCopyCompletionCallback& callback);
 
   // Blocking Write call, returns IOError unless full buffer is sent.
   // Underlying Socket expected to be in blocking mode. Fails if any Write() sends 0 bytes.
@@ -21,6 +21,8 @@
 
 #include "yb/gutil/casts.h"
 
+#include "yb/rpc/call_data.h"
+#include "yb/rpc/outbound_call.h"
 #include "yb/rpc/poller.h"
 #include "yb/rpc/rpc_controller.h"
 
@@ -28,6 +30,7 @@
 #include "yb/tserver/pg_client.proxy.h"
 #include "yb/tserver/tserver_shared_mem.h"
 
+#include "yb/util/cast.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/logging.h"
 #include "yb/util/protobuf_util.h"
@@ -61,15 +64,68 @@ namespace {
 // and report it.
 const auto kExtraTimeout = 2s;
 
+std::string PrettyFunctionName(const char* name) {
+  std::string result;
+  for (const char* ch = name; *ch; ++ch) {
+    if (!result.empty() && std::isupper(*ch)) {
+      result += ' ';
+    }
+    result += *ch;
+  }
+  return result;
+}
+
+} // namespace
+
 struct PerformData {
   PgsqlOps operations;
   tserver::LWPgPerformResponsePB resp;
   rpc::RpcController controller;
-  PerformCallback callback;
 
   explicit PerformData(ThreadSafeArena* arena) : resp(arena) {
   }
 
+  PerformResult MakeResult(const Status& status, rpc::CallResponsePtr response) {
+    PerformResult result;
+    result.status = status;
+    result.response = std::move(response);
+    if (result.status.ok()) {
+      result.status = ResponseStatus(resp);
+    }
+    if (result.status.ok()) {
+      result.status = Process();
+    }
+    if (result.status.ok() && resp.has_catalog_read_time()) {
+      result.catalog_read_time = ReadHybridTime::FromPB(resp.catalog_read_time());
+    }
+    return result;
+  }
+
+  // Fetches response from the exchange, it has the same format as response received over TCP.
+  PerformResult FetchResponse(tserver::SharedExchange* exchange, CoarseTimePoint deadline) {
+    auto data = exchange->FetchResponse(deadline);
+    if (!data.ok()) {
+      return MakeResult(data.status(), nullptr);
+    }
+    rpc::CallData call_data(std::move(*data));
+    auto call_response = std::make_shared<rpc::CallResponse>();
+    auto status = call_response->ParseFrom(&call_data);
+    if (status.ok() && !call_response->is_success()) {
+      rpc::ErrorStatusPB error;
+      const auto& serialized = call_response->serialized_response();
+      if (!error.ParseFromArray(serialized.data(), narrow_cast<int>(serialized.size()))) {
+        status = STATUS(Corruption, "Failed to parse error response from shared exchange");
+      } else {
+        status = STATUS(RemoteError, error.message()).CloneAndAddErrorCode(
+            rpc::RpcError(error.code()));
+      }
+    }
+    if (status.ok()) {
+      status = resp.ParseFromSlice(call_response->serialized_response());
+    }
+    return MakeResult(status, std::move(call_response));
+  }
+
   Status Process() {
     auto& responses = *resp.mutable_responses();
     SCHECK_EQ(implicit_cast<size_t>(responses.size()), operations.size(), RuntimeError,
@@ -90,18 +146,45 @@ struct PerformData {
   }
 };
 
-std::string PrettyFunctionName(const char* name) {
-  std::string result;
-  for (const char* ch = name; *ch; ++ch) {
-    if (!result.empty() && std::isupper(*ch)) {
-      result += ' ';
-    }
-    result += *ch;
+PerformExchangeFuture::PerformExchangeFuture(
+    std::shared_ptr<PerformData> data, tserver::SharedExchange* exchange,
+    CoarseTimePoint deadline)
+    : data_(std::move(data)), exchange_(exchange), deadline_(deadline) {
+}
+
+PerformExchangeFuture::PerformExchangeFuture(PerformExchangeFuture&&) = default;
+
+PerformExchangeFuture& PerformExchangeFuture::operator=(PerformExchangeFuture&&) = default;
+
+PerformExchangeFuture::~PerformExchangeFuture() {
+  // Response should be fetched to make the exchange available for the next request.
+  if (valid()) {
+    wait();
   }
-  return result;
 }
 
-} // namespace
+bool PerformExchangeFuture::valid() const {
+  return data_ != nullptr;
+}
+
+bool PerformExchangeFuture::ready() const {
+  return value_ || exchange_->ResponseReady();
+}
+
+void PerformExchangeFuture::wait() {
+  if (!value_) {
+    value_ = data_->FetchResponse(exchange_, deadline_);
+  }
+}
+
+PerformResult PerformExchangeFuture::get() {
+  wait();
+  auto result = std::move(*value_);
+  value_.reset();
+  data_.reset();
+  exchange_ = nullptr;
+  return result;
+}
 
 class PgClient::Impl {
  public:
@@ -133,6 +216,16 @@ class PgClient::Impl {
     Heartbeat(true);
     session_id_ = VERIFY_RESULT(future.get());
     LOG_WITH_PREFIX(INFO) << "Session id acquired. Postgres backend pid: " << getpid();
+    if (!heartbeat_resp_.exchange_name().empty()) {
+      auto exchange = tserver::SharedExchange::Make(
+          heartbeat_resp_.exchange_name(), 0 /* size */, tserver::Create::kFalse);
+      if (exchange.ok()) {
+        exchange_ = std::move(*exchange);
+      } else {
+        LOG_WITH_PREFIX(WARNING) << "Failed to open shared exchange, using TCP: "
+                                 << exchange.status();
+      }
+    }
     heartbeat_poller_.Start(scheduler, FLAGS_pg_client_heartbeat_interval_ms * 1ms);
     return Status::OK();
   }
@@ -153,6 +246,8 @@ class PgClient::Impl {
     tserver::PgHeartbeatRequestPB req;
     if (!create) {
       req.set_session_id(session_id_);
+    } else {
+      req.set_use_shared_memory(true);
     }
     proxy_->HeartbeatAsync(
         req, &heartbeat_resp_, PrepareHeartbeatController(),
@@ -366,10 +461,9 @@ class PgClient::Impl {
     return ResponseStatus(resp);
   }
 
-  void PerformAsync(
+  PerformResultFuture PerformAsync(
       tserver::PgPerformOptionsPB* options,
-      PgsqlOps* operations,
-      const PerformCallback& callback) {
+      PgsqlOps* operations) {
     auto& arena = operations->front()->arena();
     tserver::LWPgPerformRequestPB req(&arena);
     req.set_session_id(session_id_);
@@ -378,24 +472,26 @@ class PgClient::Impl {
 
     auto data = std::make_shared<PerformData>(&arena);
     data->operations = std::move(*operations);
-    data->callback = callback;
-    data->controller.set_invoke_callback_mode(rpc::InvokeCallbackMode::kReactorThread);
 
-    proxy_->PerformAsync(req, &data->resp, SetupController(&data->controller), [data] {
-      PerformResult result;
-      result.status = data->controller.status();
-      result.response = data->controller.response();
-      if (result.status.ok()) {
-        result.status = ResponseStatus(data->resp);
-      }
-      if (result.status.ok()) {
-        result.status = data->Process();
-      }
-      if (result.status.ok() && data->resp.has_catalog_read_time()) {
-        result.catalog_read_time = ReadHybridTime::FromPB(data->resp.catalog_read_time());
+    if (exchange_) {
+      // Only one request could be in flight through the exchange, others are sent over TCP.
+      auto size = req.SerializedSize();
+      auto* out = exchange_->Obtain(size);
+      if (out) {
+        req.SerializeToArray(pointer_cast<uint8_t*>(out));
+        exchange_->SendRequest(size, timeout_);
+        return PerformExchangeFuture(
+            std::move(data), exchange_.get(), CoarseMonoClock::now() + timeout_);
       }
-      data->callback(result);
+    }
+
+    auto promise = std::make_shared<std::promise<PerformResult>>();
+    data->controller.set_invoke_callback_mode(rpc::InvokeCallbackMode::kReactorThread);
+    proxy_->PerformAsync(req, &data->resp, SetupController(&data->controller), [data, promise] {
+      promise->set_value(data->MakeResult(
+          data->controller.status(), data->controller.response()));
     });
+    return promise->get_future();
   }
 
   void PrepareOperations(tserver::LWPgPerformRequestPB* req, PgsqlOps* operations) {
@@ -603,6 +699,7 @@ class PgClient::Impl {
   std::unique_ptr<tserver::PgClientServiceProxy> proxy_;
   rpc::RpcController controller_;
   uint64_t session_id_ = 0;
+  std::unique_ptr<tserver::SharedExchange> exchange_;
 
   rpc::Poller heartbeat_poller_;
   std::atomic<bool> heartbeat_running_{false};
@@ -739,11 +836,10 @@ Status PgClient::DeleteDBSequences(int64_t db_oid) {
   return impl_->DeleteDBSequences(db_oid);
 }
 
-void PgClient::PerformAsync(
+PerformResultFuture PgClient::PerformAsync(
     tserver::PgPerformOptionsPB* options,
-    PgsqlOps* operations,
-    const PerformCallback& callback) {
-  impl_->PerformAsync(options, operations, callback);
+    PgsqlOps* operations) {
+  return impl_->PerformAsync(options, operations);
 }
 
 Result<bool> PgClient::CheckIfPitrActive() {
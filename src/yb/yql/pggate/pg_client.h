@@ -13,9 +13,11 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
+#include <variant>
 
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/version.hpp>
@@ -57,7 +59,35 @@ struct PerformResult {
   }
 };
 
-using PerformCallback = std::function<void(const PerformResult&)>;
+struct PerformData;
+
+// Future for the result of Perform sent through the shared memory exchange. The response is
+// fetched by the thread waiting for the result, so no extra thread is woken up.
+class PerformExchangeFuture {
+ public:
+  PerformExchangeFuture() = default;
+  PerformExchangeFuture(
+      std::shared_ptr<PerformData> data, tserver::SharedExchange* exchange,
+      CoarseTimePoint deadline);
+
+  PerformExchangeFuture(PerformExchangeFuture&&);
+  PerformExchangeFuture& operator=(PerformExchangeFuture&&);
+
+  ~PerformExchangeFuture();
+
+  bool valid() const;
+  bool ready() const;
+  void wait();
+  PerformResult get();
+
+ private:
+  std::shared_ptr<PerformData> data_;
+  tserver::SharedExchange* exchange_ = nullptr;
+  CoarseTimePoint deadline_;
+  std::optional<PerformResult> value_;
+};
+
+using PerformResultFuture = std::variant<std::future<PerformResult>, PerformExchangeFuture>;
 
 class PgClient {
  public:
@@ -128,10 +158,9 @@ class PgClient {
 
   Status DeleteDBSequences(int64_t db_oid);
 
-  void PerformAsync(
+  PerformResultFuture PerformAsync(
       tserver::PgPerformOptionsPB* options,
-      PgsqlOps* operations,
-      const PerformCallback& callback);
+      PgsqlOps* operations);
 
   Result<bool> CheckIfPitrActive();
 
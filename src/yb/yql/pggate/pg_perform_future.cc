@@ -43,10 +43,18 @@ Status PatchStatus(const Status& status, const PgObjectIds& relations) {
   return status;
 }
 
+bool IsReady(const std::future<PerformResult>& future) {
+  return future.wait_for(0ms) == std::future_status::ready;
+}
+
+bool IsReady(const PerformExchangeFuture& future) {
+  return future.ready();
+}
+
 } // namespace
 
 PerformFuture::PerformFuture(
-    std::future<PerformResult> future, PgSession* session, PgObjectIds&& relations)
+    PerformResultFuture future, PgSession* session, PgObjectIds&& relations)
     : future_(std::move(future)), session_(session), relations_(std::move(relations)) {
 }
 
@@ -55,23 +63,23 @@ PerformFuture::~PerformFuture() {
     // In case object is valid nobody got the result from it.
     // This is possible in case of error handling. Transaction will be rolled back in this case.
     // We have to be sure that all requests are completed before performing rollback.
-    future_.wait();
+    std::visit([](auto& future) { future.wait(); }, future_);
   }
 }
 
 bool PerformFuture::Valid() const {
-  return future_.valid();
+  return std::visit([](const auto& future) { return future.valid(); }, future_);
 }
 
 bool PerformFuture::Ready() const {
-  return Valid() && future_.wait_for(0ms) == std::future_status::ready;
+  return Valid() && std::visit([](const auto& future) { return IsReady(future); }, future_);
 }
 
 Result<rpc::CallResponsePtr> PerformFuture::Get() {
   // Make sure Valid method will return false before thread will be blocked on call future.get()
   // This requirement is not necessary after fixing of #12884.
   auto future = std::move(future_);
-  auto result = future.get();
+  auto result = std::visit([](auto& future) { return future.get(); }, future);
   RETURN_NOT_OK(PatchStatus(result.status, relations_));
   session_->TrySetCatalogReadPoint(result.catalog_read_time);
   return result.response;
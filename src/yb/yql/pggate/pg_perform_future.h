@@ -29,7 +29,7 @@ class PgSession;
 class PerformFuture {
  public:
   PerformFuture() = default;
-  PerformFuture(std::future<PerformResult> future, PgSession* session, PgObjectIds&& relations);
+  PerformFuture(PerformResultFuture future, PgSession* session, PgObjectIds&& relations);
   PerformFuture(PerformFuture&&) = default;
   PerformFuture& operator=(PerformFuture&&) = default;
   ~PerformFuture();
@@ -40,7 +40,7 @@ class PerformFuture {
   Result<rpc::CallResponsePtr> Get(MonoDelta* wait_time);
 
  private:
-  std::future<PerformResult> future_;
+  PerformResultFuture future_;
   PgSession* session_ = nullptr;
   PgObjectIds relations_;
 };
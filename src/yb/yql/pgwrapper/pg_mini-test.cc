@@ -43,10 +43,14 @@
 
 #include "yb/tools/tools_test_utils.h"
 
+#include "yb/tserver/mini_tablet_server.h"
+#include "yb/tserver/tablet_server.h"
+
 #include "yb/util/atomic.h"
 #include "yb/util/backoff_waiter.h"
 #include "yb/util/debug-util.h"
 #include "yb/util/enums.h"
+#include "yb/util/metrics.h"
 #include "yb/util/random_util.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status_log.h"
@@ -62,10 +66,13 @@ using std::string;
 
 using namespace std::literals;
 
+METRIC_DECLARE_counter(pg_client_shared_memory_performs);
+
 DECLARE_bool(TEST_force_master_leader_resolution);
 DECLARE_bool(TEST_timeout_non_leader_master_rpcs);
 DECLARE_bool(enable_automatic_tablet_splitting);
 DECLARE_bool(flush_rocksdb_on_shutdown);
+DECLARE_bool(pg_client_use_shared_memory);
 DECLARE_bool(rocksdb_use_logging_iterator);
 
 DECLARE_double(TEST_respond_write_failed_probability);
@@ -93,6 +100,7 @@ DECLARE_int64(tablet_split_low_phase_shard_count_per_node);
 DECLARE_int64(tablet_split_low_phase_size_threshold_bytes);
 
 DECLARE_uint64(max_clock_skew_usec);
+DECLARE_uint64(pg_client_shared_memory_size);
 
 DECLARE_bool(ysql_enable_packed_row);
 DECLARE_bool(ysql_enable_packed_row_for_colocated_table);
@@ -474,6 +482,41 @@ TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(Simple)) {
   ASSERT_EQ(value, "hello");
 }
 
+class PgMiniSharedMemoryTest : public PgMiniSingleTServerTest {
+ protected:
+  void SetUp() override {
+    FLAGS_pg_client_use_shared_memory = true;
+    // Small segment, so big responses are passed in chunks and big requests are sent over TCP.
+    FLAGS_pg_client_shared_memory_size = 4_KB;
+    PgMiniSingleTServerTest::SetUp();
+  }
+};
+
+TEST_F_EX(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(SharedMemory), PgMiniSharedMemoryTest) {
+  constexpr int kRows = 1000;
+  MetricWatcher performs_watcher(
+      *cluster_->mini_tablet_server(0)->server(), METRIC_pg_client_shared_memory_performs);
+
+  auto conn = ASSERT_RESULT(Connect());
+  auto performs = ASSERT_RESULT(performs_watcher.Delta([&conn]() -> Status {
+    RETURN_NOT_OK(conn.Execute("CREATE TABLE t (key INT PRIMARY KEY, value TEXT)"));
+    RETURN_NOT_OK(conn.ExecuteFormat(
+        "INSERT INTO t SELECT i, repeat('x', i % 100) FROM generate_series(1, $0) AS i", kRows));
+    RETURN_NOT_OK(conn.Execute("UPDATE t SET value = 'hello' WHERE key = 1"));
+    auto value = VERIFY_RESULT(conn.FetchValue<std::string>("SELECT value FROM t WHERE key = 1"));
+    SCHECK_EQ(value, "hello", IllegalState, "Wrong value");
+    auto count = VERIFY_RESULT(conn.FetchValue<int64_t>("SELECT COUNT(*) FROM t"));
+    SCHECK_EQ(count, kRows, IllegalState, "Wrong number of rows");
+    // Rows are fetched by postgres in responses that do not fit into the segment.
+    auto values = VERIFY_RESULT(conn.FetchValue<std::string>(
+        "SELECT string_agg(value, '' ORDER BY key) FROM t"));
+    // Sum of key % 100 over all keys, with the value of key 1 replaced by 'hello'.
+    SCHECK_EQ(values.size(), size_t{49500 - 1 + 5}, IllegalState, "Wrong total length of values");
+    return Status::OK();
+  }));
+  ASSERT_GT(performs, 0);
+}
+
 TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(RowLockWithoutTransaction)) {
   auto conn = ASSERT_RESULT(Connect());
 
@@ -1434,6 +1477,38 @@ TEST_F_EX(PgMiniTest,
   TestRowKeyShareLock("cur_name");
 }
 
+// Check that a serializable read restricting leading range columns to a single value locks only
+// rows with this key prefix, including the case when the prefix contains a collated column.
+TEST_F_EX(PgMiniTest,
+          YB_DISABLE_TEST_IN_TSAN(SerializableReadSingleValueRangePrefix),
+          PgMiniTestTxnHelperSerializable) {
+  auto conn = ASSERT_RESULT(SetHighPriTxn(Connect()));
+  auto extra_conn = ASSERT_RESULT(SetLowPriTxn(Connect()));
+
+  ASSERT_OK(conn.Execute(
+      "CREATE TABLE t (h INT, r1 TEXT COLLATE \"en-US-x-icu\", r2 INT, v INT, "
+      "PRIMARY KEY(h HASH, r1 ASC, r2 ASC))"));
+  ASSERT_OK(conn.Execute("INSERT INTO t VALUES (1, 'a', 1, 1), (1, 'b', 1, 1), (2, 'a', 1, 1)"));
+
+  // The read takes a strong read intent on the (1, 'a') prefix only.
+  ASSERT_OK(StartTxn(&conn));
+  ASSERT_OK(conn.Fetch("SELECT * FROM t WHERE h = 1 AND r1 = 'a' AND r2 >= 1"));
+
+  // Writes within the prefix conflict with the read.
+  ASSERT_NOK(ExecuteInTxn(&extra_conn, "INSERT INTO t VALUES (1, 'a', 5, 5)"));
+  ASSERT_NOK(ExecuteInTxn(&extra_conn, "UPDATE t SET v = 2 WHERE h = 1 AND r1 = 'a' AND r2 = 1"));
+
+  // Writes outside of the prefix do not.
+  ASSERT_OK(ExecuteInTxn(&extra_conn, "INSERT INTO t VALUES (1, 'b', 5, 5)"));
+  ASSERT_OK(ExecuteInTxn(&extra_conn, "UPDATE t SET v = 2 WHERE h = 1 AND r1 = 'b' AND r2 = 1"));
+  ASSERT_OK(ExecuteInTxn(&extra_conn, "INSERT INTO t VALUES (2, 'a', 5, 5)"));
+
+  ASSERT_OK(conn.Execute("COMMIT"));
+
+  auto res = ASSERT_RESULT(conn.FetchValue<int64_t>("SELECT COUNT(*) FROM t"));
+  ASSERT_EQ(res, 5);
+}
+
 TEST_F_EX(PgMiniTest,
           YB_DISABLE_TEST_IN_TSAN(CursorRowLockConflictMatrixSerializable),
           PgMiniTestTxnHelperSerializable) {
@@ -41,6 +41,9 @@
 
 DECLARE_bool(enable_wait_queues);
 DECLARE_bool(enable_deadlock_detection);
+DECLARE_bool(enable_deadlock_detection_incremental_probes);
+DECLARE_bool(TEST_fail_deadlock_probes_on_wait_for);
+DECLARE_bool(TEST_skip_deadlock_probes_on_wait_for);
 DECLARE_bool(TEST_select_all_status_tablets);
 DECLARE_string(ysql_pg_conf_csv);
 DECLARE_bool(enable_automatic_tablet_splitting);
@@ -49,6 +52,8 @@ DECLARE_int32(wait_queue_poll_interval_ms);
 DECLARE_uint64(force_single_shard_waiter_retry_ms);
 DECLARE_uint64(rpc_connection_timeout_ms);
 DECLARE_uint64(transactions_status_poll_interval_ms);
+DECLARE_uint64(transaction_deadlock_detection_interval_usec);
+DECLARE_uint32(deadlock_detection_full_scan_interval_rounds);
 
 using namespace std::literals;
 
@@ -460,6 +465,83 @@ TEST_F(PgWaitQueuesTest, YB_DISABLE_TEST_IN_TSAN(LongWaitBeforeDeadlock)) {
   EXPECT_LT(succeeded_commit, kClients);
 }
 
+class PgDeadlockIncrementalProbesTest : public PgWaitQueuesTest {
+ protected:
+  static constexpr auto kDetectionInterval = 200ms;
+
+  void SetUp() override {
+    FLAGS_transaction_deadlock_detection_interval_usec = kDetectionInterval / 1us;
+    FLAGS_enable_deadlock_detection_incremental_probes = true;
+    // Disable full scans, except the first round of each detector, which happens before
+    // the test transactions are started.
+    FLAGS_deadlock_detection_full_scan_interval_rounds = std::numeric_limits<uint32_t>::max();
+    PgWaitQueuesTest::SetUp();
+  }
+
+  // Starts two transactions, each of which waits for the row locked by the other one.
+  // aborted is incremented for each of them that fails to lock the second row.
+  void StartDeadlock(TestThreadHolder* thread_holder, std::atomic<int>* aborted) {
+    auto setup_conn = ASSERT_RESULT(Connect());
+    ASSERT_OK(setup_conn.Execute("CREATE TABLE foo (k INT PRIMARY KEY, v INT)"));
+    ASSERT_OK(setup_conn.Execute("insert into foo select generate_series(0, 1), 0"));
+
+    auto first_update = std::make_shared<CountDownLatch>(2);
+    for (int i = 0; i != 2; ++i) {
+      thread_holder->AddThreadFunctor([this, i, first_update, aborted] {
+        auto conn = ASSERT_RESULT(Connect());
+        ASSERT_OK(conn.StartTransaction(IsolationLevel::SNAPSHOT_ISOLATION));
+        ASSERT_OK(conn.ExecuteFormat("UPDATE foo SET v=$0 WHERE k=$0", i));
+        first_update->CountDown();
+        ASSERT_TRUE(first_update->WaitFor(5s * kTimeMultiplier));
+
+        auto s = conn.ExecuteFormat("UPDATE foo SET v=$0 WHERE k=$1", i, 1 - i);
+        if (!s.ok()) {
+          LOG(INFO) << "Failed in client " << i << ": " << s;
+          ++*aborted;
+          return;
+        }
+        EXPECT_OK(conn.CommitTransaction());
+      });
+    }
+  }
+
+  Status WaitDeadlockDetected(const std::atomic<int>& aborted) {
+    return WaitFor(
+        [&aborted] { return aborted.load() > 0; },
+        GetDeadlockDetectedDeadline() - CoarseMonoClock::Now(), "Deadlock detected");
+  }
+};
+
+// Waiters whose probes were neither sent nor failed when their wait-for edges were reported are
+// not probed by incremental rounds, so a deadlock formed by them is found only by a full scan.
+TEST_F(PgDeadlockIncrementalProbesTest, YB_DISABLE_TEST_IN_TSAN(FullScanFindsDeadlock)) {
+  FLAGS_TEST_skip_deadlock_probes_on_wait_for = true;
+
+  std::atomic<int> aborted{0};
+  TestThreadHolder thread_holder;
+  ASSERT_NO_FATALS(StartDeadlock(&thread_holder, &aborted));
+
+  std::this_thread::sleep_for(10 * kDetectionInterval * kTimeMultiplier);
+  ASSERT_EQ(aborted.load(), 0);
+
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_deadlock_detection_full_scan_interval_rounds) = 2;
+  ASSERT_OK(WaitDeadlockDetected(aborted));
+  thread_holder.JoinAll();
+}
+
+// Waiters whose probes failed are re-probed by the next incremental round, without waiting for
+// a full scan.
+TEST_F(PgDeadlockIncrementalProbesTest, YB_DISABLE_TEST_IN_TSAN(ReprobeFailedWaiters)) {
+  FLAGS_TEST_fail_deadlock_probes_on_wait_for = true;
+
+  std::atomic<int> aborted{0};
+  TestThreadHolder thread_holder;
+  ASSERT_NO_FATALS(StartDeadlock(&thread_holder, &aborted));
+
+  ASSERT_OK(WaitDeadlockDetected(aborted));
+  thread_holder.JoinAll();
+}
+
 TEST_F(PgWaitQueuesTest, YB_DISABLE_TEST_IN_TSAN(SavepointRollbackUnblock)) {
   auto setup_conn = ASSERT_RESULT(Connect());
   ASSERT_OK(setup_conn.Execute("CREATE TABLE foo (k INT PRIMARY KEY, v INT)"));